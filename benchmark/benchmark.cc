@@ -0,0 +1,475 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#include <pocketjson/pocketjson.h>
+#include <pocketjson/batch.h>
+#include <pocketjson/dedup.h>
+#include <pocketjson/diff.h>
+#include <pocketjson/parallel.h>
+#include <pocketjson/patch.h>
+#include <pocketjson/reformat.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <stdio.h>
+#include "corpus.h"
+
+/**
+ * Global allocation counter, atomic for the parallel benchmark.
+ */
+static std::atomic<size_t> g_allocations(0);
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) { throw std::bad_alloc(); }
+    return p;
+}
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+// GCC takes free() in a replaced operator delete inlined at a delete expression for a mismatch.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+// Sized deletes go through the unsized one, so every delete pairs with the new above.
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+
+namespace {
+
+/**
+ * SAX handler counting every event.
+ */
+class CountHandler: public pocketjson::AbstractParseHandler {
+public:
+    CountHandler(): count(0) {}
+    virtual bool onNull() { ++count; return true; }
+    virtual bool onBoolean(const bool&) { ++count; return true; }
+    virtual bool onInteger(const int64_t&) { ++count; return true; }
+    virtual bool onFloat(const double&) { ++count; return true; }
+    virtual bool onString(const std::string&) { ++count; return true; }
+    virtual bool beginArray() { ++count; return true; }
+    virtual bool endArray(const size_t&) { return true; }
+    virtual bool beginObject() { ++count; return true; }
+    virtual bool onObjectKey(const std::string&) { return true; }
+    virtual bool endObject(const size_t&) { return true; }
+    size_t count;
+};
+
+/**
+ * Statically dispatched handler counting the same events as CountHandler.
+ */
+class StaticCountHandler: public pocketjson::BaseParseHandler<StaticCountHandler> {
+public:
+    StaticCountHandler(): count(0) {}
+    bool onNull() { ++count; return true; }
+    bool onBoolean(bool) { ++count; return true; }
+    bool onInteger(int64_t) { ++count; return true; }
+    bool onFloat(double) { ++count; return true; }
+    bool onString(const std::string&) { ++count; return true; }
+    bool beginArray() { ++count; return true; }
+    bool beginObject() { ++count; return true; }
+    size_t count;
+};
+
+/**
+ * Batch handler counting the same events as CountHandler in one loop per batch.
+ */
+class BatchCountHandler {
+public:
+    BatchCountHandler(): count(0) {}
+    pocketjson::BatchAction onBatch(const pocketjson::EventBatch& batch) {
+        for (const pocketjson::Event* e = batch.begin(); e != batch.end(); ++e) {
+            count += e->type != pocketjson::kEventObjectKey && e->type != pocketjson::kEventEndArray && e->type != pocketjson::kEventEndObject;
+        }
+        return pocketjson::kBatchContinue;
+    }
+    size_t count;
+};
+
+struct Corpus {
+    std::string name;
+    std::string json;
+    std::vector<std::string> lines; // NDJSON records, parsed one by one
+    size_t nodes;
+};
+
+double g_minSeconds = 0.5;
+size_t g_sink = 0;
+
+/**
+ * Run op repeatedly for at least g_minSeconds and print throughput, time per node and allocations per call.
+ */
+template<typename Op> void run(const Corpus& corpus, const char* name, Op op) {
+    typedef std::chrono::steady_clock Clock;
+    op(); // warm up
+    size_t iterations = 0;
+    size_t allocations = 0;
+    double elapsed = 0.0;
+    while (elapsed < g_minSeconds) {
+        const size_t allocationsBefore = g_allocations;
+        const Clock::time_point begin = Clock::now();
+        op();
+        const Clock::time_point end = Clock::now();
+        allocations += g_allocations - allocationsBefore;
+        elapsed += std::chrono::duration<double>(end - begin).count();
+        ++iterations;
+    }
+    const double seconds = elapsed / iterations;
+    printf("%-10s %-18s %10.1f MB/s %10.2f ns/node %12.1f allocs/op %8zu iterations\n",
+        corpus.name.c_str(), name,
+        corpus.json.size() / seconds / (1024.0 * 1024.0),
+        seconds * 1e9 / corpus.nodes,
+        static_cast<double>(allocations) / iterations,
+        iterations);
+}
+
+/**
+ * Visit every node and sum numbers and string lengths, so access cannot be optimized away.
+ */
+double walk(const pocketjson::Value& v) {
+    switch (v.type()) {
+    case pocketjson::kInteger:
+    case pocketjson::kFloat: return v.toDouble();
+    case pocketjson::kString: return static_cast<double>(v.as<std::string>().size());
+    case pocketjson::kArray: {
+        double sum = 0.0;
+        const pocketjson::Array& array = v.as<pocketjson::Array>();
+        for (size_t i = 0; i < array.size(); ++i) { sum += walk(array[i]); }
+        return sum;
+    }
+    case pocketjson::kObject: {
+        double sum = 0.0;
+        const pocketjson::Object& object = v.as<pocketjson::Object>();
+        for (pocketjson::Object::const_iterator itr = object.begin(); itr != object.end(); ++itr) { sum += walk(itr->second); }
+        return sum;
+    }
+    default: return 0.0;
+    }
+}
+
+/**
+ * Call find on every object of a document and count the members found.
+ */
+template<typename Find> size_t lookup(const pocketjson::Value& v, Find find) {
+    size_t found = 0;
+    if (v.isArray()) {
+        for (size_t i = 0; i < v.size(); ++i) { found += lookup(v[i], find); }
+    } else if (v.isObject()) {
+        found += find(v);
+        const pocketjson::Object& object = v.as<pocketjson::Object>();
+        for (pocketjson::Object::const_iterator itr = object.begin(); itr != object.end(); ++itr) { found += lookup(itr->second, find); }
+    }
+    return found;
+}
+
+/**
+ * Copy a document and overwrite a scalar in every object, exercising copy on write.
+ */
+void mutate(pocketjson::Value& v, const int& depth) {
+    if (v.isArray()) {
+        for (size_t i = 0; i < v.size(); ++i) { mutate(v[i], depth + 1); }
+    } else if (v.isObject()) {
+        v["__seen"] = depth;
+        pocketjson::Object& object = v.as<pocketjson::Object>();
+        for (pocketjson::Object::iterator itr = object.begin(); itr != object.end(); ++itr) { mutate(itr->second, depth + 1); }
+    }
+}
+
+Corpus make(const std::string& name, const std::string& json) {
+    Corpus corpus;
+    corpus.name = name;
+    corpus.json = json;
+    corpus.nodes = 0;
+    if (name == "ndjson") {
+        size_t begin = 0;
+        while (begin < json.size()) {
+            size_t end = json.find('\n', begin);
+            if (end == std::string::npos) { end = json.size(); }
+            corpus.lines.push_back(json.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    } else {
+        corpus.lines.push_back(json);
+    }
+    for (size_t i = 0; i < corpus.lines.size(); ++i) {
+        CountHandler counter;
+        pocketjson::parse(&counter, corpus.lines[i]);
+        corpus.nodes += counter.count;
+    }
+    return corpus;
+}
+
+void bench(const Corpus& corpus) {
+    std::vector<pocketjson::Value> values(corpus.lines.size());
+    for (size_t i = 0; i < corpus.lines.size(); ++i) {
+        pocketjson::parse(values[i], corpus.lines[i]);
+    }
+
+    run(corpus, "parse dom", [&]() {
+        pocketjson::Parser parser;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            pocketjson::Value v;
+            parser.parse(v, corpus.lines[i]);
+            g_sink += v.size();
+        }
+    });
+    run(corpus, "parse dom utf8", [&]() {
+        pocketjson::Parser parser;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            pocketjson::Value v;
+            parser.parse(v, corpus.lines[i], pocketjson::kParseOptionValidateUtf8);
+            g_sink += v.size();
+        }
+    });
+    run(corpus, "parse dom raw", [&]() {
+        pocketjson::Parser parser;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            pocketjson::Value v;
+            parser.parse(v, corpus.lines[i], pocketjson::kParseOptionRawNumber);
+            g_sink += v.size();
+        }
+    });
+    run(corpus, "parse dedup", [&]() {
+        pocketjson::Parser parser;
+        pocketjson::Deduplicator deduplicator;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            pocketjson::Value v;
+            parser.parse(v, corpus.lines[i]);
+            deduplicator.deduplicate(v);
+            g_sink += v.size();
+        }
+        g_sink += deduplicator.merged();
+    });
+    pocketjson::Parser reuseParser;
+    pocketjson::Value reuseValue;
+    run(corpus, "parse dom reuse", [&]() {
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            reuseParser.parse(reuseValue, corpus.lines[i], pocketjson::kParseOptionReuseValue);
+            g_sink += reuseValue.size();
+        }
+    });
+    pocketjson::ParallelParser parallelParser;
+    run(corpus, "parse parallel", [&]() {
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            pocketjson::Value v;
+            parallelParser.parse(v, corpus.lines[i]);
+            g_sink += v.size();
+        }
+    });
+    run(corpus, "parse stream", [&]() {
+        std::istringstream is(corpus.json);
+        pocketjson::Parser parser;
+        pocketjson::Value v;
+        while (parser.parse(v, is)) {
+            g_sink += v.size();
+        }
+    });
+    run(corpus, "parse sax", [&]() {
+        pocketjson::Parser parser;
+        CountHandler counter;
+        pocketjson::AbstractParseHandler* handler = &counter;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            parser.parse(handler, corpus.lines[i]);
+        }
+        g_sink += counter.count;
+    });
+    run(corpus, "parse sax static", [&]() {
+        pocketjson::Parser parser;
+        StaticCountHandler counter;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            parser.parse(&counter, corpus.lines[i]);
+        }
+        g_sink += counter.count;
+    });
+    pocketjson::BatchParser batchParser;
+    run(corpus, "parse sax batch", [&]() {
+        BatchCountHandler counter;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            batchParser.parse(&counter, corpus.lines[i]);
+        }
+        g_sink += counter.count;
+    });
+    pocketjson::Parser validateParser;
+    run(corpus, "validate", [&]() {
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            g_sink += validateParser.validate(corpus.lines[i]) ? 1 : 0;
+        }
+    });
+    run(corpus, "validate utf8", [&]() {
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            g_sink += validateParser.validate(corpus.lines[i], pocketjson::kParseOptionValidateUtf8) ? 1 : 0;
+        }
+    });
+    // Truncated input is rejected at the end without allocating, once scratch buffers are warm.
+    pocketjson::Parser rejectParser;
+    run(corpus, "reject", [&]() {
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            const std::string& line = corpus.lines[i];
+            if (!rejectParser.parse(static_cast<pocketjson::AbstractParseHandler*>(0), line.begin(), line.end() - 1)) {
+                g_sink += rejectParser.error().offset;
+            }
+        }
+    });
+    run(corpus, "access", [&]() {
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i) { sum += walk(values[i]); }
+        g_sink += static_cast<size_t>(sum) & 1;
+    });
+    // A short key and a key too long for the small string buffer, present or not.
+    run(corpus, "lookup string", [&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            g_sink += lookup(values[i], [](const pocketjson::Value& v) {
+                return v.contains(std::string("id")) + v[std::string("in_reply_to_status_id")].isNull();
+            });
+        }
+    });
+    run(corpus, "lookup literal", [&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            g_sink += lookup(values[i], [](const pocketjson::Value& v) {
+                return v.contains("id") + v["in_reply_to_status_id"].isNull();
+            });
+        }
+    });
+    const pocketjson::Key idKey("id");
+    const pocketjson::Key replyKey("in_reply_to_status_id");
+    run(corpus, "lookup key", [&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            g_sink += lookup(values[i], [&](const pocketjson::Value& v) {
+                return v.contains(idKey) + v[replyKey].isNull();
+            });
+        }
+    });
+    run(corpus, "mutate", [&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            pocketjson::Value copy = values[i];
+            mutate(copy, 0);
+            g_sink += copy.size();
+        }
+    });
+    // Each patch adds a subtree next to the root members, moves and tests it and removes it again.
+    std::vector<pocketjson::Value> patchValues(corpus.lines.size());
+    std::vector<pocketjson::Value> patches(corpus.lines.size());
+    for (size_t i = 0; i < corpus.lines.size(); ++i) {
+        pocketjson::parse(patchValues[i], corpus.lines[i]);
+        const bool array = patchValues[i].isArray();
+        const std::string path = array ? "/" + std::to_string(patchValues[i].size()) : "/__patch";
+        const std::string copy = array ? "/" + std::to_string(patchValues[i].size() + 1) : "/__copy";
+        pocketjson::parse(patches[i], "["
+            "{\"op\": \"add\", \"path\": \"" + path + "\", \"value\": {\"n\": 1}},"
+            "{\"op\": \"replace\", \"path\": \"" + path + "/n\", \"value\": 2},"
+            "{\"op\": \"copy\", \"from\": \"" + path + "\", \"path\": \"" + copy + "\"},"
+            "{\"op\": \"move\", \"from\": \"" + copy + "\", \"path\": \"" + path + "/m\"},"
+            "{\"op\": \"test\", \"path\": \"" + path + "/m/n\", \"value\": 2},"
+            "{\"op\": \"remove\", \"path\": \"" + path + "\"}]");
+    }
+    pocketjson::Patcher patcher;
+    run(corpus, "patch", [&]() {
+        for (size_t i = 0; i < patchValues.size(); ++i) {
+            g_sink += patcher.apply(patchValues[i], patches[i]) ? 1 : 0;
+        }
+    });
+    const pocketjson::Value mergeAdd = pocketjson::parse("{\"__merge\": {\"n\": 1, \"list\": [1, 2]}}");
+    const pocketjson::Value mergeRemove = pocketjson::parse("{\"__merge\": null}");
+    run(corpus, "merge patch", [&]() {
+        for (size_t i = 0; i < patchValues.size(); ++i) {
+            if (!patchValues[i].isObject()) { continue; }
+            patcher.merge(patchValues[i], mergeAdd);
+            patcher.merge(patchValues[i], mergeRemove);
+            g_sink += patchValues[i].size();
+        }
+    });
+    // Diff against an updated() version sharing every untouched subtree, and against an unshared equal copy.
+    std::vector<pocketjson::Value> updatedValues(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        const pocketjson::Path path = values[i].isArray() ? pocketjson::Path().key("-") : pocketjson::Path().key("__diff");
+        updatedValues[i] = values[i].inserted(path, pocketjson::Value(1));
+    }
+    pocketjson::Differ differ;
+    pocketjson::Value delta;
+    run(corpus, "diff shared", [&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            differ.diff(values[i], updatedValues[i], delta);
+            g_sink += delta.size();
+        }
+    });
+    run(corpus, "diff full", [&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            differ.diff(values[i], patchValues[i], delta);
+            g_sink += delta.size() + 1;
+        }
+    });
+    run(corpus, "serialize", [&]() {
+        std::string out;
+        for (size_t i = 0; i < values.size(); ++i) {
+            out.clear();
+            values[i].serialize(out);
+            g_sink += out.size();
+        }
+    });
+    run(corpus, "serialize pretty", [&]() {
+        std::string out;
+        for (size_t i = 0; i < values.size(); ++i) {
+            out.clear();
+            values[i].serialize(out, pocketjson::kSerializeOptionPretty);
+            g_sink += out.size();
+        }
+    });
+    pocketjson::Reformatter reformatter;
+    run(corpus, "reformat", [&]() {
+        std::string out;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            out.clear();
+            reformatter.reformat(corpus.lines[i], out);
+            g_sink += out.size();
+        }
+    });
+    run(corpus, "reformat pretty", [&]() {
+        std::string out;
+        for (size_t i = 0; i < corpus.lines.size(); ++i) {
+            out.clear();
+            reformatter.reformat(corpus.lines[i], out, pocketjson::kSerializeOptionPretty);
+            g_sink += out.size();
+        }
+    });
+}
+
+} // namespace
+
+/**
+ * Usage: pocketjson_benchmark [min seconds per case] [corpus name...]
+ */
+int main(int argc, char** argv) {
+    if (argc > 1) { g_minSeconds = atof(argv[1]); }
+    std::vector<Corpus> corpora;
+    corpora.push_back(make("twitter", corpus::twitter(500)));
+    corpora.push_back(make("canada", corpus::canada(50000)));
+    corpora.push_back(make("strings", corpus::strings(2000)));
+    corpora.push_back(make("deep", corpus::deep(500)));
+    corpora.push_back(make("ndjson", corpus::ndjson(5000)));
+    corpora.push_back(make("records", corpus::records(100000)));
+
+    for (size_t i = 0; i < corpora.size(); ++i) {
+        bool selected = argc <= 2;
+        for (int a = 2; a < argc; ++a) {
+            if (corpora[i].name == argv[a]) { selected = true; }
+        }
+        if (!selected) { continue; }
+        printf("# %s: %zu bytes, %zu nodes\n", corpora[i].name.c_str(), corpora[i].json.size(), corpora[i].nodes);
+        bench(corpora[i]);
+    }
+    return g_sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_BENCHMARK_CORPUS_H
+#define POCKETJSON_BENCHMARK_CORPUS_H
+
+#include <pocketjson/pocketjson.h>
+#include <string>
+#include <vector>
+
+namespace corpus {
+
+/**
+ * Deterministic random generator, so every run measures the same documents.
+ */
+class Random {
+public:
+    inline explicit Random(const uint64_t& seed): state_(seed) {}
+
+public:
+    inline uint32_t next() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state_ >> 33);
+    }
+    inline uint32_t next(const uint32_t& n) { return this->next() % n; }
+    inline double real() { return this->next() / 2147483648.0; }
+    inline std::string word(const size_t& minLength, const size_t& maxLength) {
+        static const char kChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        const size_t length = minLength + this->next(static_cast<uint32_t>(maxLength - minLength + 1));
+        std::string s;
+        for (size_t i = 0; i < length; ++i) {
+            s.push_back(kChars[this->next(sizeof(kChars) - 1)]);
+        }
+        return s;
+    }
+
+private:
+    uint64_t state_;
+};
+
+/**
+ * Social timeline: many small objects with ids, short strings, booleans and nested entities.
+ */
+inline std::string twitter(const size_t& count) {
+    Random r(1);
+    pocketjson::Value root;
+    pocketjson::Value& statuses = root["statuses"];
+    for (size_t i = 0; i < count; ++i) {
+        pocketjson::Value status;
+        status["id"] = static_cast<int64_t>(505874924095815681LL + i);
+        status["id_str"] = pocketjson::Serializer::int64ToString(static_cast<int64_t>(505874924095815681LL + i));
+        status["created_at"] = "Sun Aug 31 00:29:15 +0000 2014";
+        std::string text;
+        for (int w = 0; w < 12; ++w) { text += r.word(2, 9) + " "; }
+        status["text"] = text + "\xe3\x81\x82\xe3\x81\x84 @" + r.word(4, 10);
+        status["truncated"] = false;
+        status["retweet_count"] = static_cast<int>(r.next(1000));
+        status["favorite_count"] = static_cast<int>(r.next(1000));
+        status["in_reply_to_status_id"] = pocketjson::Value();
+        pocketjson::Value& user = status["user"];
+        user["id"] = static_cast<int>(r.next());
+        user["name"] = r.word(5, 15);
+        user["screen_name"] = r.word(5, 12);
+        user["description"] = r.word(20, 80);
+        user["followers_count"] = static_cast<int>(r.next(100000));
+        user["verified"] = r.next(2) == 0;
+        user["profile_image_url"] = "http://pbs.twimg.com/profile_images/" + r.word(10, 10) + "/" + r.word(8, 8) + "_normal.jpeg";
+        pocketjson::Value& entities = status["entities"];
+        entities["hashtags"].setType(pocketjson::kArray);
+        for (uint32_t h = r.next(3); h > 0; --h) {
+            pocketjson::Value tag;
+            tag["text"] = r.word(3, 10);
+            tag["indices"].push_back(static_cast<int>(r.next(100)));
+            tag["indices"].push_back(static_cast<int>(r.next(140)));
+            entities["hashtags"].push_back(tag);
+        }
+        entities["urls"].setType(pocketjson::kArray);
+        statuses.push_back(status);
+    }
+    root["search_metadata"]["count"] = static_cast<int>(count);
+    root["search_metadata"]["query"] = "%E4%B8%80";
+    return root.serialize();
+}
+
+/**
+ * Geographic polygons: deeply repeated arrays of floating point coordinates.
+ */
+inline std::string canada(const size_t& points) {
+    Random r(2);
+    pocketjson::Value root;
+    root["type"] = "FeatureCollection";
+    pocketjson::Value feature;
+    feature["type"] = "Feature";
+    feature["properties"]["name"] = "Canada";
+    feature["geometry"]["type"] = "Polygon";
+    pocketjson::Value& polygons = feature["geometry"]["coordinates"];
+    size_t remain = points;
+    while (remain > 0) {
+        pocketjson::Value ring;
+        const size_t n = remain < 1000 ? remain : 1000;
+        for (size_t i = 0; i < n; ++i) {
+            pocketjson::Value point;
+            point.push_back(-141.0 + r.real() * 80.0);
+            point.push_back(41.0 + r.real() * 42.0);
+            ring.push_back(point);
+        }
+        polygons.push_back(ring);
+        remain -= n;
+    }
+    root["features"].push_back(feature);
+    return root.serialize();
+}
+
+/**
+ * Long string values with escapes and multibyte characters.
+ */
+inline std::string strings(const size_t& count) {
+    Random r(3);
+    pocketjson::Value root;
+    for (size_t i = 0; i < count; ++i) {
+        std::string s;
+        for (int w = 0; w < 40; ++w) {
+            s += r.word(1, 12);
+            switch (r.next(8)) {
+            case 0: s += "\\"; break;
+            case 1: s += "\"quoted\""; break;
+            case 2: s += "\n"; break;
+            case 3: s += "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e"; break;
+            case 4: s += "\t"; break;
+            default: s += " "; break;
+            }
+        }
+        root.push_back(s);
+    }
+    return root.serialize();
+}
+
+/**
+ * Alternately nested arrays and objects.
+ */
+inline std::string deep(const size_t& depth) {
+    std::string json;
+    for (size_t i = 0; i < depth; ++i) {
+        json += (i % 2 == 0) ? "{\"a\":[1,\"b\"," : "[true,null,";
+    }
+    json += "0";
+    for (size_t i = depth; i > 0; --i) {
+        json += ((i - 1) % 2 == 0) ? "]}" : "]";
+    }
+    return json;
+}
+
+/**
+ * Newline delimited small records.
+ */
+inline std::string ndjson(const size_t& lines) {
+    Random r(4);
+    std::string json;
+    for (size_t i = 0; i < lines; ++i) {
+        pocketjson::Value record;
+        record["seq"] = static_cast<int>(i);
+        record["level"] = r.next(4) == 0 ? "warn" : "info";
+        record["message"] = r.word(10, 60);
+        record["latency"] = r.real() * 100.0;
+        record["tags"].push_back(r.word(3, 6));
+        json += record.serialize();
+        json += "\n";
+    }
+    return json;
+}
+
+/**
+ * One large top-level array of log records with nested objects.
+ */
+inline std::string records(const size_t& count) {
+    Random r(5);
+    pocketjson::Value root(pocketjson::kArray);
+    for (size_t i = 0; i < count; ++i) {
+        pocketjson::Value record;
+        record["seq"] = static_cast<int>(i);
+        record["level"] = r.next(4) == 0 ? "warn" : "info";
+        record["message"] = r.word(10, 60) + ", \"" + r.word(2, 8) + "\"";
+        record["latency"] = r.real() * 100.0;
+        record["user"]["id"] = static_cast<int>(r.next(1000));
+        record["user"]["tags"].push_back(r.word(3, 6));
+        root.push_back(record);
+    }
+    return root.serialize();
+}
+
+} // namespace corpus
+
+#endif // POCKETJSON_BENCHMARK_CORPUS_H
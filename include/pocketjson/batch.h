@@ -0,0 +1,221 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_BATCH_H
+#define POCKETJSON_BATCH_H
+
+#include <pocketjson/pocketjson.h>
+
+namespace pocketjson {
+
+template<typename Handler> class BatchRecorder;
+
+enum EventType {
+    kEventNull,
+    kEventBoolean,
+    kEventInteger,
+    kEventUInteger,
+    kEventFloat,
+    kEventString,
+    kEventObjectKey,
+    kEventBeginArray,
+    kEventEndArray,
+    kEventBeginObject,
+    kEventEndObject
+}; // EventType enum
+
+/**
+ * What the batch handler wants after a batch.
+ * kBatchSkip drops the rest of the innermost open container and delivers its end event.
+ */
+enum BatchAction {
+    kBatchContinue,
+    kBatchStop,
+    kBatchSkip
+}; // BatchAction enum
+
+/**
+ * Compact SAX event record (16 bytes).
+ * length is the byte length of a string or key and the element count of an end event.
+ */
+struct Event {
+    uint32_t type;
+    uint32_t length;
+    union {
+        bool boolean;
+        int64_t integer;
+        uint64_t uinteger;
+        double number;
+        uint64_t offset; // of a string or key in EventBatch
+    };
+}; // Event struct
+
+/**
+ * Events recorded since the last batch. Strings are valid until the handler returns.
+ */
+class EventBatch {
+public:
+    inline EventBatch(): size_(0) {}
+    inline ~EventBatch() {}
+
+public:
+    inline size_t size() const { return size_; }
+    inline bool empty() const { return size_ == 0; }
+    inline const Event& operator [](const size_t& index) const { return events_[index]; }
+    inline const Event* begin() const { return size_ ? &events_[0] : 0; }
+    inline const Event* end() const { return size_ ? &events_[0] + size_ : 0; }
+    inline const char* string(const Event& event) const { return strings_.data() + event.offset; }
+    inline String toString(const Event& event) const { return String(this->string(event), event.length); }
+
+private:
+    template<typename Handler> friend class BatchRecorder;
+
+    std::vector<Event> events_; // sized to the capacity, size_ records are used
+    size_t size_;
+    String strings_;
+}; // EventBatch class
+
+/**
+ * Parse handler which records events and hands them to Handler::onBatch(const EventBatch&) in batches.
+ * Handler::onBatch returns BatchAction, and kBatchStop cancels parsing with kErrorHandlerCancel.
+ */
+template<typename Handler>
+class BatchRecorder {
+public:
+    inline BatchRecorder(Handler* handler, EventBatch& batch, const size_t& capacity)
+        : handler_(handler), batch_(batch), capacity_(capacity), depth_(0), skipDepth_(0) {
+        batch_.events_.resize(capacity_);
+        batch_.size_ = 0;
+        batch_.strings_.clear();
+    }
+    inline ~BatchRecorder() {}
+
+public:
+    inline bool onNull() {
+        if (skipDepth_) { return true; }
+        this->add(kEventNull, 0).uinteger = 0;
+        return this->check();
+    }
+    inline bool onBoolean(const bool& v) {
+        if (skipDepth_) { return true; }
+        this->add(kEventBoolean, 0).boolean = v;
+        return this->check();
+    }
+    inline bool onInteger(const int64_t& v) {
+        if (skipDepth_) { return true; }
+        this->add(kEventInteger, 0).integer = v;
+        return this->check();
+    }
+    inline bool onUInteger(const uint64_t& v) {
+        if (skipDepth_) { return true; }
+        this->add(kEventUInteger, 0).uinteger = v;
+        return this->check();
+    }
+    inline bool onFloat(const double& v) {
+        if (skipDepth_) { return true; }
+        this->add(kEventFloat, 0).number = v;
+        return this->check();
+    }
+    inline bool onString(const String& v) { return skipDepth_ ? true : this->add_string(kEventString, v); }
+    inline bool onObjectKey(const String& key) { return skipDepth_ ? true : this->add_string(kEventObjectKey, key); }
+    inline bool beginArray() { return this->begin(kEventBeginArray); }
+    inline bool endArray(const size_t& count) { return this->end(kEventEndArray, count); }
+    inline bool beginObject() { return this->begin(kEventBeginObject); }
+    inline bool endObject(const size_t& count) { return this->end(kEventEndObject, count); }
+
+    /**
+     * Hand the remaining events to the handler.
+     */
+    inline bool flush() {
+        if (batch_.size_ == 0) { return true; }
+        const BatchAction action = handler_->onBatch(static_cast<const EventBatch&>(batch_));
+        batch_.size_ = 0;
+        batch_.strings_.clear();
+        if (action == kBatchSkip && depth_ > 0) {
+            skipDepth_ = depth_;
+        }
+        return action != kBatchStop;
+    }
+
+private:
+    inline Event& add(const EventType& type, const uint32_t& length) {
+        Event& event = batch_.events_[batch_.size_++];
+        event.type = type;
+        event.length = length;
+        return event;
+    }
+    inline bool check() {
+        return batch_.size_ < capacity_ || this->flush();
+    }
+    inline bool add_string(const EventType& type, const String& str) {
+        this->add(type, static_cast<uint32_t>(str.size())).offset = batch_.strings_.size();
+        batch_.strings_.append(str);
+        return this->check();
+    }
+    inline bool begin(const EventType& type) {
+        ++depth_;
+        if (skipDepth_) { return true; }
+        this->add(type, 0).uinteger = 0;
+        return this->check();
+    }
+    inline bool end(const EventType& type, const size_t& count) {
+        const size_t depth = depth_--;
+        if (skipDepth_) {
+            if (depth != skipDepth_) { return true; }
+            skipDepth_ = 0;
+        }
+        this->add(type, static_cast<uint32_t>(count)).uinteger = 0;
+        return this->check();
+    }
+
+private:
+    Handler* handler_;
+    EventBatch& batch_;
+    size_t capacity_;
+    size_t depth_;
+    size_t skipDepth_; // depth of the container being skipped, 0 when not skipping
+}; // BatchRecorder class
+
+/**
+ * SAX parser delivering events in batches of a fixed number of records.
+ * Buffers are retained between parse calls.
+ */
+class BatchParser {
+public:
+    inline explicit BatchParser(const size_t& capacity = 256): capacity_(capacity ? capacity : 1) {}
+    inline ~BatchParser() {}
+
+public:
+    template<typename Handler, typename Iter> bool parse(Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    template<typename Handler> bool parse(Handler* handler, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    inline const ParseError& error() const { return parser_.error(); }
+    inline Parser& parser() { return parser_; }
+
+private:
+    Parser parser_;
+    EventBatch batch_;
+    size_t capacity_;
+}; // BatchParser class
+
+/**
+ * BatchParser class implementation.
+ */
+template<typename Handler, typename Iter> inline bool BatchParser::parse(Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    BatchRecorder<Handler> recorder(handler, batch_, capacity_);
+    if (!parser_.parse(&recorder, begin, end, options, errorMessage)) { return false; }
+    // Parsing is complete, so stopping after the last batch is not an error.
+    recorder.flush();
+    return true;
+}
+template<typename Handler> inline bool BatchParser::parse(Handler* handler, const String& str, const ParseOption& options, String* errorMessage) {
+    const char* data = str.data();
+    return this->parse(handler, data, data + str.size(), options, errorMessage);
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_BATCH_H
@@ -0,0 +1,517 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_BINDING_H
+#define POCKETJSON_BINDING_H
+
+// Struct binding requires C++11.
+#include <pocketjson/pocketjson.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <optional>
+#endif
+
+namespace pocketjson {
+
+/**
+ * Binding trait of a struct.
+ * POCKETJSON_BIND specializes it with `bound` and `fields()` which returns a tuple of Field.
+ */
+template<typename T> struct Binding {
+    static const bool bound = false;
+}; // Binding struct
+
+/**
+ * Binding of a member to an object key.
+ * `key` is the quoted key literal, which member names never need to escape.
+ */
+template<typename C, typename M> struct Field {
+    inline Field(const char* n, const size_t& l, const char* k, M C::*m): name(n), length(l), key(k), member(m) {}
+    const char* name;
+    size_t length;
+    const char* key;
+    M C::*member;
+}; // Field struct
+
+/**
+ * Parse JSON string directly into bound structs, without building Value tree.
+ * Supported member types are bool, integers, floating points, String, Value, std::vector,
+ * std::map with String key, std::optional (C++17) and other bound structs.
+ * Unknown keys are skipped, and members whose key does not exist keep their value.
+ */
+class Decoder {
+public:
+    inline Decoder(): options_(kParseOptionNone) {}
+    inline ~Decoder() {}
+
+public:
+    template<typename T, typename Iter> bool decode(T& v, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    template<typename T> bool decode(T& v, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    inline const ParseError& error() const { return parser_.error(); }
+
+private:
+    template<typename Iter> bool read(Iter& itr, bool& v);
+    template<typename Iter, typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type read(Iter& itr, T& v);
+    template<typename Iter, typename T> typename std::enable_if<std::is_floating_point<T>::value, bool>::type read(Iter& itr, T& v);
+    template<typename Iter> bool read(Iter& itr, String& v);
+    template<typename Iter> bool read(Iter& itr, Value& v);
+    template<typename Iter, typename T> bool read(Iter& itr, std::vector<T>& v);
+    template<typename Iter> bool read(Iter& itr, std::vector<bool>& v);
+    template<typename Iter, typename T> bool read(Iter& itr, std::map<String, T>& v);
+#if __cplusplus >= 201703L
+    template<typename Iter, typename T> bool read(Iter& itr, std::optional<T>& v);
+#endif
+    template<typename Iter, typename T> typename std::enable_if<Binding<T>::bound, bool>::type read(Iter& itr, T& v);
+
+    template<size_t I, typename Iter, typename T, typename Tuple> typename std::enable_if<(I < std::tuple_size<Tuple>::value), bool>::type read_field(Iter& itr, T& v, const Tuple& fields);
+    template<size_t I, typename Iter, typename T, typename Tuple> typename std::enable_if<(I == std::tuple_size<Tuple>::value), bool>::type read_field(Iter& itr, T& v, const Tuple& fields);
+
+    template<typename Iter> bool read_number(Iter& itr, Value& number);
+    template<typename Iter, typename F> bool read_array(Iter& itr, F element);
+    template<typename Iter, typename F> bool read_object(Iter& itr, F member);
+
+private:
+    Parser parser_;
+    ParseOption options_;
+    String key_;
+
+}; // Decoder class
+
+/**
+ * Serialize bound structs directly into JSON string, without building Value tree.
+ * The output follows Serializer rules and SerializeOption formatting.
+ * Members are written in the order of POCKETJSON_BIND.
+ */
+class Encoder {
+public:
+    inline Encoder() {}
+    inline ~Encoder() {}
+
+public:
+    template<typename T, typename Iter> bool encode(const Iter& itr, const T& v, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0);
+    template<typename T> bool encode(String& str, const T& v, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0);
+
+private:
+    template<typename Iter> bool write(Iter& itr, const bool& v, const int& indent);
+    template<typename Iter, typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type write(Iter& itr, const T& v, const int& indent);
+    template<typename Iter, typename T> typename std::enable_if<std::is_floating_point<T>::value, bool>::type write(Iter& itr, const T& v, const int& indent);
+    template<typename Iter> bool write(Iter& itr, const String& v, const int& indent);
+    template<typename Iter> bool write(Iter& itr, const Value& v, const int& indent);
+    template<typename Iter, typename T> bool write(Iter& itr, const std::vector<T>& v, const int& indent);
+    template<typename Iter, typename T> bool write(Iter& itr, const std::map<String, T>& v, const int& indent);
+#if __cplusplus >= 201703L
+    template<typename Iter, typename T> bool write(Iter& itr, const std::optional<T>& v, const int& indent);
+#endif
+    template<typename Iter, typename T> typename std::enable_if<Binding<T>::bound, bool>::type write(Iter& itr, const T& v, const int& indent);
+
+    template<size_t I, typename Iter, typename T, typename Tuple> typename std::enable_if<(I < std::tuple_size<Tuple>::value), bool>::type write_field(Iter& itr, const T& v, const Tuple& fields, const int& indent);
+    template<size_t I, typename Iter, typename T, typename Tuple> typename std::enable_if<(I == std::tuple_size<Tuple>::value), bool>::type write_field(Iter& itr, const T& v, const Tuple& fields, const int& indent);
+
+    template<typename Iter> void begin_member(Iter& itr, const bool& first, const int& indent);
+    template<typename Iter> void end_container(Iter& itr, const char& c, const bool& empty, const int& indent);
+    bool fail(const String& error);
+
+private:
+    Serializer serializer_;
+    Serializer::Attributes attr_;
+    String lastError_;
+
+}; // Encoder class
+
+template<typename T, typename Iter> inline bool decode(T& v, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0) {
+    Decoder decoder;
+    return decoder.decode(v, begin, end, options, errorMessage);
+}
+template<typename T> inline bool decode(T& v, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0) {
+    return decode(v, str.begin(), str.end(), options, errorMessage);
+}
+
+template<typename T, typename Iter> inline bool encode(const Iter& itr, const T& v, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) {
+    Encoder encoder;
+    return encoder.encode(itr, v, options, errorMessage);
+}
+template<typename T> inline bool encode(String& str, const T& v, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) {
+    Encoder encoder;
+    return encoder.encode(str, v, options, errorMessage);
+}
+template<typename T> inline String encode(const T& v, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) {
+    String str;
+    encode(str, v, options, errorMessage);
+    return str;
+}
+
+/**
+ * Decoder class implementation.
+ */
+template<typename T, typename Iter> inline bool Decoder::decode(T& v, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    parser_.error_.clear();
+    parser_.rawNumber_ = (options & kParseOptionRawNumber) != 0;
+    options_ = options;
+    Parser::Iterator<Iter> itr(begin, end);
+    parser_.skip_utf8_bom(itr);
+    bool ok = this->read(itr, v);
+    if (ok && !(options & kParseOptionAllowGabage)) {
+        parser_.skip_white_space(itr);
+        if (itr && *itr != 0) {
+            ok = parser_.fail(kErrorGabage, itr);
+        }
+    }
+    if (errorMessage) { errorMessage->assign(parser_.error_.message()); }
+    return ok;
+}
+template<typename T> inline bool Decoder::decode(T& v, const String& str, const ParseOption& options, String* errorMessage) {
+    return this->decode(v, str.begin(), str.end(), options, errorMessage);
+}
+
+template<typename Iter> inline bool Decoder::read(Iter& itr, bool& v) {
+    parser_.skip_white_space(itr);
+    if (*itr != 't' && *itr != 'f') {
+        return parser_.fail(kErrorExpectedBoolean, itr);
+    }
+    Value value;
+    if (!parser_.parse_value(&value, 0, itr, options_)) { return false; }
+    v = value.toBoolean();
+    return true;
+}
+template<typename Iter, typename T> inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type Decoder::read(Iter& itr, T& v) {
+    Value number;
+    if (!this->read_number(itr, number)) { return false; }
+    if (!number.isInteger()) {
+        return parser_.fail(kErrorExpectedInteger, itr);
+    }
+    if (std::is_unsigned<T>::value) {
+        // toULLong() rejects negative values and reads uint64 above INT64_MAX.
+        const unsigned long long u = number.toULLong();
+        if ((u == 0 && number.as<int64_t>() != 0) || static_cast<unsigned long long>(static_cast<T>(u)) != u) {
+            return parser_.fail(kErrorIntegerRange, itr);
+        }
+        v = static_cast<T>(u);
+        return true;
+    }
+    const int64_t i = number.toLLong();
+    if (number.toULLong() > static_cast<unsigned long long>(LLONG_MAX) || static_cast<int64_t>(static_cast<T>(i)) != i) {
+        return parser_.fail(kErrorIntegerRange, itr);
+    }
+    v = static_cast<T>(i);
+    return true;
+}
+template<typename Iter, typename T> inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type Decoder::read(Iter& itr, T& v) {
+    Value number;
+    if (!this->read_number(itr, number)) { return false; }
+    v = static_cast<T>(number.toDouble());
+    return true;
+}
+template<typename Iter> inline bool Decoder::read(Iter& itr, String& v) {
+    parser_.skip_white_space(itr);
+    if (*itr != '"') {
+        return parser_.fail(kErrorExpectedString, itr);
+    }
+    v.clear();
+    return (options_ & kParseOptionValidateUtf8) ? parser_.parse_string<true>(v, itr) : parser_.parse_string<false>(v, itr);
+}
+template<typename Iter> inline bool Decoder::read(Iter& itr, Value& v) {
+    return parser_.parse_value(&v, 0, itr, options_);
+}
+template<typename Iter, typename T> inline bool Decoder::read(Iter& itr, std::vector<T>& v) {
+    v.clear();
+    return this->read_array(itr, [&](Iter& it) -> bool {
+        v.push_back(T());
+        return this->read(it, v.back());
+    });
+}
+template<typename Iter> inline bool Decoder::read(Iter& itr, std::vector<bool>& v) {
+    // Elements of std::vector<bool> are proxies, which do not bind to bool&.
+    v.clear();
+    return this->read_array(itr, [&](Iter& it) -> bool {
+        bool b = false;
+        if (!this->read(it, b)) { return false; }
+        v.push_back(b);
+        return true;
+    });
+}
+template<typename Iter, typename T> inline bool Decoder::read(Iter& itr, std::map<String, T>& v) {
+    v.clear();
+    return this->read_object(itr, [&](Iter& it) -> bool {
+        return this->read(it, v[key_]);
+    });
+}
+#if __cplusplus >= 201703L
+template<typename Iter, typename T> inline bool Decoder::read(Iter& itr, std::optional<T>& v) {
+    parser_.skip_white_space(itr);
+    if (*itr == 'n') {
+        v.reset();
+        return parser_.parse_value(0, 0, itr, options_);
+    }
+    v.emplace();
+    return this->read(itr, *v);
+}
+#endif
+template<typename Iter, typename T> inline typename std::enable_if<Binding<T>::bound, bool>::type Decoder::read(Iter& itr, T& v) {
+    const auto fields = Binding<T>::fields();
+    return this->read_object(itr, [&](Iter& it) -> bool {
+        return this->read_field<0>(it, v, fields);
+    });
+}
+
+/**
+ * Read the value of key_ into the matching member, or skip it when no member matches.
+ * Fields are tried at run time in the order of POCKETJSON_BIND. Their lengths are constants once
+ * fields() is inlined, so most fields are rejected without comparing bytes.
+ */
+template<size_t I, typename Iter, typename T, typename Tuple> inline typename std::enable_if<(I < std::tuple_size<Tuple>::value), bool>::type Decoder::read_field(Iter& itr, T& v, const Tuple& fields) {
+    const auto& field = std::get<I>(fields);
+    if (key_.size() == field.length && memcmp(key_.data(), field.name, field.length) == 0) {
+        return this->read(itr, v.*(field.member));
+    }
+    return this->read_field<I + 1>(itr, v, fields);
+}
+template<size_t I, typename Iter, typename T, typename Tuple> inline typename std::enable_if<(I == std::tuple_size<Tuple>::value), bool>::type Decoder::read_field(Iter& itr, T&, const Tuple&) {
+    return parser_.parse_value(0, 0, itr, options_);
+}
+
+template<typename Iter> inline bool Decoder::read_number(Iter& itr, Value& number) {
+    parser_.skip_white_space(itr);
+    if (*itr != '-' && (*itr < '0' || '9' < *itr)) {
+        return parser_.fail(kErrorExpectedNumber, itr);
+    }
+    return parser_.parse_number<Parser::kTargetValue>(&number, static_cast<AbstractParseHandler*>(0), itr);
+}
+template<typename Iter, typename F> inline bool Decoder::read_array(Iter& itr, F element) {
+    parser_.skip_white_space(itr);
+    if (*itr != '[') {
+        return parser_.fail(kErrorExpectedArray, itr);
+    }
+    size_t count = 0;
+    while (++itr) {
+        parser_.skip_white_space(itr);
+        if (*itr == ']') {
+            if (count == 0 || (options_ & kParseOptionAllowCommaEnding)) {
+                ++itr;
+                return true;
+            }
+            return parser_.fail(kErrorArrayTrailingComma, itr);
+        }
+        if (!element(itr)) { return false; }
+        ++count;
+        parser_.skip_white_space(itr);
+        if (*itr == ']') {
+            ++itr;
+            return true;
+        } else if (*itr != ',') {
+            return parser_.fail(kErrorArraySeparator, itr);
+        }
+    }
+    return parser_.fail(kErrorUnterminatedArray, itr);
+}
+template<typename Iter, typename F> inline bool Decoder::read_object(Iter& itr, F member) {
+    parser_.skip_white_space(itr);
+    if (*itr != '{') {
+        return parser_.fail(kErrorExpectedObject, itr);
+    }
+    size_t count = 0;
+    while (++itr) {
+        parser_.skip_white_space(itr);
+        if (*itr == '}') {
+            if (count == 0 || (options_ & kParseOptionAllowCommaEnding)) {
+                ++itr;
+                return true;
+            }
+            return parser_.fail(kErrorObjectTrailingComma, itr);
+        } else if (*itr != '"') {
+            return parser_.fail(kErrorObjectSeparator, itr);
+        }
+        key_.clear();
+        if (!((options_ & kParseOptionValidateUtf8) ? parser_.parse_string<true>(key_, itr) : parser_.parse_string<false>(key_, itr))) { return false; }
+        parser_.skip_white_space(itr);
+        if (*itr != ':') {
+            return parser_.fail(kErrorObjectSeparator, itr);
+        }
+        ++itr;
+        if (!member(itr)) { return false; }
+        ++count;
+        parser_.skip_white_space(itr);
+        if (*itr == '}') {
+            ++itr;
+            return true;
+        } else if (*itr != ',') {
+            return parser_.fail(kErrorObjectSeparator, itr);
+        }
+    }
+    return parser_.fail(kErrorUnterminatedObject, itr);
+}
+
+/**
+ * Encoder class implementation.
+ */
+template<typename T, typename Iter> inline bool Encoder::encode(const Iter& itr, const T& v, const SerializeOption& options, String* errorMessage) {
+    lastError_.clear();
+    attr_ = Serializer::attributes(options);
+    Iter tmp = itr;
+    const bool ok = this->write(tmp, v, attr_.pretty ? 0 : -1);
+    if (errorMessage) { *errorMessage = lastError_; }
+    return ok;
+}
+template<typename T> inline bool Encoder::encode(String& str, const T& v, const SerializeOption& options, String* errorMessage) {
+    str.clear();
+    return this->encode(StringAppender(str), v, options, errorMessage);
+}
+
+template<typename Iter> inline bool Encoder::write(Iter& itr, const bool& v, const int&) {
+    if (v) {
+        serializer_.append(itr, "true", 4);
+    } else {
+        serializer_.append(itr, "false", 5);
+    }
+    return true;
+}
+template<typename Iter, typename T> inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type Encoder::write(Iter& itr, const T& v, const int&) {
+    char buf[32];
+    size_t i = sizeof(buf);
+    const bool isNegative = std::is_signed<T>::value && v < 0;
+    // Negate digit by digit to cover the minimum value.
+    T n = v;
+    do {
+        const int digit = static_cast<int>(n % 10);
+        buf[--i] = static_cast<char>('0' + (digit < 0 ? -digit : digit));
+        n /= 10;
+    } while (n != 0);
+    if (isNegative) { buf[--i] = '-'; }
+    serializer_.append(itr, buf + i, sizeof(buf) - i);
+    return true;
+}
+template<typename Iter, typename T> inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type Encoder::write(Iter& itr, const T& v, const int&) {
+    Double d(static_cast<double>(v));
+    if (d.isNanOrInf()) {
+        return this->fail("Floating point is nan or inf.");
+    }
+    d.toString(itr);
+    return true;
+}
+template<typename Iter> inline bool Encoder::write(Iter& itr, const String& v, const int&) {
+    serializer_.serialize_string(itr, v);
+    return true;
+}
+template<typename Iter> inline bool Encoder::write(Iter& itr, const Value& v, const int& indent) {
+    if (attr_.pretty) {
+        return serializer_.serialize<true>(itr, v, attr_, indent, &lastError_);
+    }
+    return serializer_.serialize<false>(itr, v, attr_, indent, &lastError_);
+}
+template<typename Iter, typename T> inline bool Encoder::write(Iter& itr, const std::vector<T>& v, const int& indent) {
+    *itr++ = '[';
+    const int inner = indent > -1 ? indent + 1 : indent;
+    for (size_t i = 0; i < v.size(); ++i) {
+        this->begin_member(itr, i == 0, inner);
+        if (!this->write(itr, v[i], inner)) { return false; }
+    }
+    this->end_container(itr, ']', v.empty(), indent);
+    return true;
+}
+template<typename Iter, typename T> inline bool Encoder::write(Iter& itr, const std::map<String, T>& v, const int& indent) {
+    *itr++ = '{';
+    const int inner = indent > -1 ? indent + 1 : indent;
+    for (typename std::map<String, T>::const_iterator mitr = v.begin(); mitr != v.end(); ++mitr) {
+        this->begin_member(itr, mitr == v.begin(), inner);
+        serializer_.serialize_string(itr, mitr->first);
+        *itr++ = ':';
+        if (attr_.pretty) { *itr++ = ' '; }
+        if (!this->write(itr, mitr->second, inner)) { return false; }
+    }
+    this->end_container(itr, '}', v.empty(), indent);
+    return true;
+}
+#if __cplusplus >= 201703L
+template<typename Iter, typename T> inline bool Encoder::write(Iter& itr, const std::optional<T>& v, const int& indent) {
+    if (!v) {
+        serializer_.append(itr, "null", 4);
+        return true;
+    }
+    return this->write(itr, *v, indent);
+}
+#endif
+template<typename Iter, typename T> inline typename std::enable_if<Binding<T>::bound, bool>::type Encoder::write(Iter& itr, const T& v, const int& indent) {
+    const auto fields = Binding<T>::fields();
+    *itr++ = '{';
+    if (!this->write_field<0>(itr, v, fields, indent > -1 ? indent + 1 : indent)) { return false; }
+    this->end_container(itr, '}', std::tuple_size<decltype(fields)>::value == 0, indent);
+    return true;
+}
+
+template<size_t I, typename Iter, typename T, typename Tuple> inline typename std::enable_if<(I < std::tuple_size<Tuple>::value), bool>::type Encoder::write_field(Iter& itr, const T& v, const Tuple& fields, const int& indent) {
+    const auto& field = std::get<I>(fields);
+    this->begin_member(itr, I == 0, indent);
+    serializer_.append(itr, field.key, field.length + 2);
+    *itr++ = ':';
+    if (attr_.pretty) { *itr++ = ' '; }
+    if (!this->write(itr, v.*(field.member), indent)) { return false; }
+    return this->write_field<I + 1>(itr, v, fields, indent);
+}
+template<size_t I, typename Iter, typename T, typename Tuple> inline typename std::enable_if<(I == std::tuple_size<Tuple>::value), bool>::type Encoder::write_field(Iter&, const T&, const Tuple&, const int&) {
+    return true;
+}
+
+template<typename Iter> inline void Encoder::begin_member(Iter& itr, const bool& first, const int& indent) {
+    if (!first) { *itr++ = ','; }
+    if (indent > -1) {
+        serializer_.indent(itr, attr_, indent);
+    }
+}
+template<typename Iter> inline void Encoder::end_container(Iter& itr, const char& c, const bool& empty, const int& indent) {
+    if (indent > -1 && !empty) {
+        serializer_.indent(itr, attr_, indent);
+    }
+    *itr++ = c;
+}
+inline bool Encoder::fail(const String& error) {
+    lastError_ = error;
+    return false;
+}
+
+} // namespace pocketjson
+
+#define POCKETJSON_BIND_EXPAND(x) x
+#define POCKETJSON_BIND_FIELD(T, m) ::pocketjson::Field<T, decltype(T::m)>(#m, sizeof(#m) - 1, "\"" #m "\"", &T::m)
+#define POCKETJSON_BIND_FIELDS_1(T, m) POCKETJSON_BIND_FIELD(T, m)
+#define POCKETJSON_BIND_FIELDS_2(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_1(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_3(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_2(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_4(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_3(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_5(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_4(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_6(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_5(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_7(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_6(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_8(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_7(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_9(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_8(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_10(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_9(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_11(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_10(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_12(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_11(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_13(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_12(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_14(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_13(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_15(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_14(T, __VA_ARGS__))
+#define POCKETJSON_BIND_FIELDS_16(T, m, ...) POCKETJSON_BIND_FIELD(T, m), POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_FIELDS_15(T, __VA_ARGS__))
+#define POCKETJSON_BIND_COUNT_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define POCKETJSON_BIND_COUNT(...) POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_COUNT_N(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define POCKETJSON_BIND_CONCAT_(a, b) a##b
+#define POCKETJSON_BIND_CONCAT(a, b) POCKETJSON_BIND_CONCAT_(a, b)
+#define POCKETJSON_BIND_FIELDS(T, ...) POCKETJSON_BIND_EXPAND(POCKETJSON_BIND_CONCAT(POCKETJSON_BIND_FIELDS_, POCKETJSON_BIND_COUNT(__VA_ARGS__))(T, __VA_ARGS__))
+
+/**
+ * Bind up to 16 members of a struct to object keys of the same names for Decoder and Encoder.
+ * Use it at global namespace scope:
+ *   POCKETJSON_BIND(User, id, name, tags)
+ */
+#define POCKETJSON_BIND(T, ...) \
+    namespace pocketjson { \
+    template<> struct Binding<T> { \
+        static const bool bound = true; \
+        static inline auto fields() -> decltype(std::make_tuple(POCKETJSON_BIND_FIELDS(T, __VA_ARGS__))) { \
+            return std::make_tuple(POCKETJSON_BIND_FIELDS(T, __VA_ARGS__)); \
+        } \
+    }; \
+    }
+
+#endif // POCKETJSON_BINDING_H
@@ -0,0 +1,170 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_DEDUP_H
+#define POCKETJSON_DEDUP_H
+
+#include <pocketjson/pocketjson.h>
+
+namespace pocketjson {
+
+/**
+ * Merge equal strings, arrays and objects into one shared container (hash consing).
+ * Values are looked up by a structural hash in a table of canonical values, which is kept between calls
+ * so several documents share their common subtrees. Shared containers are copied on write as usual.
+ * The table holds a reference to every canonical container, so they stay in memory until clear(), and
+ * the first write to any deduplicated container copies it even when no document shares it. Call clear()
+ * before modifying the documents, or use deduplicate(Value&) which drops its table on return.
+ */
+class Deduplicator {
+public:
+    inline Deduplicator(): size_(0), merged_(0) {}
+    inline ~Deduplicator() {}
+
+public:
+    void deduplicate(Value& value);
+    void clear();
+    inline size_t merged() const { return merged_; }
+
+private:
+    struct Node {
+        size_t hash;
+        size_t size; // nodes in the subtree, itself included
+    }; // Node struct
+
+    size_t hash(const Value& v);
+    void visit(Value& v, size_t& index);
+    size_t slot(const Value& v, const size_t& hash) const;
+    void grow();
+    static size_t mix(const size_t& h, const size_t& v);
+
+private:
+    std::vector<Value> slots_;  // canonical values, null for an empty slot
+    std::vector<size_t> hashes_;
+    std::vector<Node> nodes_;   // hashes of the value being deduplicated in pre-order
+    size_t size_;
+    size_t merged_;
+
+}; // Deduplicator class
+
+inline size_t deduplicate(Value& value) {
+    Deduplicator deduplicator;
+    deduplicator.deduplicate(value);
+    return deduplicator.merged();
+}
+
+/**
+ * Deduplicator class implementation.
+ */
+inline void Deduplicator::deduplicate(Value& value) {
+    nodes_.clear();
+    this->hash(value);
+    size_t index = 0;
+    this->visit(value, index);
+}
+inline void Deduplicator::clear() {
+    slots_.clear();
+    hashes_.clear();
+    nodes_.clear();
+    size_ = 0;
+    merged_ = 0;
+}
+
+/**
+ * Record the hash of v and of every value in it in pre-order, from the hashes of the children.
+ * Value::hash() would walk each subtree again for every container above it.
+ */
+inline size_t Deduplicator::hash(const Value& v) {
+    const size_t index = nodes_.size();
+    nodes_.push_back(Node());
+    size_t h = 0;
+    if (v.isArray()) {
+        const Array& array = v.as<Array>();
+        h = Deduplicator::mix(kArray, array.size());
+        for (size_t i = 0; i < array.size(); ++i) { h = Deduplicator::mix(h, this->hash(array[i])); }
+    } else if (v.isObject()) {
+        const Object& object = v.as<Object>();
+        h = Deduplicator::mix(kObject, object.size());
+        for (Object::const_iterator itr = object.begin(); itr != object.end(); ++itr) {
+            h = Deduplicator::mix(h, Key(itr->first).hash());
+            h = Deduplicator::mix(h, this->hash(itr->second));
+        }
+    } else {
+        h = v.hash();
+    }
+    nodes_[index].hash = h;
+    nodes_[index].size = nodes_.size() - index;
+    return h;
+}
+/**
+ * Replace v with its canonical value, or deduplicate its children and make it canonical.
+ * Equal subtrees are found before visiting children, so repeated subtrees are not walked twice.
+ * index is the pre-order position of v in nodes_, and is moved past its subtree.
+ */
+inline void Deduplicator::visit(Value& v, size_t& index) {
+    const Node node = nodes_[index];
+    if (!(v.type() & kContainer)) {
+        ++index;
+        return;
+    }
+    if (!slots_.empty()) {
+        const size_t i = this->slot(v, node.hash);
+        if (!slots_[i].isNull()) {
+            if (!v.shares(slots_[i])) {
+                v = slots_[i];
+                ++merged_;
+            }
+            index += node.size;
+            return;
+        }
+    }
+    ++index;
+    if (v.isArray()) {
+        Array& array = v.as<Array>();
+        for (size_t i = 0; i < array.size(); ++i) { this->visit(array[i], index); }
+    } else if (v.isObject()) {
+        Object& object = v.as<Object>();
+        for (Object::iterator itr = object.begin(); itr != object.end(); ++itr) { this->visit(itr->second, index); }
+    }
+    if ((size_ + 1) * 2 > slots_.size()) { this->grow(); }
+    const size_t hash = node.hash;
+    const size_t i = this->slot(v, hash);
+    slots_[i] = v;
+    hashes_[i] = hash;
+    ++size_;
+}
+/**
+ * Return the slot holding a value equal to v, or the empty slot to insert it into.
+ */
+inline size_t Deduplicator::slot(const Value& v, const size_t& hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (!slots_[i].isNull() && (hashes_[i] != hash || slots_[i] != v)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+inline size_t Deduplicator::mix(const size_t& h, const size_t& v) {
+    return h ^ (v + static_cast<size_t>(0x9e3779b97f4a7c15ULL) + (h << 6) + (h >> 2));
+}
+inline void Deduplicator::grow() {
+    std::vector<Value> slots(slots_.empty() ? 64 : slots_.size() * 2);
+    std::vector<size_t> hashes(slots.size(), 0);
+    slots_.swap(slots);
+    hashes_.swap(hashes);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].isNull()) { continue; }
+        size_t j = hashes[i] & (slots_.size() - 1);
+        while (!slots_[j].isNull()) { j = (j + 1) & (slots_.size() - 1); }
+        slots_[j].swap(slots[i]);
+        hashes_[j] = hashes[i];
+    }
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_DEDUP_H
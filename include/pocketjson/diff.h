@@ -0,0 +1,147 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_DIFF_H
+#define POCKETJSON_DIFF_H
+
+#include <pocketjson/pocketjson.h>
+
+namespace pocketjson {
+
+/**
+ * Compute JSON Patch (RFC 6902) which turns one value into another.
+ * Subtrees sharing a container are equal and skipped without being visited, so diffing a document
+ * against its updated() version costs only the changed paths. Arrays are matched by their common
+ * prefix and suffix, and the remaining elements are diffed by position.
+ */
+class Differ {
+public:
+    inline Differ() {}
+    inline ~Differ() {}
+
+public:
+    void diff(const Value& from, const Value& to, Value& patch);
+    Value diff(const Value& from, const Value& to);
+
+private:
+    void diff_value(const Value& from, const Value& to, Array& operations);
+    void diff_object(const Object& from, const Object& to, Array& operations);
+    void diff_array(const Array& from, const Array& to, Array& operations);
+    void add_operation(Array& operations, const char* op, const Value* v);
+    void push_key(const String& key);
+    void push_index(const size_t& index);
+
+private:
+    String pointer_;
+
+}; // Differ class
+
+inline Value diff(const Value& from, const Value& to) {
+    Differ differ;
+    return differ.diff(from, to);
+}
+
+/**
+ * Differ class implementation.
+ */
+inline void Differ::diff(const Value& from, const Value& to, Value& patch) {
+    pointer_.clear();
+    patch.setType(kArray);
+    Array& operations = patch.as<Array>();
+    operations.clear();
+    this->diff_value(from, to, operations);
+}
+inline Value Differ::diff(const Value& from, const Value& to) {
+    Value patch;
+    this->diff(from, to, patch);
+    return patch;
+}
+
+inline void Differ::diff_value(const Value& from, const Value& to, Array& operations) {
+    if (from.shares(to)) { return; }
+    if (from.type() == to.type() && from.isObject()) {
+        this->diff_object(from.as<Object>(), to.as<Object>(), operations);
+    } else if (from.type() == to.type() && from.isArray()) {
+        this->diff_array(from.as<Array>(), to.as<Array>(), operations);
+    } else if (from != to) {
+        this->add_operation(operations, "replace", &to);
+    }
+}
+inline void Differ::diff_object(const Object& from, const Object& to, Array& operations) {
+    const size_t length = pointer_.size();
+    Object::const_iterator f = from.begin();
+    Object::const_iterator t = to.begin();
+    while (f != from.end() || t != to.end()) {
+        if (t == to.end() || (f != from.end() && f->first < t->first)) {
+            this->push_key(f->first);
+            this->add_operation(operations, "remove", 0);
+            ++f;
+        } else if (f == from.end() || t->first < f->first) {
+            this->push_key(t->first);
+            this->add_operation(operations, "add", &t->second);
+            ++t;
+        } else {
+            this->push_key(f->first);
+            this->diff_value(f->second, t->second, operations);
+            ++f;
+            ++t;
+        }
+        pointer_.resize(length);
+    }
+}
+inline void Differ::diff_array(const Array& from, const Array& to, Array& operations) {
+    const size_t length = pointer_.size();
+    size_t prefix = 0;
+    while (prefix < from.size() && prefix < to.size() && from[prefix] == to[prefix]) { ++prefix; }
+    size_t suffix = 0;
+    while (suffix < from.size() - prefix && suffix < to.size() - prefix
+        && from[from.size() - suffix - 1] == to[to.size() - suffix - 1]) { ++suffix; }
+
+    const size_t fromCount = from.size() - prefix - suffix;
+    const size_t toCount = to.size() - prefix - suffix;
+    for (size_t i = 0; i < fromCount && i < toCount; ++i) {
+        this->push_index(prefix + i);
+        this->diff_value(from[prefix + i], to[prefix + i], operations);
+        pointer_.resize(length);
+    }
+    // Removing at the same index drops the following elements one by one.
+    for (size_t i = toCount; i < fromCount; ++i) {
+        this->push_index(prefix + toCount);
+        this->add_operation(operations, "remove", 0);
+        pointer_.resize(length);
+    }
+    for (size_t i = fromCount; i < toCount; ++i) {
+        this->push_index(prefix + i);
+        this->add_operation(operations, "add", &to[prefix + i]);
+        pointer_.resize(length);
+    }
+}
+inline void Differ::add_operation(Array& operations, const char* op, const Value* v) {
+    operations.push_back(Value(kObject));
+    Object& operation = operations.back().as<Object>();
+    operation["op"] = op;
+    operation["path"] = pointer_;
+    if (v) { operation["value"] = *v; }
+}
+inline void Differ::push_key(const String& key) {
+    pointer_.push_back('/');
+    for (size_t i = 0; i < key.size(); ++i) {
+        switch (key[i]) {
+        case '~': pointer_.append("~0"); break;
+        case '/': pointer_.append("~1"); break;
+        default: pointer_.push_back(key[i]); break;
+        }
+    }
+}
+inline void Differ::push_index(const size_t& index) {
+    pointer_.push_back('/');
+    Serializer::uint64ToString(std::back_inserter(pointer_), index);
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_DIFF_H
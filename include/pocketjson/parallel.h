@@ -0,0 +1,334 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_PARALLEL_H
+#define POCKETJSON_PARALLEL_H
+
+// Parallel parsing requires C++11.
+#include <pocketjson/pocketjson.h>
+#include <string.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace pocketjson {
+
+/**
+ * Parse a large top-level array on several threads.
+ * The array is split into chunks at top-level commas found by a string-aware scan, each chunk is parsed
+ * on its own thread, and the elements are put together in order. Input which is not a top-level array,
+ * is smaller than two chunks or uses kParseOptionAllowLooseFormat is parsed sequentially, and so is any
+ * input where a chunk fails, so errors are reported as the sequential parser reports them.
+ * Worker threads are started by the first parallel parse and kept until the parser is destroyed.
+ * Chunks are parsed without a StringPool and Stats are not recorded, since the chunk parsers would
+ * share the pool between threads.
+ */
+class ParallelParser {
+public:
+    inline explicit ParallelParser(const size_t& threads = 0, const size_t& minChunkSize = 1 << 20)
+        : threads_(threads ? threads : std::thread::hardware_concurrency()), minChunkSize_(minChunkSize ? minChunkSize : 1),
+          generation_(0), pending_(0), stop_(false) {
+        if (threads_ == 0) { threads_ = 1; }
+    }
+    ~ParallelParser();
+
+public:
+    bool parse(Value& value, const char* begin, const char* end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    bool parse(Value& value, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+    /**
+     * Events of chunk i go to handlers[i]; concatenated in order, they are the events of a sequential parse.
+     * Sequential input goes to handlers[0]. A handler returning false stops its own chunk only, and on
+     * any failure the other handlers may have received events of elements after the error.
+     * Without handlers the input is only validated.
+     */
+    template<typename Handler> bool parse(std::vector<Handler>& handlers, const char* begin, const char* end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    template<typename Handler> bool parse(std::vector<Handler>& handlers, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+    inline const ParseError& error() const { return parser_.error(); }
+    // Chunks of the last parse call, 1 when it was sequential.
+    inline size_t chunks() const { return chunks_.size() ? chunks_.size() : 1; }
+
+private:
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        size_t count;
+        bool ok;
+    }; // Chunk struct
+
+    bool split(const char* begin, const char* end, const ParseOption& options, const size_t& limit);
+    template<int Target, typename Handler> void run(Handler* handlers, const ParseOption& options);
+    void work(const size_t& i, size_t generation);
+    template<int Target, typename Handler> bool parse_chunk(const size_t& i, Handler* handler, const ParseOption& options);
+    template<int Options, int Target, typename Handler> bool parse_chunk(const size_t& i, Handler* handler);
+    void locate(const char* begin, const char* base, ParseError& error) const;
+    void cancel(const char* begin, const char* at);
+
+private:
+    size_t threads_;
+    size_t minChunkSize_;
+    Parser parser_;
+    std::vector<Parser> parsers_;
+    std::vector<Array> arrays_;
+    std::vector<Chunk> chunks_;
+
+    // Worker i parses chunk i + 1 of each generation.
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable started_;
+    std::condition_variable finished_;
+    std::function<void(const size_t&)> task_;
+    size_t generation_;
+    size_t pending_;
+    bool stop_;
+
+}; // ParallelParser class
+
+inline bool parseParallel(Value& value, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0) {
+    ParallelParser parser;
+    return parser.parse(value, str, options, errorMessage);
+}
+
+/**
+ * ParallelParser class implementation.
+ */
+inline ParallelParser::~ParallelParser() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    started_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+}
+
+inline bool ParallelParser::parse(Value& value, const char* begin, const char* end, const ParseOption& options, String* errorMessage) {
+    if (!this->split(begin, end, options, threads_)) {
+        return parser_.parse(value, begin, end, options, errorMessage);
+    }
+    this->run<Parser::kTargetValue>(static_cast<AbstractParseHandler*>(0), options);
+    size_t count = 0;
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        if (!chunks_[i].ok) {
+            // The split may be wrong for broken input, so the sequential parser finds the error.
+            chunks_.clear();
+            return parser_.parse(value, begin, end, options, errorMessage);
+        }
+        count += chunks_[i].count;
+    }
+    value.setNull();
+    value.setType(kArray);
+    Array& array = value.as<Array>();
+    array.reserve(count);
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        std::move(arrays_[i].begin(), arrays_[i].end(), std::back_inserter(array));
+        arrays_[i].clear();
+    }
+    parser_.error_.clear();
+    if (errorMessage) { errorMessage->clear(); }
+    return true;
+}
+inline bool ParallelParser::parse(Value& value, const String& str, const ParseOption& options, String* errorMessage) {
+    const char* data = str.data();
+    return this->parse(value, data, data + str.size(), options, errorMessage);
+}
+template<typename Handler> inline bool ParallelParser::parse(std::vector<Handler>& handlers, const char* begin, const char* end, const ParseOption& options, String* errorMessage) {
+    if (handlers.empty()) {
+        return parser_.validate(begin, end, options, errorMessage);
+    }
+    if (!this->split(begin, end, options, std::min(threads_, handlers.size()))) {
+        return parser_.parse(&handlers[0], begin, end, options, errorMessage);
+    }
+    parser_.error_.clear();
+    if (!handlers[0].beginArray()) {
+        this->cancel(begin, chunks_[0].begin - 1);
+    } else {
+        this->run<Parser::kTargetHandler>(&handlers[0], options);
+        size_t count = 0;
+        for (size_t i = 0; i < chunks_.size(); ++i) {
+            if (!chunks_[i].ok) {
+                // Events already sent cannot be taken back, so the sequential parser only validates.
+                if (parser_.validate(begin, end, options)) {
+                    parser_.error_ = parsers_[i].error();
+                    this->locate(begin, chunks_[i].begin, parser_.error_);
+                }
+                break;
+            }
+            count += chunks_[i].count;
+        }
+        if (parser_.error_.code == kErrorNone && !handlers[chunks_.size() - 1].endArray(count)) {
+            this->cancel(begin, chunks_.back().end);
+        }
+    }
+    if (errorMessage) { errorMessage->assign(parser_.error_.message()); }
+    return parser_.error_.code == kErrorNone;
+}
+template<typename Handler> inline bool ParallelParser::parse(std::vector<Handler>& handlers, const String& str, const ParseOption& options, String* errorMessage) {
+    const char* data = str.data();
+    return this->parse(handlers, data, data + str.size(), options, errorMessage);
+}
+
+/**
+ * Find up to limit chunks of the elements of a top-level array.
+ * Strings are skipped to the next unescaped quote, and the chunks end at the first comma at depth 0
+ * after every limit-th part of the body. Returns false when the input should be parsed sequentially.
+ */
+inline bool ParallelParser::split(const char* begin, const char* end, const ParseOption& options, const size_t& limit) {
+    chunks_.clear();
+    if (options & kParseOptionAllowLooseFormat) { return false; }
+    const char* p = begin;
+    if (end - p >= 3 && (unsigned char)p[0] == 0xef && (unsigned char)p[1] == 0xbb && (unsigned char)p[2] == 0xbf) { p += 3; }
+    while (p < end && parser_.is_white_space(*p)) { ++p; }
+    const char* last = end;
+    while (last > p && parser_.is_white_space(last[-1])) { --last; }
+    if (last - p < 2 || *p != '[' || last[-1] != ']') { return false; }
+
+    const char* body = p + 1;
+    const char* bodyEnd = last - 1;
+    const size_t size = static_cast<size_t>(bodyEnd - body);
+    const size_t parts = std::min(limit, size / minChunkSize_);
+    if (parts < 2) { return false; }
+
+    size_t depth = 0;
+    const char* chunkBegin = body;
+    const char* target = body + size / parts;
+    for (p = body; p < bodyEnd; ++p) {
+        const char c = *p;
+        if (c == '"') {
+            for (;;) {
+                p = static_cast<const char*>(memchr(p + 1, '"', static_cast<size_t>(bodyEnd - p - 1)));
+                if (!p) { return false; }
+                size_t escapes = 0;
+                while (p[-1 - static_cast<ptrdiff_t>(escapes)] == '\\') { ++escapes; }
+                if (escapes % 2 == 0) { break; }
+            }
+        } else if (c == '[' || c == '{') {
+            ++depth;
+        } else if (c == ']' || c == '}') {
+            if (depth == 0) { return false; }
+            --depth;
+        } else if (c == ',' && depth == 0 && p >= target) {
+            const Chunk chunk = { chunkBegin, p, 0, false };
+            chunks_.push_back(chunk);
+            chunkBegin = p + 1;
+            if (chunks_.size() + 1 == parts) { break; }
+            target = body + size * (chunks_.size() + 1) / parts;
+        }
+    }
+    if (chunks_.empty()) { return false; }
+    const Chunk chunk = { chunkBegin, bodyEnd, 0, false };
+    chunks_.push_back(chunk);
+    return true;
+}
+/**
+ * Parse the chunks, the first one on the calling thread and the others on the workers.
+ */
+template<int Target, typename Handler> inline void ParallelParser::run(Handler* handlers, const ParseOption& options) {
+    if (parsers_.size() < chunks_.size()) { parsers_.resize(chunks_.size()); }
+    if (arrays_.size() < chunks_.size()) { arrays_.resize(chunks_.size()); }
+    while (workers_.size() + 1 < chunks_.size()) {
+        // Only the calling thread changes generation_, and no generation is running now.
+        const size_t i = workers_.size();
+        const size_t generation = generation_;
+        workers_.push_back(std::thread([this, i, generation]() { this->work(i, generation); }));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = [this, handlers, options](const size_t& i) {
+            chunks_[i].ok = this->parse_chunk<Target>(i, handlers ? handlers + i : 0, options);
+        };
+        pending_ = workers_.size();
+        ++generation_;
+    }
+    started_.notify_all();
+    chunks_[0].ok = this->parse_chunk<Target>(0, handlers, options);
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this]() { return pending_ == 0; });
+}
+/**
+ * Loop of worker i, which parses chunk i + 1 of every generation after the given one that has it.
+ */
+inline void ParallelParser::work(const size_t& i, size_t generation) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        started_.wait(lock, [this, generation]() { return stop_ || generation_ != generation; });
+        if (stop_) { return; }
+        generation = generation_;
+        if (i + 1 < chunks_.size()) {
+            lock.unlock();
+            task_(i + 1);
+            lock.lock();
+        }
+        if (--pending_ == 0) { finished_.notify_one(); }
+    }
+}
+template<int Target, typename Handler> inline bool ParallelParser::parse_chunk(const size_t& i, Handler* handler, const ParseOption& options) {
+    parsers_[i].rawNumber_ = (options & kParseOptionRawNumber) != 0;
+    if (options & kParseOptionValidateUtf8) {
+        return this->parse_chunk<kParseOptionValidateUtf8, Target>(i, handler);
+    }
+    return this->parse_chunk<kParseOptionNone, Target>(i, handler);
+}
+/**
+ * Parse the comma separated elements of chunk i, into arrays_[i] or to the handler.
+ */
+template<int Options, int Target, typename Handler> inline bool ParallelParser::parse_chunk(const size_t& i, Handler* handler) {
+    Parser& parser = parsers_[i];
+    Chunk& chunk = chunks_[i];
+    Array* array = Target == Parser::kTargetValue ? &arrays_[i] : 0;
+    parser.error_.clear();
+    chunk.count = 0;
+    if (array) { array->clear(); }
+    Parser::Iterator<const char*> itr(chunk.begin, chunk.end);
+    for (;;) {
+        bool ok;
+        if (array) {
+            array->push_back(Value());
+            ok = parser.parse_value<Options, Target>(&array->back(), handler, itr);
+        } else {
+            ok = parser.parse_value<Options, Target>(0, handler, itr);
+        }
+        ++chunk.count;
+        if (!ok) { return false; }
+        parser.skip_white_space(itr);
+        if (!itr) { return true; }
+        if (*itr != ',') { return parser.fail(kErrorArraySeparator, itr); }
+        ++itr;
+    }
+}
+/**
+ * Turn a position of an error from the parser starting at base into a position in the input.
+ */
+inline void ParallelParser::locate(const char* begin, const char* base, ParseError& error) const {
+    size_t line = 1;
+    const char* lineBegin = begin;
+    for (const char* p = begin; p < base; ++p) {
+        if (*p == '\n') { ++line; lineBegin = p + 1; }
+    }
+    if (error.line == 1) {
+        error.column += static_cast<size_t>(base - lineBegin);
+    }
+    error.line += line - 1;
+    error.offset += static_cast<size_t>(base - begin);
+}
+/**
+ * Fail with kErrorHandlerCancel at the bracket of the top-level array.
+ */
+inline void ParallelParser::cancel(const char* begin, const char* at) {
+    parser_.error_.code = kErrorHandlerCancel;
+    parser_.error_.offset = 0;
+    parser_.error_.line = 1;
+    parser_.error_.column = 1;
+    this->locate(begin, at, parser_.error_);
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_PARALLEL_H
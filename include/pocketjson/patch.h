@@ -0,0 +1,302 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_PATCH_H
+#define POCKETJSON_PATCH_H
+
+#include <pocketjson/pocketjson.h>
+
+namespace pocketjson {
+
+/**
+ * Parse JSON Pointer (RFC 6901) into path. Every reference token becomes a key component,
+ * which addresses an array element when it is made of digits or is "-".
+ */
+inline bool parsePointer(const String& pointer, Path& path) {
+    path.clear();
+    if (pointer.empty()) { return true; }
+    if (pointer[0] != '/') { return false; }
+    String token;
+    for (size_t i = 1; i <= pointer.size(); ++i) {
+        if (i == pointer.size() || pointer[i] == '/') {
+            path.key(token);
+            token.clear();
+        } else if (pointer[i] == '~') {
+            if (i + 1 >= pointer.size() || (pointer[i + 1] != '0' && pointer[i + 1] != '1')) { return false; }
+            token.push_back(pointer[i + 1] == '0' ? '~' : '/');
+            ++i;
+        } else {
+            token.push_back(pointer[i]);
+        }
+    }
+    return true;
+}
+inline const Value* resolve(const Value& value, const String& pointer) {
+    Path path;
+    return parsePointer(pointer, path) ? value.find(path) : 0;
+}
+
+/**
+ * Apply JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7396).
+ * Only containers on the addressed paths are detached, and subtrees are moved or shared by
+ * reference count rather than copied. A patch is applied atomically: when an operation fails,
+ * the operations already applied are undone in reverse order.
+ */
+class Patcher {
+public:
+    inline Patcher() {}
+    inline ~Patcher() {}
+
+public:
+    bool apply(Value& value, const Value& patch, String* errorMessage = 0);
+    void merge(Value& value, const Value& patch);
+
+private:
+    enum UndoType {
+        kUndoSet,
+        kUndoInsert,
+        kUndoErase
+    }; // UndoType enum
+
+    struct Undo {
+        UndoType type;
+        Path path;
+        Value value;
+    }; // Undo struct
+
+    bool apply_operation(Value& root, const Value& operation);
+    bool add(Value& root, const Path& path, const Value& v);
+    bool remove(Value& root, const Path& path, Value& removed);
+    bool replace(Value& root, const Path& path, const Value& v);
+    Value* walk(Value& root, const Path& path, const size_t& count);
+    void record(const UndoType& type, const Path& path, const size_t* index, const Value& v);
+    void rollback(Value& root);
+    bool fail(const char* message);
+    static bool is_prefix(const Path& prefix, const Path& path);
+
+private:
+    Path path_;
+    Path from_;
+    std::vector<Undo> undo_;
+    String error_;
+
+}; // Patcher class
+
+inline bool patch(Value& value, const Value& operations, String* errorMessage = 0) {
+    Patcher patcher;
+    return patcher.apply(value, operations, errorMessage);
+}
+inline void mergePatch(Value& value, const Value& patch) {
+    Patcher patcher;
+    patcher.merge(value, patch);
+}
+
+/**
+ * Patcher class implementation.
+ */
+inline bool Patcher::apply(Value& value, const Value& patch, String* errorMessage) {
+    error_.clear();
+    undo_.clear();
+    bool ok = true;
+    if (!patch.isArray()) {
+        ok = this->fail("Patch is not an array.");
+    } else {
+        const Array& operations = patch.as<Array>();
+        for (size_t i = 0; ok && i < operations.size(); ++i) {
+            if (!this->apply_operation(value, operations[i])) {
+                error_ = "operation " + Serializer::int64ToString(static_cast<int64_t>(i)) + ": " + error_;
+                ok = false;
+            }
+        }
+    }
+    if (!ok) {
+        this->rollback(value);
+    }
+    // Undo entries share subtrees with the document, which would make the next update copy them.
+    undo_.clear();
+    if (errorMessage) { *errorMessage = error_; }
+    return ok;
+}
+inline void Patcher::merge(Value& value, const Value& patch) {
+    if (!patch.isObject()) {
+        const Value tmp(patch);
+        value = tmp;
+        return;
+    }
+    value.setType(kObject);
+    const Object& members = patch.as<Object>();
+    for (Object::const_iterator itr = members.begin(); itr != members.end(); ++itr) {
+        Object& object = value.as<Object>();
+        if (itr->second.isNull()) {
+            object.erase(itr->first);
+        } else {
+            this->merge(object[itr->first], itr->second);
+        }
+    }
+}
+
+inline bool Patcher::apply_operation(Value& root, const Value& operation) {
+    if (!operation.isObject()) { return this->fail("Operation is not an object."); }
+    const Value& op = operation["op"];
+    const Value& path = operation["path"];
+    if (!op.isString()) { return this->fail("Member \"op\" is not a string."); }
+    if (!path.isString() || !parsePointer(path.as<String>(), path_)) { return this->fail("Member \"path\" is not a JSON Pointer."); }
+    const String& name = op.as<String>();
+
+    if (name == "add" || name == "replace" || name == "test") {
+        if (!operation.contains("value")) { return this->fail("Member \"value\" is missing."); }
+        const Value& v = operation["value"];
+        if (name == "add") { return this->add(root, path_, v); }
+        if (name == "replace") { return this->replace(root, path_, v); }
+        const Value* target = root.find(path_);
+        if (!target) { return this->fail("Path is not found."); }
+        return *target == v ? true : this->fail("Test failed.");
+    } else if (name == "remove") {
+        Value removed;
+        return this->remove(root, path_, removed);
+    } else if (name == "move" || name == "copy") {
+        const Value& from = operation["from"];
+        if (!from.isString() || !parsePointer(from.as<String>(), from_)) { return this->fail("Member \"from\" is not a JSON Pointer."); }
+        if (name == "copy") {
+            const Value* source = root.find(from_);
+            if (!source) { return this->fail("From is not found."); }
+            const Value shared(*source);
+            return this->add(root, path_, shared);
+        }
+        if (from_.size() == path_.size() && Patcher::is_prefix(from_, path_)) {
+            return root.find(from_) ? true : this->fail("From is not found.");
+        }
+        if (Patcher::is_prefix(from_, path_)) { return this->fail("Value cannot be moved into its own child."); }
+        Value moved;
+        return this->remove(root, from_, moved) && this->add(root, path_, moved);
+    }
+    return this->fail("Unknown operation.");
+}
+inline bool Patcher::add(Value& root, const Path& path, const Value& v) {
+    const Value tmp(v);
+    if (path.empty()) {
+        this->record(kUndoSet, path, 0, root);
+        root = tmp;
+        return true;
+    }
+    Value* parent = this->walk(root, path, path.size() - 1);
+    if (!parent) { return this->fail("Parent of the path is not found."); }
+    const size_t last = path.size() - 1;
+    if (parent->isObject()) {
+        Object& object = parent->as<Object>();
+        const Object::iterator itr = object.find(path.keyAt(last));
+        if (itr != object.end()) {
+            this->record(kUndoSet, path, 0, itr->second);
+            itr->second = tmp;
+        } else {
+            object.insert(std::make_pair(path.keyAt(last), tmp));
+            this->record(kUndoErase, path, 0, Value());
+        }
+        return true;
+    } else if (parent->isArray()) {
+        Array& array = parent->as<Array>();
+        size_t i = 0;
+        if (!path.indexAt(last, array.size(), i) || i > array.size()) { return this->fail("Array index is out of range."); }
+        array.insert(array.begin() + i, tmp);
+        this->record(kUndoErase, path, &i, Value());
+        return true;
+    }
+    return this->fail("Parent of the path is not a container.");
+}
+inline bool Patcher::remove(Value& root, const Path& path, Value& removed) {
+    if (path.empty()) { return this->fail("Document root cannot be removed."); }
+    Value* parent = this->walk(root, path, path.size() - 1);
+    const size_t last = path.size() - 1;
+    if (parent && parent->isObject()) {
+        Object& object = parent->as<Object>();
+        const Object::iterator itr = object.find(path.keyAt(last));
+        if (itr != object.end()) {
+            removed.swap(itr->second);
+            this->record(kUndoInsert, path, 0, removed);
+            object.erase(itr);
+            return true;
+        }
+    } else if (parent && parent->isArray()) {
+        Array& array = parent->as<Array>();
+        size_t i = 0;
+        if (path.indexAt(last, array.size(), i) && i < array.size()) {
+            removed.swap(array[i]);
+            this->record(kUndoInsert, path, &i, removed);
+            array.erase(array.begin() + i);
+            return true;
+        }
+    }
+    return this->fail("Path is not found.");
+}
+inline bool Patcher::replace(Value& root, const Path& path, const Value& v) {
+    const Value tmp(v);
+    Value* target = this->walk(root, path, path.size());
+    if (!target) { return this->fail("Path is not found."); }
+    this->record(kUndoSet, path, 0, *target);
+    *target = tmp;
+    return true;
+}
+/**
+ * Detach the containers on the first count components of path and return the value they address.
+ */
+inline Value* Patcher::walk(Value& root, const Path& path, const size_t& count) {
+    Value* v = &root;
+    for (size_t i = 0; v && i < count; ++i) {
+        if (v->isObject()) {
+            Object& object = v->as<Object>();
+            const Object::iterator itr = object.find(path.keyAt(i));
+            v = itr != object.end() ? &itr->second : 0;
+        } else if (v->isArray()) {
+            Array& array = v->as<Array>();
+            size_t index = 0;
+            v = path.indexAt(i, array.size(), index) && index < array.size() ? &array[index] : 0;
+        } else {
+            v = 0;
+        }
+    }
+    return v;
+}
+/**
+ * Record how to undo a step. An array index replaces the last component, so "-" is undone at the right place.
+ */
+inline void Patcher::record(const UndoType& type, const Path& path, const size_t* index, const Value& v) {
+    undo_.push_back(Undo());
+    Undo& undo = undo_.back();
+    undo.type = type;
+    if (index) {
+        for (size_t i = 0; i + 1 < path.size(); ++i) { undo.path.key(path.keyAt(i)); }
+        undo.path.index(*index);
+    } else {
+        undo.path = path;
+    }
+    undo.value = v;
+}
+inline void Patcher::rollback(Value& root) {
+    for (size_t i = undo_.size(); i > 0; --i) {
+        const Undo& undo = undo_[i - 1];
+        switch (undo.type) {
+        case kUndoSet: root.set(undo.path, undo.value); break;
+        case kUndoInsert: root.insert(undo.path, undo.value); break;
+        case kUndoErase: root.erase(undo.path); break;
+        }
+    }
+}
+inline bool Patcher::fail(const char* message) {
+    error_ = message;
+    return false;
+}
+inline bool Patcher::is_prefix(const Path& prefix, const Path& path) {
+    if (prefix.size() > path.size()) { return false; }
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (prefix.keyAt(i) != path.keyAt(i)) { return false; }
+    }
+    return true;
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_PATCH_H
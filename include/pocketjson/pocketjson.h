@@ -8,8 +8,10 @@
 #ifndef POCKETJSON_H
 #define POCKETJSON_H
 
+#include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include <limits.h>
 #include <locale.h>
@@ -20,6 +22,10 @@
 #include <iostream>
 #include <algorithm>
 #include <utility>
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define _POCKETJSON_HAS_STRING_VIEW
+#include <string_view>
+#endif
 
 #ifdef _MSC_VER
 #if _MSC_VER >= 1600
@@ -37,12 +43,86 @@
 #define _POCKETJSON_HAS_RVALUE_REFERENCES
 #endif
 
+// std::map finds a key of another type through a transparent comparator from C++14.
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define _POCKETJSON_HAS_TRANSPARENT_LOOKUP
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif !defined(__GNUC__) && !defined(__clang__)
+#include <atomic>
+#endif
+
+// SSE2 scans strings of contiguous input in Parser::validate. Define POCKETJSON_DISABLE_SIMD to use scalar code only.
+#if !defined(POCKETJSON_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define _POCKETJSON_SSE2
+#include <emmintrin.h>
+#endif
+
+// Define POCKETJSON_ENABLE_STATS to record Stats of Parser and Serializer (requires C++11).
+// Classes have the same layout either way, but inline function bodies differ, so define it
+// in every translation unit of a program or in none of them.
+#ifdef POCKETJSON_ENABLE_STATS
+#include <chrono>
+#define _POCKETJSON_STATS(expr) expr
+#else
+#define _POCKETJSON_STATS(expr)
+#endif
+
 namespace pocketjson {
 
 class Value;
+class FrozenValue;
+class Path;
+class Decoder;
+class Encoder;
+class Reformatter;
+class ParallelParser;
 typedef std::string String;
+
+/**
+ * Object key referring to characters with their length and hash computed once,
+ * for lookups repeated in loops. The characters are not copied and must outlive the key.
+ */
+class Key {
+public:
+    explicit Key(const char* str);
+    Key(const char* data, const size_t& size);
+    explicit Key(const String& str);
+    inline ~Key() {}
+
+public:
+    inline const char* data() const { return data_; }
+    inline size_t size() const { return size_; }
+    // Hash of the characters, the one Value::hash() mixes for object keys.
+    inline size_t hash() const { return hash_; }
+    inline String toString() const { return String(data_, size_); }
+    inline int compare(const String& str) const {
+        const size_t n = size_ < str.size() ? size_ : str.size();
+        const int c = n ? memcmp(data_, str.data(), n) : 0;
+        return c != 0 ? c : (size_ < str.size() ? -1 : (size_ > str.size() ? 1 : 0));
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t hash_;
+}; // Key class
+
+/**
+ * Order of object keys. It is transparent, so Key lookups do not build a String (C++14).
+ */
+struct KeyLess {
+    typedef void is_transparent;
+    inline bool operator()(const String& lhs, const String& rhs) const { return lhs < rhs; }
+    inline bool operator()(const String& lhs, const Key& rhs) const { return rhs.compare(lhs) > 0; }
+    inline bool operator()(const Key& lhs, const String& rhs) const { return lhs.compare(rhs) < 0; }
+}; // KeyLess struct
+
 typedef std::vector<Value> Array;
-typedef std::map<String, Value> Object;
+// KeyLess makes Object a different type from std::map<String, Value>, also in mangled names.
+typedef std::map<String, Value, KeyLess> Object;
 
 enum Type {
     kNull     = 0x00,
@@ -60,7 +140,10 @@ enum ParseOption {
     kParseOptionNone = 0x00,
     kParseOptionAllowCommaEnding = 0x01,
     kParseOptionAllowGabage = 0x02,
-    kParseOptionAllowLooseFormat = kParseOptionAllowCommaEnding | kParseOptionAllowGabage
+    kParseOptionAllowLooseFormat = kParseOptionAllowCommaEnding | kParseOptionAllowGabage,
+    kParseOptionReuseValue = 0x04,
+    kParseOptionValidateUtf8 = 0x08,
+    kParseOptionRawNumber = 0x10
 }; // ParseOption enum
 
 enum SerializeOption {
@@ -76,6 +159,38 @@ enum SerializeOption {
     kSerializeOptionPrettyTabCRLF = kSerializeOptionPretty | kSerializeOptionTab | kSerializeOptionCRLF
 }; // SerializeOption enum
 
+enum ErrorCode {
+    kErrorNone = 0,
+    kErrorGabage,
+    kErrorUnexpectedCharacter,
+    kErrorInvalidBoolean,
+    kErrorInvalidNull,
+    kErrorLeadingZero,
+    kErrorMissingDigit,
+    kErrorMissingFraction,
+    kErrorMissingExponent,
+    kErrorInvalidFloat,
+    kErrorInvalidHex,
+    kErrorInvalidSurrogate,
+    kErrorInvalidEscape,
+    kErrorUnterminatedString,
+    kErrorInvalidUtf8,
+    kErrorArrayTrailingComma,
+    kErrorArraySeparator,
+    kErrorUnterminatedArray,
+    kErrorObjectTrailingComma,
+    kErrorObjectSeparator,
+    kErrorUnterminatedObject,
+    kErrorHandlerCancel,
+    kErrorExpectedBoolean,
+    kErrorExpectedInteger,
+    kErrorIntegerRange,
+    kErrorExpectedNumber,
+    kErrorExpectedString,
+    kErrorExpectedArray,
+    kErrorExpectedObject
+}; // ErrorCode enum
+
 /**
  * Json value class.
  */
@@ -136,6 +251,15 @@ public:
     const Value& operator [](const String& key) const;
     Value& operator [](const size_t& index);
     const Value& operator [](const size_t& index) const;
+    // Lookups by a string literal, const char* or Key build no String. value[0] still takes the index.
+    Value& operator [](const Key& key);
+    const Value& operator [](const Key& key) const;
+    template<typename T> Value& operator [](T* key);
+    template<typename T> const Value& operator [](T* key) const;
+#ifdef _POCKETJSON_HAS_STRING_VIEW
+    Value& operator [](const std::string_view& key);
+    const Value& operator [](const std::string_view& key) const;
+#endif
 
 public:
     void push_back(const Value& v);
@@ -144,6 +268,15 @@ public:
     void erase(const String& key);
     void clear();
 
+    bool set(const Path& path, const Value& v);
+    bool insert(const Path& path, const Value& v);
+    bool erase(const Path& path);
+    const Value* find(const Path& path) const;
+
+    Value updated(const Path& path, const Value& v) const;
+    Value inserted(const Path& path, const Value& v) const;
+    Value erased(const Path& path) const;
+
     void setType(const Type& t);
     void setNull();
     void setBoolean(const bool& v);
@@ -168,6 +301,8 @@ public:
     template<typename Iter> bool serialize(const Iter& itr, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) const;
     bool serialize(String& str, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) const;
     String serialize(const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) const;
+    template<int Options> bool serialize(String& str, String* errorMessage = 0) const;
+    template<int Options> String serialize(String* errorMessage = 0) const;
 
 public:
     const Type& type() const;
@@ -200,23 +335,68 @@ public:
     size_t size() const;
     bool contains(const String& key) const;
     bool contains(const size_t& index) const;
+    bool contains(const Key& key) const;
+    template<typename T> bool contains(T* key) const;
+#ifdef _POCKETJSON_HAS_STRING_VIEW
+    bool contains(const std::string_view& key) const;
+#endif
+    bool shares(const Value& v) const;
+    size_t hash() const;
 
     void swap(Value& v);
+    FrozenValue freeze() const;
 
     template<typename T> bool is() const;
     template<typename T> T& as();
+    // Raw floats of kParseOptionRawNumber are read with toDouble(), or the non-const as<double>() which decodes them.
     template<typename T> const T& as() const;
 
 private:
     static const Value& s_null();
     void release();
+    void detach();
+    Value* child(const Path& path, const size_t& index);
+    bool in_range(const int64_t& minValue, const int64_t& maxValue) const;
+    double float_value() const;
+    void setRawFloat(const uint64_t& significand, const uint8_t& flags, const uint32_t& fraction, const int& exponent);
+    template<typename Iter> void raw_to_string(Iter& itr) const;
+    uint64_t hash_value() const;
+    static uint64_t hash_mix(const uint64_t& h, const uint64_t& v);
+    static uint64_t hash_string(const char* data, const size_t& size);
+    static Object::const_iterator find_key(const Object& object, const Key& key);
 
 private:
+    friend class Parser;
+    friend class Serializer;
+    friend class Key;
     class AbstractContainer;
     template<typename T> class Container;
 
+    enum NumberFlag {
+        kNumberUnsigned = 0x01,         // integer_ holds a uint64_t above INT64_MAX
+        kNumberRaw = 0x02,              // integer_ holds the decimal significand of a float
+        kNumberNegative = 0x04,
+        kNumberExponent = 0x08,
+        kNumberUpperExponent = 0x10,
+        kNumberPlusExponent = 0x20,
+        kNumberMinusExponent = 0x40,
+        kMemberTouched = 0x80           // member of an object being parsed with kParseOptionReuseValue, cleared when it closes
+    }; // NumberFlag enum
+
+    /**
+     * How a number was written. A raw float is significand * 10^(exponent - fraction),
+     * and fraction and exponent keep the digits after '.' and the written exponent.
+     */
+    struct NumberFormat {
+        inline NumberFormat(): flags(0), fraction(0), exponent(0) {}
+        uint8_t flags;
+        uint8_t fraction;
+        int16_t exponent;
+    }; // NumberFormat struct
+
 private:
     Type type_;
+    NumberFormat format_;
     union {
         bool boolean_;
         int64_t integer_;
@@ -226,10 +406,201 @@ private:
 
 }; // Value class
 
+/**
+ * Hash function object for hash tables keyed by Value, e.g. std::unordered_map<Value, T, ValueHash>.
+ */
+struct ValueHash {
+    inline size_t operator()(const Value& v) const { return v.hash(); }
+}; // ValueHash struct
+
+/**
+ * Path to a value in a tree.
+ * Each component is an object key or an array index. A key component made of digits
+ * addresses an array element, and "-" addresses the end of an array.
+ */
+class Path {
+public:
+    inline Path() {}
+    inline ~Path() {}
+
+public:
+    inline Path& key(const String& key) { components_.push_back(Component(key, 0, false)); return *this; }
+    inline Path& index(const size_t& index) { components_.push_back(Component(String(), index, true)); return *this; }
+
+    inline size_t size() const { return components_.size(); }
+    inline bool empty() const { return components_.empty(); }
+    inline void clear() { components_.clear(); }
+    inline const String& keyAt(const size_t& i) const { return components_[i].key; }
+    bool indexAt(const size_t& i, const size_t& arraySize, size_t& index) const;
+
+private:
+    struct Component {
+        inline Component(const String& k, const size_t& i, const bool& n): key(k), index(i), isIndex(n) {}
+        String key;
+        size_t index;
+        bool isIndex;
+    }; // Component struct
+
+    std::vector<Component> components_;
+}; // Path class
+
+/**
+ * Atomic reference counter class.
+ */
+class AtomicCounter {
+public:
+    inline AtomicCounter(const uint32_t& v): value_(v) {}
+    inline ~AtomicCounter() {}
+
+public:
+    uint32_t load() const;
+    void increment();
+    bool decrement();
+
+private:
+    AtomicCounter(const AtomicCounter&);
+    AtomicCounter& operator =(const AtomicCounter&);
+
+private:
+#if defined(_MSC_VER)
+    volatile long value_;
+#elif defined(__GNUC__) || defined(__clang__)
+    uint32_t value_;
+#else
+    std::atomic<uint32_t> value_;
+#endif
+}; // AtomicCounter class
+
+/**
+ * Read only view of a value in a frozen tree.
+ * A view never copies a Value, so no reference count is touched while reading.
+ * It is valid while a FrozenValue of the tree is alive.
+ */
+class FrozenView {
+public:
+    inline FrozenView(): value_(&FrozenView::s_null()) {}
+    inline explicit FrozenView(const Value& value): value_(&value) {}
+    inline ~FrozenView() {}
+
+public:
+    inline FrozenView operator [](const String& key) const { return FrozenView((*value_)[key]); }
+    inline FrozenView operator [](const size_t& index) const { return FrozenView((*value_)[index]); }
+    inline FrozenView operator [](const Key& key) const { return FrozenView((*value_)[key]); }
+    template<typename T> inline FrozenView operator [](T* key) const { return FrozenView((*value_)[Key(key)]); }
+
+public:
+    inline const Type& type() const { return value_->type(); }
+    inline bool isNull() const { return value_->isNull(); }
+    inline bool isBoolean() const { return value_->isBoolean(); }
+    inline bool isInteger() const { return value_->isInteger(); }
+    inline bool isFloat() const { return value_->isFloat(); }
+    inline bool isNumber() const { return value_->isNumber(); }
+    inline bool isString() const { return value_->isString(); }
+    inline bool isArray() const { return value_->isArray(); }
+    inline bool isObject() const { return value_->isObject(); }
+
+    inline bool toBoolean(const bool& defaults = false) const { return value_->toBoolean(defaults); }
+    inline char toChar(const char& defaults = 0) const { return value_->toChar(defaults); }
+    inline short toShort(const short& defaults = 0) const { return value_->toShort(defaults); }
+    inline int toInt(const int& defaults = 0) const { return value_->toInt(defaults); }
+    inline long toLong(const long& defaults = 0) const { return value_->toLong(defaults); }
+    inline long long toLLong(const long long& defaults = 0) const { return value_->toLLong(defaults); }
+    inline unsigned char toUChar(const unsigned char& defaults = 0) const { return value_->toUChar(defaults); }
+    inline unsigned short toUShort(const unsigned short& defaults = 0) const { return value_->toUShort(defaults); }
+    inline unsigned int toUInt(const unsigned int& defaults = 0) const { return value_->toUInt(defaults); }
+    inline unsigned long toULong(const unsigned long& defaults = 0) const { return value_->toULong(defaults); }
+    inline unsigned long long toULLong(const unsigned long long& defaults = 0) const { return value_->toULLong(defaults); }
+    inline float toFloat(const float& defaults = 0.0f) const { return value_->toFloat(defaults); }
+    inline double toDouble(const double& defaults = 0.0) const { return value_->toDouble(defaults); }
+    inline String toString(const String& defaults = "") const { return value_->toString(defaults); }
+    template<typename T> inline T toEnum(const T& defaults = T(0)) const { return value_->toEnum(defaults); }
+
+    inline bool empty() const { return value_->empty(); }
+    inline size_t size() const { return value_->size(); }
+    inline bool contains(const String& key) const { return value_->contains(key); }
+    inline bool contains(const size_t& index) const { return value_->contains(index); }
+    inline bool contains(const Key& key) const { return value_->contains(key); }
+    template<typename T> inline bool contains(T* key) const { return value_->contains(Key(key)); }
+
+    inline String serialize(const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0) const { return value_->serialize(options, errorMessage); }
+    Value toValue() const;
+
+public:
+    /**
+     * Iterates array elements or object members.
+     */
+    class const_iterator {
+    public:
+        inline const_iterator(const Array* array, const size_t& index): array_(array), index_(index), object_() {}
+        inline const_iterator(const Object::const_iterator& object): array_(0), index_(0), object_(object) {}
+        inline ~const_iterator() {}
+
+    public:
+        inline const String& key() const { static const String empty; return array_ ? empty : object_->first; }
+        inline FrozenView value() const { return FrozenView(array_ ? (*array_)[index_] : object_->second); }
+        inline const_iterator& operator ++() { if (array_) { ++index_; } else { ++object_; } return *this; }
+        inline bool operator ==(const const_iterator& rhs) const { return array_ ? index_ == rhs.index_ : object_ == rhs.object_; }
+        inline bool operator !=(const const_iterator& rhs) const { return !(*this == rhs); }
+
+    private:
+        const Array* array_;
+        size_t index_;
+        Object::const_iterator object_;
+    }; // FrozenView::const_iterator class
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    static Value deep_copy(const Value& value);
+    static const Value& s_null();
+
+private:
+    const Value* value_;
+}; // FrozenView class
+
+/**
+ * Immutable value which can be shared across threads.
+ * Freezing makes one deep copy that is owned by all copies of the FrozenValue through an
+ * atomic reference count. The tree is read through FrozenView, so worker threads never
+ * touch the non-atomic reference counts of its containers.
+ */
+class FrozenValue {
+public:
+    FrozenValue();
+    explicit FrozenValue(const Value& value);
+    FrozenValue(const FrozenValue& v);
+    ~FrozenValue();
+
+public:
+    FrozenValue& operator =(const FrozenValue& rhs);
+
+    inline FrozenView view() const { return holder_ ? FrozenView(holder_->value) : FrozenView(); }
+    inline FrozenView operator [](const String& key) const { return this->view()[key]; }
+    inline FrozenView operator [](const size_t& index) const { return this->view()[index]; }
+    inline FrozenView operator [](const Key& key) const { return this->view()[key]; }
+    template<typename T> inline FrozenView operator [](T* key) const { return this->view()[Key(key)]; }
+    inline FrozenView operator *() const { return this->view(); }
+
+private:
+    void release();
+
+private:
+    struct Holder {
+        inline Holder(): count(1), value() {}
+        AtomicCounter count;
+        Value value;
+    }; // Holder struct
+
+    Holder* holder_;
+}; // FrozenValue class
+
 /**
  * Abstract parse handler class.
  * Define and use a custom handler class when parsing Json with SAX.
  * All virtual functions return true when continue parsing.
+ * Parser takes a pointer to any handler type with these member functions and calls them without
+ * virtual dispatch, so a handler pointer of this type is an adapter for runtime polymorphism.
  */
 class AbstractParseHandler {
 public:
@@ -247,15 +618,170 @@ public:
     virtual bool beginObject() = 0;
     virtual bool onObjectKey(const String& key) = 0;
     virtual bool endObject(const size_t& count) = 0;
+    // Unsigned integers, which the parser reports only above INT64_MAX. Unless overridden, they go to
+    // onInteger when they fit, and to onFloat otherwise.
+    inline virtual bool onUInteger(const uint64_t& v) {
+        return v <= static_cast<uint64_t>(LLONG_MAX) ? this->onInteger(static_cast<int64_t>(v)) : this->onFloat(static_cast<double>(v));
+    }
 
 }; // AbstractParseHandler class
 
+/**
+ * Base of statically dispatched handlers, which accepts every event the derived class does not define.
+ * class Counter: public pocketjson::BaseParseHandler<Counter> { public: bool onInteger(int64_t) { ... } };
+ */
+template<typename Derived>
+class BaseParseHandler {
+public:
+    inline bool onNull() { return true; }
+    inline bool onBoolean(const bool&) { return true; }
+    inline bool onInteger(const int64_t&) { return true; }
+    inline bool onFloat(const double&) { return true; }
+    inline bool onString(const String&) { return true; }
+    inline bool beginArray() { return true; }
+    inline bool endArray(const size_t&) { return true; }
+    inline bool beginObject() { return true; }
+    inline bool onObjectKey(const String&) { return true; }
+    inline bool endObject(const size_t&) { return true; }
+    inline bool onUInteger(const uint64_t& v) {
+        return v <= static_cast<uint64_t>(LLONG_MAX) ? static_cast<Derived*>(this)->onInteger(static_cast<int64_t>(v)) : static_cast<Derived*>(this)->onFloat(static_cast<double>(v));
+    }
+
+}; // BaseParseHandler class
+
+/**
+ * Error of the last parse call.
+ * offset is the byte offset from the beginning of input, line and column start at 1.
+ * Recording an error does not allocate, message() returns a static string.
+ */
+struct ParseError {
+    inline ParseError(): code(kErrorNone), offset(0), line(0), column(0) {}
+
+    inline void clear() { code = kErrorNone; offset = 0; line = 0; column = 0; }
+    inline const char* message() const { return ParseError::message(code); }
+    String toString() const;
+    static const char* message(const ErrorCode& code);
+
+    ErrorCode code;
+    size_t offset;
+    size_t line;
+    size_t column;
+}; // ParseError struct
+
+/**
+ * Statistics of the last parse or serialize call.
+ * Recorded only when POCKETJSON_ENABLE_STATS is defined, otherwise all counters stay zero.
+ * allocations counts containers created by Parser for the parsed tree.
+ * slowFloats counts floats converted through strtod rather than exactly from the significand.
+ */
+struct Stats {
+    inline Stats() { this->clear(); }
+
+    inline void clear() {
+        bytes = 0;
+        maxDepth = 0;
+        escapes = 0;
+        slowFloats = 0;
+        allocations = 0;
+        nanoseconds = 0;
+        for (size_t i = 0; i < 7; ++i) { nodes_[i] = 0; }
+    }
+    inline uint64_t nodes(const Type& type) const { return nodes_[Stats::index(type)]; }
+    inline uint64_t nodes() const {
+        uint64_t n = 0;
+        for (size_t i = 0; i < 7; ++i) { n += nodes_[i]; }
+        return n;
+    }
+    inline void addNode(const Type& type) { ++nodes_[Stats::index(type)]; }
+    inline void enter(uint32_t& depth) { if (++depth > maxDepth) { maxDepth = depth; } }
+
+    uint64_t bytes;
+    uint32_t maxDepth;
+    uint64_t escapes;
+    uint64_t slowFloats;
+    uint64_t allocations;
+    uint64_t nanoseconds;
+
+private:
+    static inline size_t index(const Type& type) {
+        switch (type) {
+        case kBoolean: return 1;
+        case kInteger: return 2;
+        case kFloat: return 3;
+        case kString: return 4;
+        case kArray: return 5;
+        case kObject: return 6;
+        default: return 0;
+        }
+    }
+
+    uint64_t nodes_[7];
+}; // Stats struct
+
+/**
+ * Callback receiving Stats after each parse or serialize call.
+ */
+typedef void (*StatsCallback)(const Stats& stats, void* context);
+
+#ifdef POCKETJSON_ENABLE_STATS
+inline uint64_t statsClock() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+/**
+ * String pool class.
+ * Interns object keys and short string values so repeated strings share one container,
+ * and keeps their escaped json encoding for Serializer.
+ * A Parser with the pool attached interns the keys and short string values it reads, up to maxEntries.
+ * A Serializer with the pool attached only looks strings up, so writing never grows the pool.
+ */
+class StringPool {
+public:
+    inline StringPool(const size_t& maxLength = 64, const size_t& maxEntries = 65536): maxLength_(maxLength), maxEntries_(maxEntries) {}
+    inline ~StringPool() {}
+
+public:
+    Value intern(const String& str);
+    // Escaped encoding of an interned string, or 0 when str is not interned.
+    const String* escaped(const String& str);
+    bool contains(const String& str) const;
+
+    inline size_t size() const { return entries_.size(); }
+    inline const size_t& maxLength() const { return maxLength_; }
+    void clear();
+
+    static uint32_t hash(const char* str, const size_t& length);
+
+private:
+    struct Entry {
+        uint32_t hash;
+        Value value;
+        String escaped; // made on the first lookup, empty until then
+    }; // Entry struct
+
+    const Entry* find(const String& str, const uint32_t& hash) const;
+    Entry* find(const String& str, const uint32_t& hash);
+    const Entry* insert(const String& str, const uint32_t& hash);
+    void rehash(const size_t& slotCount);
+
+private:
+    size_t maxLength_;
+    size_t maxEntries_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> slots_;
+}; // StringPool class
+
 template<typename Iter> inline Value parse(const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
 inline Value parse(const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
 template<typename Iter> inline bool parse(Value& value, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
 inline bool parse(Value& value, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
-template<typename Iter> inline bool parse(AbstractParseHandler* handler, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
-inline bool parse(AbstractParseHandler* handler, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+template<typename Handler, typename Iter> inline bool parse(Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+template<typename Handler> inline bool parse(Handler* handler, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+template<int Options, typename Iter> inline bool parse(Value& value, const Iter& begin, const Iter& end, String* errorMessage = 0);
+template<int Options> inline bool parse(Value& value, const String& str, String* errorMessage = 0);
+template<typename Iter> inline bool validate(const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+inline bool validate(const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
 
 
 /*-----------------------------------------------------------
@@ -266,71 +792,245 @@ inline bool parse(AbstractParseHandler* handler, const String& str, const ParseO
  */
 class Parser {
 public:
-    inline Parser() {}
+    inline Parser(): stringPool_(0), statsCallback_(0), statsContext_(0), depth_(0), offset_(0), rawNumber_(false) {}
     inline ~Parser() {}
 
 public:
+    inline void setStringPool(StringPool* pool) { stringPool_ = pool; }
+    inline StringPool* stringPool() const { return stringPool_; }
+    inline const Stats& stats() const { return stats_; }
+    inline void setStatsCallback(StatsCallback callback, void* context = 0) { statsCallback_ = callback; statsContext_ = context; }
+    inline const ParseError& error() const { return error_; }
+
     template<typename Iter> bool parse(Value& value, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
-    template<typename Iter> bool parse(AbstractParseHandler* handler, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    template<typename Handler, typename Iter> bool parse(Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    bool parse(Value& value, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    template<typename Handler> bool parse(Handler* handler, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+    // Read one value from the stream, leaving the following bytes in it. Gabage is always allowed.
+    bool parse(Value& value, std::istream& is, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    template<typename Handler> bool parse(Handler* handler, std::istream& is, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+    // Options fixed at compile time: parser.parse<kParseOptionAllowCommaEnding>(value, str)
+    template<int Options, typename Iter> bool parse(Value& value, const Iter& begin, const Iter& end, String* errorMessage = 0);
+    template<int Options, typename Handler, typename Iter> bool parse(Handler* handler, const Iter& begin, const Iter& end, String* errorMessage = 0);
+    template<int Options> bool parse(Value& value, const String& str, String* errorMessage = 0);
+    template<int Options, typename Handler> bool parse(Handler* handler, const String& str, String* errorMessage = 0);
+
+    // Check grammar only: strings and numbers are not decoded and nothing is built.
+    template<typename Iter> bool validate(const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    bool validate(const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
 
 private:
-    template<typename Iter> bool parse(Value* value, AbstractParseHandler* handler, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    friend class Decoder;
+    friend class Reformatter;
+    friend class ParallelParser;
+
+    enum Target {
+        kTargetNone,
+        kTargetValue,
+        kTargetHandler
+    }; // Target enum
+
+    template<typename Handler, typename Iter> bool parse(Value* value, Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage);
+    template<int Target, typename Handler, typename Iter> bool parse(Value* value, Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage);
+    template<int Options, int Target, typename Handler, typename Iter> bool parse(Value* value, Handler* handler, const Iter& begin, const Iter& end, String* errorMessage);
 
     template<typename Iter> bool parse_value(Value* value, AbstractParseHandler* handler, Iter& itr, const ParseOption& options);
-    template<typename Iter> bool parse_number(Value* value, AbstractParseHandler* handler, Iter& itr);
-    template<typename Iter> bool parse_string(Value* value, AbstractParseHandler* handler, Iter& itr);
+    template<int Options, typename Iter> bool parse_nested(Value* value, AbstractParseHandler* handler, Iter& itr);
+    template<int Options, int Target, typename Handler, typename Iter> bool parse_value(Value* value, Handler* handler, Iter& itr);
+    template<int Target, typename Handler, typename Iter> bool parse_number(Value* value, Handler* handler, Iter& itr);
+    template<int Options, int Target, typename Handler, typename Iter> bool parse_string(Value* value, Handler* handler, Iter& itr);
     template<typename Iter> bool parse_hex(uint16_t& hex, Iter& itr);
     template<typename Iter> bool parse_unicode(String& str, Iter& itr);
-    template<typename Iter> bool parse_string(String& str, Iter& itr);
-    template<typename Iter> bool parse_array(Value* value, AbstractParseHandler* handler, Iter& itr, const ParseOption& options);
-    template<typename Iter> bool parse_object(Value* value, AbstractParseHandler* handler, Iter& itr, const ParseOption& options);
+    template<bool Utf8, typename Iter> bool parse_string(String& str, Iter& itr);
+    template<bool Utf8, typename Iter> bool skip_string(Iter& itr);
+    template<bool Utf8, typename Iter> void scan_string(Iter& itr, String* str);
+    template<typename Iter> bool parse_utf8(String* str, Iter& itr);
+    template<int Options, int Target, typename Handler, typename Iter> bool parse_array(Value* value, Handler* handler, Iter& itr);
+    template<int Options, int Target, typename Handler, typename Iter> bool parse_object(Value* value, Handler* handler, Iter& itr);
     template<typename CharType> bool is_white_space(const CharType& c);
     template<typename Iter> void skip_white_space(Iter& itr);
     template<typename Iter> void skip_utf8_bom(Iter& itr);
 
-    bool fail(const String& error);
+    bool begin_container(Value* value, const Type& type, const ParseOption& options);
+    void erase_untouched(Object& object);
+    template<typename Iter> bool fail(const ErrorCode& code, const Iter& itr);
+    template<typename Handler> bool parse_stream(Value* value, Handler* handler, std::istream& is, const ParseOption& options, String* errorMessage);
 
 private:
-    String lastError_;
-
+    ParseError error_;
+    StringPool* stringPool_;
+    Stats stats_;
+    StatsCallback statsCallback_;
+    void* statsContext_;
+    uint32_t depth_;
+    // Bytes read by the last parse call.
+    size_t offset_;
+    // kParseOptionRawNumber is read at runtime, so it does not multiply the instantiations.
+    bool rawNumber_;
+
+    // Scratch buffers retained between parse calls.
+    String string_;
+    String number_;
+    String key_;
+    String stream_;
+
+    /**
+     * Access to the get area of std::streambuf, so buffered bytes are parsed in place.
+     */
+    class StreamBuffer: public std::streambuf {
+    public:
+        static inline const char* next(std::streambuf* buf) { return (buf->*&StreamBuffer::gptr)(); }
+        static inline const char* last(std::streambuf* buf) { return (buf->*&StreamBuffer::egptr)(); }
+        static inline void consume(std::streambuf* buf, const size_t& n) { (buf->*&StreamBuffer::gbump)(static_cast<int>(n)); }
+    }; // StreamBuffer class
+
+    /**
+     * Finder of the end of a value read in blocks, without parsing it.
+     * Brackets are counted outside strings, so the value is complete when they balance.
+     */
+    class StreamScanner {
+    public:
+        inline StreamScanner(): state_(kBefore), depth_(0), escaped_(false) {}
+        // Returns the end of the value in [p, last), or last when the value continues.
+        const char* scan(const char* p, const char* last);
+        inline bool done() const { return state_ == kDone; }
+    private:
+        enum State { kBefore, kScalar, kString, kContainer, kDone };
+        State state_;
+        size_t depth_;
+        bool escaped_;
+    }; // StreamScanner class
+
+    /**
+     * Input iterator tracking the position for ParseError.
+     * Lines are counted where line breaks are allowed, in white space and inside strings.
+     */
     template<typename Iter> class Iterator {
     private:
         Iter itr_;
         Iter end_;
+        size_t offset_;
+        size_t line_;
+        size_t lineBegin_;
     public:
-        inline Iterator(const Iter& itr, const Iter& end): itr_(itr), end_(end) {}
+        inline Iterator(const Iter& itr, const Iter& end): itr_(itr), end_(end), offset_(0), line_(1), lineBegin_(0) {}
         inline ~Iterator() {}
     public:
-        inline Iterator& operator ++() { ++itr_; return *this; }
+        inline size_t offset() const { return offset_; }
+        inline size_t line() const { return line_; }
+        inline size_t column() const { return offset_ - lineBegin_ + 1; }
+        inline void newline() { ++line_; lineBegin_ = offset_ + 1; }
+        inline Iterator& operator ++() { if (itr_ != end_) { ++itr_; ++offset_; } return *this; }
         inline operator bool() const { return itr_ != end_; }
-        inline typename Iter::value_type operator *() const { return itr_ == end_ ? 0 : *itr_; }
+        inline typename std::iterator_traits<Iter>::value_type operator *() const { return itr_ == end_ ? 0 : *itr_; }
+        inline const Iter& position() const { return itr_; }
+        inline const Iter& last() const { return end_; }
+        inline void skip(const size_t& n) { itr_ += n; offset_ += n; }
     }; // Iterator class
 
+#ifdef _POCKETJSON_SSE2
+    template<bool Utf8> void scan_string(Iterator<const char*>& itr, String* str);
+#endif
+
 }; // Parser class
 
+/**
+ * Output iterator appending to a string.
+ * Serializer copies whole runs of characters at once through this iterator.
+ */
+class StringAppender {
+public:
+    typedef std::output_iterator_tag iterator_category;
+    typedef void value_type;
+    typedef void difference_type;
+    typedef void pointer;
+    typedef void reference;
+
+public:
+    inline explicit StringAppender(String& str): str_(&str) {}
+    inline ~StringAppender() {}
+
+public:
+    inline StringAppender& operator =(const char& c) { str_->push_back(c); return *this; }
+    inline StringAppender& operator *() { return *this; }
+    inline StringAppender& operator ++() { return *this; }
+    inline StringAppender& operator ++(int) { return *this; }
+    inline void append(const char* data, const size_t& size) { str_->append(data, size); }
+
+private:
+    String* str_;
+}; // StringAppender class
+
 class Serializer {
 public:
-    inline Serializer() {}
+    inline Serializer(): stringPool_(0), statsCallback_(0), statsContext_(0), depth_(0) {}
     inline ~Serializer() {}
 
 public:
+    inline void setStringPool(StringPool* pool) { stringPool_ = pool; }
+    inline StringPool* stringPool() const { return stringPool_; }
+    inline const Stats& stats() const { return stats_; }
+    inline void setStatsCallback(StatsCallback callback, void* context = 0) { statsCallback_ = callback; statsContext_ = context; }
+
     template<typename Iter> bool serialize(const Iter& itr, const Value& value, const SerializeOption& options = kSerializeOptionNone, String* errorMessage = 0);
+    // Options fixed at compile time: serializer.serialize<kSerializeOptionPretty>(itr, value)
+    template<int Options, typename Iter> bool serialize(const Iter& itr, const Value& value, String* errorMessage = 0);
 
 public:
     template<typename Iter> static void int64ToString(Iter itr, const int64_t& value);
     static String int64ToString(const int64_t& value);
+    template<typename Iter> static void uint64ToString(Iter itr, const uint64_t& value);
+    static String uint64ToString(const uint64_t& value);
 
 private:
+    friend class Encoder;
+    friend class Reformatter;
+
     struct Attributes {
         bool pretty;
-        String tab;
-        String lineBreak;
+        const char* tab;
+        size_t tabLength;
+        const char* lineBreak;
+        size_t lineBreakLength;
     }; // Attributes struct
 
-    template<typename Iter> bool serialize(Iter& itr, const Value& value, const Attributes& attr, const int& indentLevel, String* errorMessage = 0);
+    static Attributes attributes(const int& options);
+    template<bool Pretty, typename Iter> bool serialize(Iter& itr, const Value& value, const Attributes& attr, const int& indentLevel, String* errorMessage = 0);
     template<typename Iter> void serialize_string(Iter& itr, const String& value);
     template<typename Iter> void indent(Iter& itr, const Attributes& attr, const int& indent);
     template<typename Iter> void append(Iter& itr, const String& app);
+    template<typename Iter> void append(Iter& itr, const char* data, const size_t& size);
+    void append(StringAppender& itr, const char* data, const size_t& size);
+
+    /**
+     * Output iterator counting written bytes for Stats.
+     */
+    template<typename Iter> class CountingIterator {
+    public:
+        inline CountingIterator(Iter& itr, uint64_t& count): itr_(&itr), count_(&count) {}
+    public:
+        inline CountingIterator& operator =(const char& c) { *(*itr_)++ = c; ++*count_; return *this; }
+        inline CountingIterator& operator *() { return *this; }
+        inline CountingIterator& operator ++() { return *this; }
+        inline CountingIterator& operator ++(int) { return *this; }
+        inline Iter& base() { return *itr_; }
+        inline void count(const size_t& size) { *count_ += size; }
+    private:
+        Iter* itr_;
+        uint64_t* count_;
+    }; // CountingIterator class
+
+    template<typename Iter> void append(CountingIterator<Iter>& itr, const char* data, const size_t& size);
+    template<bool Pretty, typename Iter> bool serialize_root(Iter& itr, const Value& value, const Attributes& attr, String* errorMessage);
+
+private:
+    StringPool* stringPool_;
+    Stats stats_;
+    StatsCallback statsCallback_;
+    void* statsContext_;
+    uint32_t depth_;
 
 }; // Serializer class
 
@@ -373,6 +1073,39 @@ public:
         return result;
     }
 
+    /**
+     * Exact conversion of significand * 10^exponent when both are exactly representable as double.
+     */
+    static inline bool fastDecimalToDouble(const uint64_t& significand, const int& exponent, double* result) {
+        static const double kPow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        if (significand > (static_cast<uint64_t>(1) << 53) || exponent < -22 || exponent > 22) {
+            return false;
+        }
+        const double d = static_cast<double>(significand);
+        *result = exponent < 0 ? d / kPow10[-exponent] : d * kPow10[exponent];
+        return true;
+    }
+    static inline double decimalToDouble(const uint64_t& significand, const int& exponent) {
+        double result = 0.0;
+        if (fastDecimalToDouble(significand, exponent, &result)) {
+            return result;
+        }
+        // Written as "<significand>e<exponent>" without a decimal point, so the locale does not matter.
+        char buf[48];
+        char* p = buf + sizeof(buf);
+        *--p = '\0';
+        unsigned int e = static_cast<unsigned int>(exponent < 0 ? -exponent : exponent);
+        do { *--p = static_cast<char>('0' + e % 10); e /= 10; } while (e != 0);
+        if (exponent < 0) { *--p = '-'; }
+        *--p = 'e';
+        uint64_t n = significand;
+        do { *--p = static_cast<char>('0' + n % 10); n /= 10; } while (n != 0);
+        return strtod(p, 0);
+    }
+
     template<typename Iter>
     inline bool toString(Iter itr) const {
         if (isZero()) {
@@ -466,8 +1199,27 @@ private:
     };
 }; // CodePoint class
 
+/**
+ * AtomicCounter class implementation.
+ */
+#if defined(_MSC_VER)
+inline uint32_t AtomicCounter::load() const { return static_cast<uint32_t>(_InterlockedCompareExchange(const_cast<volatile long*>(&value_), 0, 0)); }
+inline void AtomicCounter::increment() { _InterlockedIncrement(&value_); }
+inline bool AtomicCounter::decrement() { return _InterlockedDecrement(&value_) == 0; }
+#elif defined(__GNUC__) || defined(__clang__)
+inline uint32_t AtomicCounter::load() const { return __atomic_load_n(&value_, __ATOMIC_ACQUIRE); }
+inline void AtomicCounter::increment() { __atomic_add_fetch(&value_, 1, __ATOMIC_RELAXED); }
+inline bool AtomicCounter::decrement() { return __atomic_sub_fetch(&value_, 1, __ATOMIC_ACQ_REL) == 0; }
+#else
+inline uint32_t AtomicCounter::load() const { return value_.load(std::memory_order_acquire); }
+inline void AtomicCounter::increment() { value_.fetch_add(1, std::memory_order_relaxed); }
+inline bool AtomicCounter::decrement() { return value_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+#endif
+
 /**
  * Value class implementation.
+ * Define POCKETJSON_ATOMIC_REFERENCE_COUNT to share containers between threads
+ * through atomic reference counts.
  */
 class Value::AbstractContainer {
 public:
@@ -475,14 +1227,24 @@ public:
     inline virtual ~AbstractContainer() {}
 
 public:
-    inline const uint32_t& count() const { return referenceCount_; }
+#ifdef POCKETJSON_ATOMIC_REFERENCE_COUNT
+    inline uint32_t count() const { return referenceCount_.load(); }
+    inline void increment() { referenceCount_.increment(); }
+    inline bool decrement() { return referenceCount_.decrement(); }
+#else
+    inline uint32_t count() const { return referenceCount_; }
     inline void increment() { ++referenceCount_; }
     inline bool decrement() { return --referenceCount_ == 0; }
+#endif
     template<typename T> inline const T& data() const;
     template<typename T> inline T& data();
 
 private:
+#ifdef POCKETJSON_ATOMIC_REFERENCE_COUNT
+    AtomicCounter referenceCount_;
+#else
     uint32_t referenceCount_;
+#endif
 }; // Value::AbstractContainer class
 
 template<typename T>
@@ -517,8 +1279,12 @@ inline Value::Value(const long long& v): type_(kInteger), integer_(static_cast<l
 inline Value::Value(const unsigned char& v): type_(kInteger), integer_(static_cast<long long>(v)) {}
 inline Value::Value(const unsigned short& v): type_(kInteger), integer_(static_cast<long long>(v)) {}
 inline Value::Value(const unsigned int& v): type_(kInteger), integer_(static_cast<long long>(v)) {}
-inline Value::Value(const unsigned long& v): type_(kInteger), integer_(static_cast<long long>(v)) {}
-inline Value::Value(const unsigned long long& v): type_(kInteger), integer_(static_cast<long long>(v)) {}
+inline Value::Value(const unsigned long& v): type_(kInteger), integer_(static_cast<long long>(v)) {
+    if (v > static_cast<unsigned long long>(LLONG_MAX)) { format_.flags = kNumberUnsigned; }
+}
+inline Value::Value(const unsigned long long& v): type_(kInteger), integer_(static_cast<long long>(v)) {
+    if (v > static_cast<unsigned long long>(LLONG_MAX)) { format_.flags = kNumberUnsigned; }
+}
 inline Value::Value(const float& v): type_(kFloat), float_(v) {}
 inline Value::Value(const double& v): type_(kFloat), float_(v) {}
 inline Value::Value(const char* v): type_(kString), container_(new Container<String>(v)) {}
@@ -533,7 +1299,7 @@ inline Value::Value(const Type& type): type_(type), integer_(0) {
     default: break;
     };
 }
-inline Value::Value(const Value& v): type_(v.type_), integer_(v.integer_) {
+inline Value::Value(const Value& v): type_(v.type_), format_(v.format_), integer_(v.integer_) {
     if (type_ & kContainer) { container_->increment(); }
 }
 inline Value::~Value() { this->release(); }
@@ -559,6 +1325,7 @@ inline Value& Value::operator =(const Value& rhs) {
     if (this != &rhs) {
         this->release();
         type_ = rhs.type_;
+        format_ = rhs.format_;
         integer_ = rhs.integer_;
         if (type_ & kContainer) { container_->increment(); }
     }
@@ -567,11 +1334,12 @@ inline Value& Value::operator =(const Value& rhs) {
 
 inline bool Value::operator ==(const Value& rhs) const {
     if (type_ != rhs.type_) { return false; }
+    if (this->shares(rhs)) { return true; }
     switch (type_) {
     case kNull: return true;
     case kBoolean: return boolean_ == rhs.boolean_;
-    case kInteger: return integer_ == rhs.integer_;
-    case kFloat: return float_ == rhs.float_;
+    case kInteger: return integer_ == rhs.integer_ && (format_.flags & kNumberUnsigned) == (rhs.format_.flags & kNumberUnsigned);
+    case kFloat: return ((format_.flags | rhs.format_.flags) & kNumberRaw) ? this->float_value() == rhs.float_value() : float_ == rhs.float_;
     case kString: return container_->data<String>() == rhs.container_->data<String>();
     case kArray: return container_->data<Array>() == rhs.container_->data<Array>();
     case kObject: return container_->data<Object>() == rhs.container_->data<Object>();
@@ -584,10 +1352,11 @@ inline bool Value::operator !=(const Value& rhs) const {
 }
 
 #ifdef _POCKETJSON_HAS_RVALUE_REFERENCES
-inline Value::Value(Value&& v): type_(v.type_), integer_(v.integer_) { v.integer_ = 0; }
+inline Value::Value(Value&& v): type_(v.type_), format_(v.format_), integer_(v.integer_) { v.integer_ = 0; }
 inline Value& Value::operator =(Value&& rhs) {
     if (this != &rhs) {
         std::swap(type_, rhs.type_);
+        std::swap(format_, rhs.format_);
         std::swap(integer_, rhs.integer_);
     }
     return *this;
@@ -596,10 +1365,7 @@ inline Value& Value::operator =(Value&& rhs) {
 
 inline Value& Value::operator [](const String& key) {
     this->setType(kObject);
-    if (container_->count() > 1) {
-        this->release();
-        container_ = new Container<Object>(container_->data<Object>());
-    }
+    this->detach();
     return container_->data<Object>()[key];
 }
 inline const Value& Value::operator [](const String& key) const {
@@ -611,12 +1377,46 @@ inline const Value& Value::operator [](const String& key) const {
         return Value::s_null();
     }
 }
+inline Value& Value::operator [](const Key& key) {
+    this->setType(kObject);
+    this->detach();
+    Object& object = container_->data<Object>();
+#ifdef _POCKETJSON_HAS_TRANSPARENT_LOOKUP
+    Object::iterator itr = object.lower_bound(key);
+    if (itr == object.end() || key.compare(itr->first) != 0) {
+        itr = object.insert(itr, Object::value_type(key.toString(), Value()));
+    }
+    return itr->second;
+#else
+    return object[key.toString()];
+#endif
+}
+inline const Value& Value::operator [](const Key& key) const {
+    if (this->isObject()) {
+        const Object& object = container_->data<Object>();
+        const Object::const_iterator itr = Value::find_key(object, key);
+        return itr != object.end() ? itr->second : Value::s_null();
+    } else {
+        return Value::s_null();
+    }
+}
+template<typename T> inline Value& Value::operator [](T* key) {
+    return (*this)[Key(key)];
+}
+template<typename T> inline const Value& Value::operator [](T* key) const {
+    return (*this)[Key(key)];
+}
+#ifdef _POCKETJSON_HAS_STRING_VIEW
+inline Value& Value::operator [](const std::string_view& key) {
+    return (*this)[Key(key.data(), key.size())];
+}
+inline const Value& Value::operator [](const std::string_view& key) const {
+    return (*this)[Key(key.data(), key.size())];
+}
+#endif
 inline Value& Value::operator [](const size_t& index) {
     this->setType(kArray);
-    if (container_->count() > 1) {
-        this->release();
-        container_ = new Container<Array>(container_->data<Array>());
-    }
+    this->detach();
     Array& array = container_->data<Array>();
     if (index >= array.size()) {
         array.resize(index + 1);
@@ -635,37 +1435,48 @@ inline const Value& Value::operator [](const size_t& index) const {
 inline void Value::push_back(const Value& v) {
     if (this != &v) {
         this->setType(kArray);
+        this->detach();
         container_->data<Array>().push_back(v);
     }
 }
 inline void Value::pop_back() {
-    if (this->isArray()) {
+    if (this->isArray() && !container_->data<Array>().empty()) {
+        this->detach();
         container_->data<Array>().pop_back();
     }
 }
 inline void Value::insert(const String& key, const Value& v) {
     if (this != &v) {
         this->setType(kObject);
+        this->detach();
         container_->data<Object>().insert(std::make_pair(key, v));
     }
 }
 inline void Value::erase(const String& key) {
     if (this->isObject()) {
+        this->detach();
         container_->data<Object>().erase(key);
     }
 }
 inline void Value::clear() {
+    if ((type_ & kContainer) && container_->count() > 1) {
+        const Type type = type_;
+        this->setNull();
+        this->setType(type);
+        return;
+    }
     switch (type_) {
     case kString: container_->data<String>().clear(); break;
     case kObject: container_->data<Object>().clear(); break;
     case kArray: container_->data<Array>().clear(); break;
-    default: integer_ = 0; break;
+    default: integer_ = 0; format_ = NumberFormat(); break;
     }
 }
 inline void Value::setType(const Type& type) {
     if (type_ != type) {
         this->release();
         type_ = type;
+        format_ = NumberFormat();
         switch (type) {
         case kString: container_ = new Container<String>(); break;
         case kObject: container_ = new Container<Object>(); break;
@@ -678,11 +1489,12 @@ inline void Value::setNull() {
     if (type_ != kNull) {
         this->release();
         type_ = kNull;
+        format_ = NumberFormat();
         integer_ = 0;
     }
 }
-#define _POCKETJSON_SET_PRIMITIVE_IMPL(type, target) this->release(); type_ = type; target = v
-#define _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(T, type, target) this->release(); type_ = type; target = static_cast<T>(v)
+#define _POCKETJSON_SET_PRIMITIVE_IMPL(type, target) this->release(); type_ = type; format_ = NumberFormat(); target = v
+#define _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(T, type, target) this->release(); type_ = type; format_ = NumberFormat(); target = static_cast<T>(v)
 inline void Value::setBoolean(const bool& v) { _POCKETJSON_SET_PRIMITIVE_IMPL(kBoolean, boolean_); }
 inline void Value::setInteger(const char& v) { _POCKETJSON_SET_PRIMITIVE_IMPL(kInteger, integer_); }
 inline void Value::setInteger(const short& v) { _POCKETJSON_SET_PRIMITIVE_IMPL(kInteger, integer_); }
@@ -692,8 +1504,14 @@ inline void Value::setInteger(const long long& v) { _POCKETJSON_SET_PRIMITIVE_IM
 inline void Value::setInteger(const unsigned char& v) { _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_); }
 inline void Value::setInteger(const unsigned short& v) { _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_); }
 inline void Value::setInteger(const unsigned int& v) { _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_); }
-inline void Value::setInteger(const unsigned long& v) { _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_); }
-inline void Value::setInteger(const unsigned long long& v) { _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_); }
+inline void Value::setInteger(const unsigned long& v) {
+    _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_);
+    if (v > static_cast<unsigned long long>(LLONG_MAX)) { format_.flags = kNumberUnsigned; }
+}
+inline void Value::setInteger(const unsigned long long& v) {
+    _POCKETJSON_SET_CAST_PRIMITIVE_IMPL(long long, kInteger, integer_);
+    if (v > static_cast<unsigned long long>(LLONG_MAX)) { format_.flags = kNumberUnsigned; }
+}
 inline void Value::setFloat(const float& v) { _POCKETJSON_SET_PRIMITIVE_IMPL(kFloat, float_); }
 inline void Value::setFloat(const double& v) { _POCKETJSON_SET_PRIMITIVE_IMPL(kFloat, float_); }
 #undef _POCKETJSON_SET_CAST_PRIMITIVE_IMPL
@@ -709,10 +1527,17 @@ template<typename Iter> inline bool Value::serialize(const Iter& itr, const Seri
     Serializer s; return s.serialize(itr, *this, options, errorMessage);
 }
 inline bool Value::serialize(String& str, const SerializeOption& options, String* errorMessage) const {
-    return this->serialize(std::back_inserter(str), options, errorMessage);
+    return this->serialize(StringAppender(str), options, errorMessage);
 }
 inline String Value::serialize(const SerializeOption& options, String* errorMessage) const {
-    String s; this->serialize(std::back_inserter(s), options, errorMessage); return s;
+    String s; this->serialize(StringAppender(s), options, errorMessage); return s;
+}
+template<int Options> inline bool Value::serialize(String& str, String* errorMessage) const {
+    Serializer serializer;
+    return serializer.serialize<Options>(StringAppender(str), *this, errorMessage);
+}
+template<int Options> inline String Value::serialize(String* errorMessage) const {
+    String s; this->serialize<Options>(s, errorMessage); return s;
 }
 
 inline const Type& Value::type() const { return type_; }
@@ -729,7 +1554,7 @@ inline bool Value::toBoolean(const bool& defaults) const {
     switch (type_) {
     case kBoolean: return boolean_;
     case kInteger: return integer_ != 0;
-    case kFloat: return float_ != 0.0;
+    case kFloat: return (format_.flags & kNumberRaw) ? integer_ != 0 : float_ != 0.0;
     case kString: return container_->data<String>() == "true";
     default: break;
     }
@@ -759,8 +1584,8 @@ template<typename T> inline T llstr_to_value(const String& str, const T& minValu
 
 inline char Value::toChar(const char& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, CHAR_MIN, CHAR_MAX) ? static_cast<char>(integer_) : defaults;
-    case kFloat: return double_to_value<char>(float_, static_cast<double>(CHAR_MIN), static_cast<double>(CHAR_MAX), defaults);
+    case kInteger: return this->in_range(CHAR_MIN, CHAR_MAX) ? static_cast<char>(integer_) : defaults;
+    case kFloat: return double_to_value<char>(this->float_value(), static_cast<double>(CHAR_MIN), static_cast<double>(CHAR_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<char>(container_->data<String>(), CHAR_MIN, CHAR_MAX, defaults);
     default: break;
@@ -769,8 +1594,8 @@ inline char Value::toChar(const char& defaults) const {
 }
 inline short Value::toShort(const short& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, SHRT_MIN, SHRT_MAX) ? static_cast<short>(integer_) : defaults;
-    case kFloat: return double_to_value<short>(float_, static_cast<double>(SHRT_MIN), static_cast<double>(SHRT_MAX), defaults);
+    case kInteger: return this->in_range(SHRT_MIN, SHRT_MAX) ? static_cast<short>(integer_) : defaults;
+    case kFloat: return double_to_value<short>(this->float_value(), static_cast<double>(SHRT_MIN), static_cast<double>(SHRT_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<short>(container_->data<String>(), SHRT_MIN, SHRT_MAX, defaults);
     default: break;
@@ -779,8 +1604,8 @@ inline short Value::toShort(const short& defaults) const {
 }
 inline int Value::toInt(const int& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, INT_MIN, INT_MAX) ? static_cast<int>(integer_) : defaults;
-    case kFloat: return double_to_value<int>(float_, static_cast<double>(INT_MIN), static_cast<double>(INT_MAX), defaults);
+    case kInteger: return this->in_range(INT_MIN, INT_MAX) ? static_cast<int>(integer_) : defaults;
+    case kFloat: return double_to_value<int>(this->float_value(), static_cast<double>(INT_MIN), static_cast<double>(INT_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<int>(container_->data<String>(), INT_MIN, INT_MAX, defaults);
     default: break;
@@ -789,8 +1614,8 @@ inline int Value::toInt(const int& defaults) const {
 }
 inline long Value::toLong(const long& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, LONG_MIN, LONG_MAX) ? static_cast<long>(integer_) : defaults;
-    case kFloat: return double_to_value<long>(float_, static_cast<double>(LONG_MIN), static_cast<double>(LONG_MAX), defaults);
+    case kInteger: return this->in_range(LONG_MIN, LONG_MAX) ? static_cast<long>(integer_) : defaults;
+    case kFloat: return double_to_value<long>(this->float_value(), static_cast<double>(LONG_MIN), static_cast<double>(LONG_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<long>(container_->data<String>(), LONG_MIN, LONG_MAX, defaults);
     default: break;
@@ -799,8 +1624,8 @@ inline long Value::toLong(const long& defaults) const {
 }
 inline long long Value::toLLong(const long long& defaults) const {
     switch (type_) {
-    case kInteger: return static_cast<long long>(integer_);
-    case kFloat: return double_to_value<long long>(float_, static_cast<double>(LLONG_MIN), static_cast<double>(LLONG_MAX), defaults);
+    case kInteger: return (format_.flags & kNumberUnsigned) ? defaults : static_cast<long long>(integer_);
+    case kFloat: return double_to_value<long long>(this->float_value(), static_cast<double>(LLONG_MIN), static_cast<double>(LLONG_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<long long>(container_->data<String>(), LLONG_MIN, LLONG_MAX, defaults);
     default: break;
@@ -809,8 +1634,8 @@ inline long long Value::toLLong(const long long& defaults) const {
 }
 inline unsigned char Value::toUChar(const unsigned char& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, 0, UCHAR_MAX) ? static_cast<unsigned char>(integer_) : defaults;
-    case kFloat: return double_to_value<unsigned char>(float_, 0, static_cast<double>(UCHAR_MAX), defaults);
+    case kInteger: return this->in_range(0, UCHAR_MAX) ? static_cast<unsigned char>(integer_) : defaults;
+    case kFloat: return double_to_value<unsigned char>(this->float_value(), 0, static_cast<double>(UCHAR_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<unsigned char>(container_->data<String>(), 0, UCHAR_MAX, defaults);
     default: break;
@@ -819,8 +1644,8 @@ inline unsigned char Value::toUChar(const unsigned char& defaults) const {
 }
 inline unsigned short Value::toUShort(const unsigned short& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, 0, USHRT_MAX) ? static_cast<unsigned short>(integer_) : defaults;
-    case kFloat: return double_to_value<unsigned short>(float_, 0, static_cast<double>(USHRT_MAX), defaults);
+    case kInteger: return this->in_range(0, USHRT_MAX) ? static_cast<unsigned short>(integer_) : defaults;
+    case kFloat: return double_to_value<unsigned short>(this->float_value(), 0, static_cast<double>(USHRT_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<unsigned short>(container_->data<String>(), 0, USHRT_MAX, defaults);
     default: break;
@@ -829,8 +1654,8 @@ inline unsigned short Value::toUShort(const unsigned short& defaults) const {
 }
 inline unsigned int Value::toUInt(const unsigned int& defaults) const {
     switch (type_) {
-    case kInteger: return is_range(integer_, 0, UINT_MAX) ? static_cast<unsigned int>(integer_) : defaults;
-    case kFloat: return double_to_value<unsigned int>(float_, 0, static_cast<double>(UINT_MAX), defaults);
+    case kInteger: return this->in_range(0, UINT_MAX) ? static_cast<unsigned int>(integer_) : defaults;
+    case kFloat: return double_to_value<unsigned int>(this->float_value(), 0, static_cast<double>(UINT_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<unsigned int>(container_->data<String>(), 0, UINT_MAX, defaults);
     default: break;
@@ -839,8 +1664,8 @@ inline unsigned int Value::toUInt(const unsigned int& defaults) const {
 }
 inline unsigned long Value::toULong(const unsigned long& defaults) const {
     switch (type_) {
-    case kInteger: return integer_ > 0 ? static_cast<unsigned long>(integer_) : defaults;
-    case kFloat: return double_to_value<unsigned long>(float_, 0, static_cast<double>((ULONG_MAX == ULLONG_MAX) ? LLONG_MAX : ULONG_MAX), defaults);
+    case kInteger: return (integer_ > 0 && static_cast<unsigned long long>(integer_) <= ULONG_MAX) || ((format_.flags & kNumberUnsigned) && ULONG_MAX == ULLONG_MAX) ? static_cast<unsigned long>(integer_) : defaults;
+    case kFloat: return double_to_value<unsigned long>(this->float_value(), 0, static_cast<double>((ULONG_MAX == ULLONG_MAX) ? LLONG_MAX : ULONG_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<unsigned long>(container_->data<String>(), 0, (ULONG_MAX == ULLONG_MAX) ? LLONG_MAX : ULONG_MAX, defaults);
     default: break;
@@ -849,8 +1674,8 @@ inline unsigned long Value::toULong(const unsigned long& defaults) const {
 }
 inline unsigned long long Value::toULLong(const unsigned long long& defaults) const {
     switch (type_) {
-    case kInteger: return integer_ > 0 ? static_cast<unsigned long long>(integer_) : defaults;
-    case kFloat: return double_to_value<unsigned long long>(float_, 0, static_cast<double>(LLONG_MAX), defaults);
+    case kInteger: return integer_ > 0 || (format_.flags & kNumberUnsigned) ? static_cast<unsigned long long>(integer_) : defaults;
+    case kFloat: return double_to_value<unsigned long long>(this->float_value(), 0, static_cast<double>(LLONG_MAX), defaults);
     case kBoolean: return boolean_ ? 1 : 0;
     case kString: return llstr_to_value<unsigned long long>(container_->data<String>(), 0, LLONG_MAX, defaults);
     default: break;
@@ -860,8 +1685,8 @@ inline unsigned long long Value::toULLong(const unsigned long long& defaults) co
 
 inline float Value::toFloat(const float& defaults) const {
     switch (type_) {
-    case kFloat: return static_cast<float>(float_);
-    case kInteger: return static_cast<float>(integer_);
+    case kFloat: return static_cast<float>(this->float_value());
+    case kInteger: return (format_.flags & kNumberUnsigned) ? static_cast<float>(static_cast<uint64_t>(integer_)) : static_cast<float>(integer_);
     case kBoolean: return boolean_ ? 1.0f : 0.0f;
     case kString: {
         const String& str = container_->data<String>();
@@ -875,8 +1700,8 @@ inline float Value::toFloat(const float& defaults) const {
 }
 inline double Value::toDouble(const double& defaults) const {
     switch (type_) {
-    case kFloat: return float_;
-    case kInteger: return static_cast<double>(integer_);
+    case kFloat: return this->float_value();
+    case kInteger: return (format_.flags & kNumberUnsigned) ? static_cast<double>(static_cast<uint64_t>(integer_)) : static_cast<double>(integer_);
     case kBoolean: return boolean_ ? 1.0 : 0.0;
     case kString: {
         const String& str = container_->data<String>();
@@ -892,8 +1717,16 @@ inline String Value::toString(const String& defaults) const {
     switch (type_) {
     case kString: return container_->data<String>();
     case kBoolean: return boolean_ ? "true" : "false";
-    case kInteger: return Serializer::int64ToString(integer_);
-    case kFloat: return Double(float_).toString();
+    case kInteger: return (format_.flags & kNumberUnsigned) ? Serializer::uint64ToString(static_cast<uint64_t>(integer_)) : Serializer::int64ToString(integer_);
+    case kFloat: {
+        if (format_.flags & kNumberRaw) {
+            String s;
+            std::back_insert_iterator<String> itr(s);
+            this->raw_to_string(itr);
+            return s;
+        }
+        return Double(float_).toString();
+    }
     default: break;
     }
     return defaults;
@@ -931,9 +1764,107 @@ inline bool Value::contains(const size_t& index) const {
     }
     return false;
 }
+inline bool Value::contains(const Key& key) const {
+    if (this->isObject()) {
+        const Object& object = container_->data<Object>();
+        return Value::find_key(object, key) != object.end();
+    }
+    return false;
+}
+template<typename T> inline bool Value::contains(T* key) const {
+    return this->contains(Key(key));
+}
+#ifdef _POCKETJSON_HAS_STRING_VIEW
+inline bool Value::contains(const std::string_view& key) const {
+    return this->contains(Key(key.data(), key.size()));
+}
+#endif
+/**
+ * True when both values refer to the same container, so they are equal without comparing contents.
+ */
+inline bool Value::shares(const Value& v) const {
+    return (type_ & kContainer) && type_ == v.type_ && container_ == v.container_;
+}
+/**
+ * Structural hash consistent with operator ==, which does not depend on addresses and is stable between runs.
+ * It walks the whole value on every call, since a child may be modified through a reference taken earlier.
+ */
+inline size_t Value::hash() const {
+    return static_cast<size_t>(this->hash_value());
+}
+inline uint64_t Value::hash_value() const {
+    uint64_t h = static_cast<uint64_t>(type_);
+    switch (type_) {
+    case kBoolean: h = Value::hash_mix(h, boolean_ ? 1 : 0); break;
+    case kInteger: h = Value::hash_mix(h, static_cast<uint64_t>(integer_)); break;
+    case kFloat: {
+        // -0.0 equals 0.0, and raw floats equal their decoded value.
+        double d = this->float_value();
+        if (d == 0.0) { d = 0.0; }
+        uint64_t bits = 0;
+        memcpy(&bits, &d, sizeof(bits));
+        h = Value::hash_mix(h, bits);
+        break;
+    }
+    case kString: {
+        const String& str = container_->data<String>();
+        h = Value::hash_mix(h, Value::hash_string(str.data(), str.size()));
+        break;
+    }
+    case kArray: {
+        const Array& array = container_->data<Array>();
+        h = Value::hash_mix(h, array.size());
+        for (size_t i = 0; i < array.size(); ++i) { h = Value::hash_mix(h, array[i].hash_value()); }
+        break;
+    }
+    case kObject: {
+        const Object& object = container_->data<Object>();
+        h = Value::hash_mix(h, object.size());
+        for (Object::const_iterator itr = object.begin(); itr != object.end(); ++itr) {
+            h = Value::hash_mix(h, Value::hash_string(itr->first.data(), itr->first.size()));
+            h = Value::hash_mix(h, itr->second.hash_value());
+        }
+        break;
+    }
+    default: h = Value::hash_mix(h, 0); break;
+    }
+    return h;
+}
+/**
+ * Combine v into h and scramble the result with the MurmurHash3 64 bit finalizer.
+ */
+inline uint64_t Value::hash_mix(const uint64_t& h, const uint64_t& v) {
+    uint64_t x = h ^ (v + ((static_cast<uint64_t>(0x9e3779b9) << 32) | 0x7f4a7c15) + (h << 6) + (h >> 2));
+    x ^= x >> 33;
+    x *= (static_cast<uint64_t>(0xff51afd7) << 32) | 0xed558ccd;
+    x ^= x >> 33;
+    x *= (static_cast<uint64_t>(0xc4ceb9fe) << 32) | 0x1a85ec53;
+    x ^= x >> 33;
+    return x;
+}
+/**
+ * FNV-1a over the bytes, so the hash does not depend on byte order.
+ */
+inline uint64_t Value::hash_string(const char* data, const size_t& size) {
+    uint64_t h = (static_cast<uint64_t>(0xcbf29ce4) << 32) | 0x84222325;
+    const uint64_t prime = (static_cast<uint64_t>(0x100) << 32) | 0x1b3;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= prime;
+    }
+    return h;
+}
+inline Object::const_iterator Value::find_key(const Object& object, const Key& key) {
+#ifdef _POCKETJSON_HAS_TRANSPARENT_LOOKUP
+    return object.find(key);
+#else
+    return object.find(key.toString());
+#endif
+}
 
 inline void Value::swap(Value& v) {
     std::swap(type_, v.type_);
+    std::swap(format_, v.format_);
     std::swap(integer_, v.integer_);
 }
 
@@ -948,29 +1879,323 @@ template<> inline bool& Value::as() { return boolean_; }
 template<> inline const bool& Value::as() const { return boolean_; }
 template<> inline int64_t& Value::as() { return integer_; }
 template<> inline const int64_t& Value::as() const { return integer_; }
-template<> inline double& Value::as() { return float_; }
-template<> inline const double& Value::as() const { return float_; }
-template<> inline String& Value::as() { return container_->data<String>(); }
+template<> inline double& Value::as() {
+    if (format_.flags & kNumberRaw) {
+        float_ = this->float_value();
+        format_ = NumberFormat();
+    }
+    return float_;
+}
+template<> inline const double& Value::as() const {
+    // A raw float has no double to refer to until the non-const as<double>() decodes it, use toDouble().
+    assert(!(format_.flags & kNumberRaw));
+    return float_;
+}
+template<> inline String& Value::as() { this->detach(); return container_->data<String>(); }
 template<> inline const String& Value::as() const { return container_->data<String>(); }
-template<> inline Array& Value::as() { return container_->data<Array>(); }
+template<> inline Array& Value::as() { this->detach(); return container_->data<Array>(); }
 template<> inline const Array& Value::as() const { return container_->data<Array>(); }
-template<> inline Object& Value::as() { return container_->data<Object>(); }
+template<> inline Object& Value::as() { this->detach(); return container_->data<Object>(); }
 template<> inline const Object& Value::as() const { return container_->data<Object>(); }
 
 inline const Value& Value::s_null() { static Value null; return null; }
-inline void Value::release() {
-    if ((type_ & kContainer) && container_ && container_->decrement()) {
-        delete container_;
-        container_ = 0;
+inline bool Value::in_range(const int64_t& minValue, const int64_t& maxValue) const {
+    return !(format_.flags & kNumberUnsigned) && is_range(integer_, minValue, maxValue);
+}
+/**
+ * Float value, decoding a raw float on every call.
+ */
+inline double Value::float_value() const {
+    if (format_.flags & kNumberRaw) {
+        const double d = Double::decimalToDouble(static_cast<uint64_t>(integer_), format_.exponent - format_.fraction);
+        return (format_.flags & kNumberNegative) ? -d : d;
     }
+    return float_;
+}
+inline void Value::setRawFloat(const uint64_t& significand, const uint8_t& flags, const uint32_t& fraction, const int& exponent) {
+    this->release();
+    type_ = kFloat;
+    format_.flags = static_cast<uint8_t>(flags | kNumberRaw);
+    format_.fraction = static_cast<uint8_t>(fraction);
+    format_.exponent = static_cast<int16_t>(exponent);
+    integer_ = static_cast<int64_t>(significand);
+}
+/**
+ * Write a raw float as it was parsed.
+ */
+template<typename Iter> inline void Value::raw_to_string(Iter& itr) const {
+    char digits[32] = {0};
+#ifdef _MSC_VER
+    const int length = _snprintf_s(digits, 31, _TRUNCATE, "%llu", static_cast<unsigned long long>(integer_));
+#else
+    const int length = snprintf(digits, 31, "%llu", static_cast<unsigned long long>(integer_));
+#endif
+    const int fraction = format_.fraction;
+    // Zeros after '.' and a zero integer part are not in the significand.
+    const int width = length > fraction ? length : fraction + 1;
+    if (format_.flags & kNumberNegative) { *itr++ = '-'; }
+    for (int i = 0; i < width; ++i) {
+        if (fraction > 0 && i == width - fraction) { *itr++ = '.'; }
+        *itr++ = i < width - length ? '0' : digits[i - (width - length)];
+    }
+    if (format_.flags & kNumberExponent) {
+        *itr++ = (format_.flags & kNumberUpperExponent) ? 'E' : 'e';
+        if (format_.flags & kNumberPlusExponent) { *itr++ = '+'; }
+        if (format_.flags & kNumberMinusExponent) { *itr++ = '-'; }
+        const int exponent = format_.exponent < 0 ? -format_.exponent : format_.exponent;
+        Serializer::int64ToString(itr, exponent);
+    }
+}
+inline void Value::release() {
+    if ((type_ & kContainer) && container_ && container_->decrement()) {
+        delete container_;
+        container_ = 0;
+    }
+}
+/**
+ * Copy the container before writing when it is shared with other values.
+ */
+inline void Value::detach() {
+    if ((type_ & kContainer) && container_->count() > 1) {
+        AbstractContainer* container = 0;
+        switch (type_) {
+        case kString: container = new Container<String>(container_->data<String>()); break;
+        case kArray: container = new Container<Array>(container_->data<Array>()); break;
+        case kObject: container = new Container<Object>(container_->data<Object>()); break;
+        default: break;
+        }
+        this->release();
+        container_ = container;
+    }
+}
+/**
+ * Detach this value and return its existing child addressed by path component index.
+ */
+inline Value* Value::child(const Path& path, const size_t& index) {
+    if (type_ == kObject) {
+        this->detach();
+        Object& object = container_->data<Object>();
+        const Object::iterator itr = object.find(path.keyAt(index));
+        return itr != object.end() ? &itr->second : 0;
+    } else if (type_ == kArray) {
+        Array& array = container_->data<Array>();
+        size_t i = 0;
+        if (!path.indexAt(index, array.size(), i) || i >= array.size()) { return 0; }
+        this->detach();
+        return &container_->data<Array>()[i];
+    }
+    return 0;
 }
 
-inline std::istream& operator >>(std::istream& is, Value& v) {
-    std::istreambuf_iterator<char> itr(is.rdbuf());
-    std::istreambuf_iterator<char> end;
-    if (!parse(v, itr, end)) {
-        is.setstate(std::ios::failbit);
+inline bool Value::set(const Path& path, const Value& v) {
+    if (path.empty()) {
+        const Value tmp(v);
+        *this = tmp;
+        return true;
+    }
+    Value* parent = this;
+    for (size_t i = 0; parent && i + 1 < path.size(); ++i) {
+        parent = parent->child(path, i);
+    }
+    if (!parent) { return false; }
+    const size_t last = path.size() - 1;
+    if (parent->isObject()) {
+        const Value tmp(v);
+        parent->detach();
+        parent->container_->data<Object>()[path.keyAt(last)] = tmp;
+        return true;
+    } else if (parent->isArray()) {
+        size_t i = 0;
+        if (!path.indexAt(last, parent->size(), i) || i > parent->size()) { return false; }
+        const Value tmp(v);
+        parent->detach();
+        Array& array = parent->container_->data<Array>();
+        if (i == array.size()) {
+            array.push_back(tmp);
+        } else {
+            array[i] = tmp;
+        }
+        return true;
+    }
+    return false;
+}
+inline bool Value::insert(const Path& path, const Value& v) {
+    if (path.empty()) { return this->set(path, v); }
+    Value* parent = this;
+    for (size_t i = 0; parent && i + 1 < path.size(); ++i) {
+        parent = parent->child(path, i);
+    }
+    if (!parent) { return false; }
+    if (parent->isObject()) { return parent->set(Path().key(path.keyAt(path.size() - 1)), v); }
+    if (!parent->isArray()) { return false; }
+    size_t i = 0;
+    if (!path.indexAt(path.size() - 1, parent->size(), i) || i > parent->size()) { return false; }
+    const Value tmp(v);
+    parent->detach();
+    Array& array = parent->container_->data<Array>();
+    array.insert(array.begin() + i, tmp);
+    return true;
+}
+inline bool Value::erase(const Path& path) {
+    if (path.empty()) { return false; }
+    Value* parent = this;
+    for (size_t i = 0; parent && i + 1 < path.size(); ++i) {
+        parent = parent->child(path, i);
+    }
+    if (!parent) { return false; }
+    const size_t last = path.size() - 1;
+    if (parent->isObject()) {
+        if (!parent->contains(path.keyAt(last))) { return false; }
+        parent->detach();
+        parent->container_->data<Object>().erase(path.keyAt(last));
+        return true;
+    } else if (parent->isArray()) {
+        size_t i = 0;
+        if (!path.indexAt(last, parent->size(), i) || i >= parent->size()) { return false; }
+        parent->detach();
+        Array& array = parent->container_->data<Array>();
+        array.erase(array.begin() + i);
+        return true;
+    }
+    return false;
+}
+inline const Value* Value::find(const Path& path) const {
+    const Value* v = this;
+    for (size_t i = 0; v && i < path.size(); ++i) {
+        if (v->isObject()) {
+            const Object& object = v->container_->data<Object>();
+            const Object::const_iterator itr = object.find(path.keyAt(i));
+            v = itr != object.end() ? &itr->second : 0;
+        } else if (v->isArray()) {
+            size_t index = 0;
+            v = path.indexAt(i, v->size(), index) && index < v->size() ? &v->container_->data<Array>()[index] : 0;
+        } else {
+            v = 0;
+        }
+    }
+    return v;
+}
+
+inline Value Value::updated(const Path& path, const Value& v) const {
+    Value next(*this); next.set(path, v); return next;
+}
+inline Value Value::inserted(const Path& path, const Value& v) const {
+    Value next(*this); next.insert(path, v); return next;
+}
+inline Value Value::erased(const Path& path) const {
+    Value next(*this); next.erase(path); return next;
+}
+
+/**
+ * Key class implementation.
+ */
+inline Key::Key(const char* str): data_(str), size_(strlen(str)), hash_(static_cast<size_t>(Value::hash_string(data_, size_))) {}
+inline Key::Key(const char* data, const size_t& size): data_(data), size_(size), hash_(static_cast<size_t>(Value::hash_string(data_, size_))) {}
+inline Key::Key(const String& str): data_(str.data()), size_(str.size()), hash_(static_cast<size_t>(Value::hash_string(data_, size_))) {}
+
+/**
+ * Path class implementation.
+ */
+inline bool Path::indexAt(const size_t& i, const size_t& arraySize, size_t& index) const {
+    const Component& c = components_[i];
+    if (c.isIndex) {
+        index = c.index;
+        return true;
+    }
+    if (c.key == "-") {
+        index = arraySize;
+        return true;
+    }
+    if (c.key.empty() || (c.key.size() > 1 && c.key[0] == '0')) { return false; }
+    size_t n = 0;
+    for (size_t k = 0; k < c.key.size(); ++k) {
+        if (c.key[k] < '0' || '9' < c.key[k]) { return false; }
+        n = n * 10 + static_cast<size_t>(c.key[k] - '0');
+    }
+    index = n;
+    return true;
+}
+
+inline FrozenValue Value::freeze() const {
+    return FrozenValue(*this);
+}
+
+/**
+ * FrozenView class implementation.
+ */
+inline Value FrozenView::toValue() const {
+    return FrozenView::deep_copy(*value_);
+}
+inline FrozenView::const_iterator FrozenView::begin() const {
+    static const Array empty;
+    if (value_->isObject()) { return const_iterator(value_->as<Object>().begin()); }
+    return const_iterator(value_->isArray() ? &value_->as<Array>() : &empty, 0);
+}
+inline FrozenView::const_iterator FrozenView::end() const {
+    static const Array empty;
+    if (value_->isObject()) { return const_iterator(value_->as<Object>().end()); }
+    return const_iterator(value_->isArray() ? &value_->as<Array>() : &empty, value_->isArray() ? value_->size() : 0);
+}
+inline Value FrozenView::deep_copy(const Value& value) {
+    switch (value.type()) {
+    case kString: return Value(value.as<String>());
+    case kArray: {
+        const Array& src = value.as<Array>();
+        Value copy(kArray);
+        Array& dst = copy.as<Array>();
+        dst.reserve(src.size());
+        for (size_t i = 0; i < src.size(); ++i) {
+            dst.push_back(FrozenView::deep_copy(src[i]));
+        }
+        return copy;
     }
+    case kObject: {
+        const Object& src = value.as<Object>();
+        Value copy(kObject);
+        Object& dst = copy.as<Object>();
+        for (Object::const_iterator itr = src.begin(); itr != src.end(); ++itr) {
+            dst.insert(dst.end(), std::make_pair(itr->first, FrozenView::deep_copy(itr->second)));
+        }
+        return copy;
+    }
+    default: break;
+    }
+    return value;
+}
+inline const Value& FrozenView::s_null() { static Value null; return null; }
+
+/**
+ * FrozenValue class implementation.
+ */
+inline FrozenValue::FrozenValue(): holder_(0) {}
+inline FrozenValue::FrozenValue(const Value& value): holder_(new Holder()) {
+    holder_->value = FrozenView(value).toValue();
+}
+inline FrozenValue::FrozenValue(const FrozenValue& v): holder_(v.holder_) {
+    if (holder_) { holder_->count.increment(); }
+}
+inline FrozenValue::~FrozenValue() { this->release(); }
+inline FrozenValue& FrozenValue::operator =(const FrozenValue& rhs) {
+    if (holder_ != rhs.holder_) {
+        this->release();
+        holder_ = rhs.holder_;
+        if (holder_) { holder_->count.increment(); }
+    }
+    return *this;
+}
+inline void FrozenValue::release() {
+    if (holder_ && holder_->count.decrement()) {
+        delete holder_;
+    }
+    holder_ = 0;
+}
+
+/**
+ * Read one value. Bytes after the value are left in the stream, so repeated reads return concatenated values.
+ */
+inline std::istream& operator >>(std::istream& is, Value& v) {
+    Parser parser;
+    parser.parse(v, is);
     return is;
 }
 inline std::ostream& operator <<(std::ostream& os, const Value& v) {
@@ -985,205 +2210,399 @@ template<typename Iter> inline Value parse(const Iter& begin, const Iter& end, c
     return value;
 }
 inline Value parse(const String& str, const ParseOption& options, String* errorMessage) {
-    return parse(str.begin(), str.end(), options, errorMessage);
+    return parse(str.data(), str.data() + str.size(), options, errorMessage);
 }
 template<typename Iter> inline bool parse(Value& value, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
     Parser parser;
     return parser.parse(value, begin, end, options, errorMessage);
 }
 inline bool parse(Value& value, const String& str, const ParseOption& options, String* errorMessage) {
-    return parse(value, str.begin(), str.end(), options, errorMessage);
+    return parse(value, str.data(), str.data() + str.size(), options, errorMessage);
 }
-template<typename Iter> inline bool parse(AbstractParseHandler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+template<typename Handler, typename Iter> inline bool parse(Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
     Parser parser;
     return parser.parse(handler, begin, end, options, errorMessage);
 }
-inline bool parse(AbstractParseHandler* handler, const String& str, const ParseOption& options, String* errorMessage) {
-    return parse(handler, str.begin(), str.end(), options, errorMessage);
+template<typename Handler> inline bool parse(Handler* handler, const String& str, const ParseOption& options, String* errorMessage) {
+    return parse(handler, str.data(), str.data() + str.size(), options, errorMessage);
+}
+template<int Options, typename Iter> inline bool parse(Value& value, const Iter& begin, const Iter& end, String* errorMessage) {
+    Parser parser;
+    return parser.parse<Options>(value, begin, end, errorMessage);
+}
+template<int Options> inline bool parse(Value& value, const String& str, String* errorMessage) {
+    return parse<Options>(value, str.data(), str.data() + str.size(), errorMessage);
+}
+template<typename Iter> inline bool validate(const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    Parser parser;
+    return parser.validate(begin, end, options, errorMessage);
+}
+inline bool validate(const String& str, const ParseOption& options, String* errorMessage) {
+    Parser parser;
+    return parser.validate(str, options, errorMessage);
 }
 
 /**
  * Parser class impelemtation.
  */
 template<typename Iter> inline bool Parser::parse(Value& value, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
-    return this->parse(&value, 0, begin, end, options, errorMessage);
+    return this->parse(&value, static_cast<AbstractParseHandler*>(0), begin, end, options, errorMessage);
 }
-template<typename Iter> inline bool Parser::parse(AbstractParseHandler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+template<typename Handler, typename Iter> inline bool Parser::parse(Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
     return this->parse(0, handler, begin, end, options, errorMessage);
 }
+inline bool Parser::parse(Value& value, const String& str, const ParseOption& options, String* errorMessage) {
+    return this->parse(&value, static_cast<AbstractParseHandler*>(0), str.data(), str.data() + str.size(), options, errorMessage);
+}
+template<typename Handler> inline bool Parser::parse(Handler* handler, const String& str, const ParseOption& options, String* errorMessage) {
+    return this->parse(0, handler, str.data(), str.data() + str.size(), options, errorMessage);
+}
+inline bool Parser::parse(Value& value, std::istream& is, const ParseOption& options, String* errorMessage) {
+    return this->parse_stream(&value, static_cast<AbstractParseHandler*>(0), is, options, errorMessage);
+}
+template<typename Handler> inline bool Parser::parse(Handler* handler, std::istream& is, const ParseOption& options, String* errorMessage) {
+    return this->parse_stream(0, handler, is, options, errorMessage);
+}
+
+template<int Options, typename Iter> inline bool Parser::parse(Value& value, const Iter& begin, const Iter& end, String* errorMessage) {
+    rawNumber_ = (Options & kParseOptionRawNumber) != 0;
+    return this->parse<Options, kTargetValue>(&value, static_cast<AbstractParseHandler*>(0), begin, end, errorMessage);
+}
+template<int Options, typename Handler, typename Iter> inline bool Parser::parse(Handler* handler, const Iter& begin, const Iter& end, String* errorMessage) {
+    return handler ? this->parse<Options, kTargetHandler>(0, handler, begin, end, errorMessage) : this->parse<Options, kTargetNone>(0, static_cast<AbstractParseHandler*>(0), begin, end, errorMessage);
+}
+template<int Options> inline bool Parser::parse(Value& value, const String& str, String* errorMessage) {
+    rawNumber_ = (Options & kParseOptionRawNumber) != 0;
+    return this->parse<Options, kTargetValue>(&value, static_cast<AbstractParseHandler*>(0), str.data(), str.data() + str.size(), errorMessage);
+}
+template<int Options, typename Handler> inline bool Parser::parse(Handler* handler, const String& str, String* errorMessage) {
+    return this->parse<Options>(handler, str.data(), str.data() + str.size(), errorMessage);
+}
 
-template<typename Iter> inline bool Parser::parse(Value* value, AbstractParseHandler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
-    lastError_.clear();
+template<typename Iter> inline bool Parser::validate(const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    return this->parse<kTargetNone>(0, static_cast<AbstractParseHandler*>(0), begin, end, static_cast<ParseOption>(options & ~kParseOptionReuseValue), errorMessage);
+}
+inline bool Parser::validate(const String& str, const ParseOption& options, String* errorMessage) {
+    // Contiguous input lets scan_string use SIMD.
+    const char* data = str.data();
+    return this->validate(data, data + str.size(), options, errorMessage);
+}
+
+/**
+ * Runtime options select one of the instantiations specialized at compile time.
+ */
+template<typename Handler, typename Iter> inline bool Parser::parse(Value* value, Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    if (value) {
+        return this->parse<kTargetValue>(value, static_cast<AbstractParseHandler*>(0), begin, end, options, errorMessage);
+    } else if (handler) {
+        return this->parse<kTargetHandler>(0, handler, begin, end, static_cast<ParseOption>(options & ~kParseOptionReuseValue), errorMessage);
+    }
+    return this->parse<kTargetNone>(0, static_cast<AbstractParseHandler*>(0), begin, end, static_cast<ParseOption>(options & ~kParseOptionReuseValue), errorMessage);
+}
+template<int Target, typename Handler, typename Iter> inline bool Parser::parse(Value* value, Handler* handler, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    rawNumber_ = (options & kParseOptionRawNumber) != 0;
+    switch (options & (kParseOptionAllowLooseFormat | kParseOptionReuseValue | kParseOptionValidateUtf8)) {
+    case 0x00: return this->parse<0x00, Target>(value, handler, begin, end, errorMessage);
+    case 0x01: return this->parse<0x01, Target>(value, handler, begin, end, errorMessage);
+    case 0x02: return this->parse<0x02, Target>(value, handler, begin, end, errorMessage);
+    case 0x03: return this->parse<0x03, Target>(value, handler, begin, end, errorMessage);
+    case 0x04: return this->parse<0x04, Target>(value, handler, begin, end, errorMessage);
+    case 0x05: return this->parse<0x05, Target>(value, handler, begin, end, errorMessage);
+    case 0x06: return this->parse<0x06, Target>(value, handler, begin, end, errorMessage);
+    case 0x07: return this->parse<0x07, Target>(value, handler, begin, end, errorMessage);
+    case 0x08: return this->parse<0x08, Target>(value, handler, begin, end, errorMessage);
+    case 0x09: return this->parse<0x09, Target>(value, handler, begin, end, errorMessage);
+    case 0x0a: return this->parse<0x0a, Target>(value, handler, begin, end, errorMessage);
+    case 0x0b: return this->parse<0x0b, Target>(value, handler, begin, end, errorMessage);
+    case 0x0c: return this->parse<0x0c, Target>(value, handler, begin, end, errorMessage);
+    case 0x0d: return this->parse<0x0d, Target>(value, handler, begin, end, errorMessage);
+    case 0x0e: return this->parse<0x0e, Target>(value, handler, begin, end, errorMessage);
+    default: return this->parse<0x0f, Target>(value, handler, begin, end, errorMessage);
+    }
+}
+template<int Options, int Target, typename Handler, typename Iter> inline bool Parser::parse(Value* value, Handler* handler, const Iter& begin, const Iter& end, String* errorMessage) {
+    _POCKETJSON_STATS(stats_.clear(); depth_ = 0; const uint64_t start = statsClock();)
+    error_.clear();
     Iterator<Iter> itr(begin, end);
     this->skip_utf8_bom(itr);
-    bool ok = this->parse_value(value, handler, itr, options);
+    bool ok = this->parse_value<Options, Target>(value, handler, itr);
     if (ok) {
-        if (!(options & kParseOptionAllowGabage)) {
+        if (!(Options & kParseOptionAllowGabage)) {
             this->skip_white_space(itr);
             if (itr && *itr != 0) {
-                lastError_ = "Gabage string exists after json string.";
-                ok = false;
+                ok = this->fail(kErrorGabage, itr);
             }
         }
     }
-    if (errorMessage) { *errorMessage = lastError_; }
+    offset_ = itr.offset();
+    _POCKETJSON_STATS(
+        stats_.bytes = itr.offset();
+        stats_.nanoseconds = statsClock() - start;
+        if (statsCallback_) { statsCallback_(stats_, statsContext_); }
+    )
+    if (errorMessage) { errorMessage->assign(error_.message()); }
     return ok;
 }
 
+/**
+ * Parse a nested value with runtime options.
+ * kParseOptionAllowGabage is ignored, since it applies to the end of the whole input only.
+ */
 template<typename Iter> inline bool Parser::parse_value(Value* value, AbstractParseHandler* handler, Iter& itr, const ParseOption& options) {
+    rawNumber_ = (options & kParseOptionRawNumber) != 0;
+    switch (options & (kParseOptionAllowCommaEnding | kParseOptionReuseValue | kParseOptionValidateUtf8)) {
+    case 0x00: return this->parse_nested<0x00>(value, handler, itr);
+    case 0x01: return this->parse_nested<0x01>(value, handler, itr);
+    case 0x04: return this->parse_nested<0x04>(value, handler, itr);
+    case 0x05: return this->parse_nested<0x05>(value, handler, itr);
+    case 0x08: return this->parse_nested<0x08>(value, handler, itr);
+    case 0x09: return this->parse_nested<0x09>(value, handler, itr);
+    case 0x0c: return this->parse_nested<0x0c>(value, handler, itr);
+    default: return this->parse_nested<0x0d>(value, handler, itr);
+    }
+}
+template<int Options, typename Iter> inline bool Parser::parse_nested(Value* value, AbstractParseHandler* handler, Iter& itr) {
+    if (value) {
+        return this->parse_value<Options, kTargetValue>(value, static_cast<AbstractParseHandler*>(0), itr);
+    } else if (handler) {
+        return this->parse_value<Options, kTargetHandler>(0, handler, itr);
+    }
+    return this->parse_value<Options, kTargetNone>(0, static_cast<AbstractParseHandler*>(0), itr);
+}
+template<int Options, int Target, typename Handler, typename Iter> inline bool Parser::parse_value(Value* value, Handler* handler, Iter& itr) {
     this->skip_white_space(itr);
     if (*itr == '"') {
-        return this->parse_string(value, handler, itr);
+        return this->parse_string<Options, Target>(value, handler, itr);
     } else if (*itr == '{') {
-        return this->parse_object(value, handler, itr, options);
+        return this->parse_object<Options, Target>(value, handler, itr);
     } else if (*itr == '[') {
-        return this->parse_array(value, handler, itr, options);
+        return this->parse_array<Options, Target>(value, handler, itr);
     } else if (*itr == '-' || ('0' <= *itr && *itr <= '9')) {
-        return this->parse_number(value, handler, itr);
+        return this->parse_number<Target>(value, handler, itr);
     } else if (*itr == 't') {
         if (*(++itr) == 'r' && *(++itr) == 'u' && *(++itr) == 'e') {
-            if (value) {
+            _POCKETJSON_STATS(stats_.addNode(kBoolean);)
+            if (Target == kTargetValue) {
                 value->setBoolean(true);
-            } else if (handler && !handler->onBoolean(true)) {
-                return this->fail("SAX handler cancels parsing.");
+            } else if (Target == kTargetHandler && !handler->onBoolean(true)) {
+                return this->fail(kErrorHandlerCancel, itr);
             }
             ++itr;
             return true;
         } else {
-            return this->fail("Invalid boolean type string exists.");
+            return this->fail(kErrorInvalidBoolean, itr);
         }
     } else if (*itr == 'f') {
         if (*(++itr) == 'a' && *(++itr) == 'l' && *(++itr) == 's' && *(++itr) == 'e') {
-            if (value) {
+            _POCKETJSON_STATS(stats_.addNode(kBoolean);)
+            if (Target == kTargetValue) {
                 value->setBoolean(false);
-            } else if (handler && !handler->onBoolean(false)) {
-                return this->fail("SAX handler cancels parsing.");
+            } else if (Target == kTargetHandler && !handler->onBoolean(false)) {
+                return this->fail(kErrorHandlerCancel, itr);
             }
             ++itr;
             return true;
         } else {
-            return this->fail("Invalid boolean type string exists.");
+            return this->fail(kErrorInvalidBoolean, itr);
         }
     } else if (*itr == 'n') {
         if (*(++itr) == 'u' && *(++itr) == 'l' && *(++itr) == 'l') {
-            if (value) {
+            _POCKETJSON_STATS(stats_.addNode(kNull);)
+            if (Target == kTargetValue) {
                 value->setNull();
-            } else if (handler && !handler->onNull()) {
-                return this->fail("SAX handler cancels parsing.");
+            } else if (Target == kTargetHandler && !handler->onNull()) {
+                return this->fail(kErrorHandlerCancel, itr);
             }
             ++itr;
             return true;
         } else {
-            return this->fail("Invalid null type string exists.");
+            return this->fail(kErrorInvalidNull, itr);
         }
     } else {
-        return this->fail("Unexpected character exists while parsing.");
+        return this->fail(kErrorUnexpectedCharacter, itr);
     }
 }
-template<typename Iter> inline bool Parser::parse_number(Value* value, AbstractParseHandler* handler, Iter& itr) {
-    String str;
+/**
+ * Digits are accumulated into one significand through the fraction.
+ * Integers use the full int64_t and uint64_t range. A float with up to 19 significant digits
+ * is converted from the significand, exactly and without strtod when it fits in a double,
+ * or kept raw with kParseOptionRawNumber. Longer floats go through Double::strToDouble.
+ */
+template<int Target, typename Handler, typename Iter> inline bool Parser::parse_number(Value* value, Handler* handler, Iter& itr) {
+    static const uint64_t kMaxSignificand = 1844674407370955161ULL; // UINT64_MAX / 10
+    static const uint32_t kMaxDigits = 19;
+    // Validation needs the grammar only, so the lexeme is not kept.
+    const bool keep = Target != kTargetNone;
+    String& str = number_;
+    str.clear();
     bool isNegative = false;
     if (*itr == '-') {
-        str.push_back(*itr);
+        if (keep) { str.push_back(*itr); }
         ++itr;
         isNegative = true;
     }
     bool isZeroAtFirst = *itr == '0';
     if (isZeroAtFirst) {
-        str.push_back(*itr);
+        if (keep) { str.push_back(*itr); }
         ++itr;
     }
-    int64_t integer = 0;
+    uint64_t significand = 0;
     uint32_t digitCount = isZeroAtFirst ? 1 : 0;
+    uint32_t significantDigits = 0;
     bool isOverflow = false;
     while ('0' <= *itr && *itr <= '9') {
         if (isZeroAtFirst) {
-            return this->fail("Unexpected '0' character is found while parsing number.");
+            return this->fail(kErrorLeadingZero, itr);
         }
-        str.push_back(*itr);
+        if (keep) { str.push_back(*itr); }
         ++digitCount;
-        if (isOverflow || (integer >= 922337203685477580LL && int(*itr - '0') > 7)) {
+        ++significantDigits;
+        const uint32_t digit = static_cast<uint32_t>(*itr - '0');
+        if (isOverflow || significand > kMaxSignificand || (significand == kMaxSignificand && digit > 5)) {
             isOverflow = true;
         } else {
-            integer = integer * 10 + static_cast<int>(*itr - '0');
+            significand = significand * 10 + digit;
         }
         ++itr;
     }
     if (digitCount == 0) {
-        return this->fail("Digit is not found while parsing number.");
+        return this->fail(kErrorMissingDigit, itr);
     }
 
     uint32_t fracLength = 0;
     if (*itr == '.') {
-        str.push_back(*itr);
+        if (keep) { str.push_back(*itr); }
         ++itr;
         while ('0' <= *itr && *itr <= '9') {
-            str.push_back(*itr);
+            if (keep) { str.push_back(*itr); }
             ++fracLength;
+            const uint32_t digit = static_cast<uint32_t>(*itr - '0');
+            if (significand == 0 && digit == 0) {
+                // Leading zeros are not significant.
+            } else if (++significantDigits <= kMaxDigits && !isOverflow) {
+                significand = significand * 10 + digit;
+            }
             ++itr;
         }
         if (fracLength == 0) {
-            return this->fail("Digit is not found after the decimal point while parsing number.");
+            return this->fail(kErrorMissingFraction, itr);
         }
     }
 
     int exp = 0;
     bool expExists = false;
+    uint8_t expFlags = 0;
     if (*itr == 'e' || *itr == 'E') {
         expExists = true;
-        str.push_back('e');
+        expFlags = Value::kNumberExponent;
+        if (*itr == 'E') { expFlags |= Value::kNumberUpperExponent; }
+        if (keep) { str.push_back('e'); }
         bool isNegativeExp = false;
         ++itr;
         if (*itr == '+') {
+            expFlags |= Value::kNumberPlusExponent;
             ++itr;
         } else if (*itr == '-') {
-            str.push_back(*itr);
+            if (keep) { str.push_back(*itr); }
+            expFlags |= Value::kNumberMinusExponent;
             isNegativeExp = true;
             ++itr;
         }
         digitCount = 0;
+        bool isLeadingZero = false;
         while ('0' <= *itr && *itr <= '9') {
+            if (digitCount == 0 && *itr == '0') { isLeadingZero = true; }
             ++digitCount;
-            str.push_back(*itr);
-            exp = exp * 10 + static_cast<int>(*itr - '0');
+            if (keep) { str.push_back(*itr); }
+            if (exp < 100000) {
+                exp = exp * 10 + static_cast<int>(*itr - '0');
+            }
             ++itr;
         }
         if (digitCount == 0) {
-            return this->fail("Digit is not found after exponent keyword while parsing number.");
+            return this->fail(kErrorMissingExponent, itr);
         }
+        // A raw float cannot write "e05" back.
+        if (isLeadingZero && digitCount > 1) { expFlags = 0; }
         if (isNegativeExp) { exp = -exp; }
     }
 
-    if (fracLength == 0 && exp == 0 && !isOverflow) {
-        const int64_t v = isNegative ? -integer : integer;
-        if (value) {
-            value->setInteger(v);
-        } else if (handler && !handler->onInteger(v)) {
-            return this->fail("SAX handler cancels parsing.");
+    const uint64_t kMinInteger = static_cast<uint64_t>(1) << 63; // -INT64_MIN
+    if (fracLength == 0 && exp == 0 && !isOverflow && (!isNegative || significand <= kMinInteger)) {
+        _POCKETJSON_STATS(stats_.addNode(kInteger);)
+        if (isNegative) {
+            const int64_t v = significand == 0 ? 0 : -static_cast<int64_t>(significand - 1) - 1;
+            if (Target == kTargetValue) {
+                value->setInteger(v);
+            } else if (Target == kTargetHandler && !handler->onInteger(v)) {
+                return this->fail(kErrorHandlerCancel, itr);
+            }
+        } else if (significand <= static_cast<uint64_t>(LLONG_MAX)) {
+            const int64_t v = static_cast<int64_t>(significand);
+            if (Target == kTargetValue) {
+                value->setInteger(v);
+            } else if (Target == kTargetHandler && !handler->onInteger(v)) {
+                return this->fail(kErrorHandlerCancel, itr);
+            }
+        } else {
+            if (Target == kTargetValue) {
+                value->setInteger(static_cast<unsigned long long>(significand));
+            } else if (Target == kTargetHandler && !handler->onUInteger(significand)) {
+                return this->fail(kErrorHandlerCancel, itr);
+            }
         }
+    } else if (Target == kTargetNone) {
+        _POCKETJSON_STATS(stats_.addNode(kFloat);)
     } else {
-        if (expExists && exp == 0) { str.erase(str.find('e')); }
-        bool ok = false;
-        const double f64 = Double::strToDouble(str.c_str(), &ok);
-        if (ok) {
-            if (value) {
-                value->setFloat(f64);
-            } else if (handler && !handler->onFloat(f64)) {
-                return this->fail("SAX handler cancels parsing.");
-            }
+        const bool isDecimal = !isOverflow && significantDigits <= kMaxDigits;
+        if (Target == kTargetValue && rawNumber_ && isDecimal && fracLength <= 0xff && -0x7fff <= exp && exp <= 0x7fff && (!expExists || expFlags)) {
+            _POCKETJSON_STATS(stats_.addNode(kFloat);)
+            value->setRawFloat(significand, static_cast<uint8_t>(expFlags | (isNegative ? Value::kNumberNegative : 0)), fracLength, exp);
+            return true;
+        }
+        double f64 = 0.0;
+        if (isDecimal && Double::fastDecimalToDouble(significand, exp - static_cast<int>(fracLength), &f64)) {
+            _POCKETJSON_STATS(stats_.addNode(kFloat);)
+            if (isNegative) { f64 = -f64; }
+        } else if (isDecimal) {
+            _POCKETJSON_STATS(stats_.addNode(kFloat); ++stats_.slowFloats;)
+            f64 = Double::decimalToDouble(significand, exp - static_cast<int>(fracLength));
+            if (isNegative) { f64 = -f64; }
         } else {
-            return this->fail("Failed to parse floating point.");
+            _POCKETJSON_STATS(stats_.addNode(kFloat); ++stats_.slowFloats;)
+            if (expExists && exp == 0) { str.erase(str.find('e')); }
+            bool ok = false;
+            f64 = Double::strToDouble(str.c_str(), &ok);
+            if (!ok) {
+                return this->fail(kErrorInvalidFloat, itr);
+            }
+        }
+        if (Target == kTargetValue) {
+            value->setFloat(f64);
+        } else if (Target == kTargetHandler && !handler->onFloat(f64)) {
+            return this->fail(kErrorHandlerCancel, itr);
         }
     }
     return true;
 }
-template<typename Iter> inline bool Parser::parse_string(Value* value, AbstractParseHandler* handler, Iter& itr) {
-    String str;
-    if (this->parse_string(str, itr)) {
-        if (value) {
-            value->setString(str);
-        } else if (handler && !handler->onString(str)) {
-            return this->fail("SAX handler cancels parsing.");
+template<int Options, int Target, typename Handler, typename Iter> inline bool Parser::parse_string(Value* value, Handler* handler, Iter& itr) {
+    if (Target == kTargetNone) {
+        _POCKETJSON_STATS(stats_.addNode(kString);)
+        return this->skip_string<(Options & kParseOptionValidateUtf8) != 0>(itr);
+    }
+    String& str = string_;
+    str.clear();
+    if (this->parse_string<(Options & kParseOptionValidateUtf8) != 0>(str, itr)) {
+        _POCKETJSON_STATS(stats_.addNode(kString);)
+        if (Target == kTargetValue) {
+            if (stringPool_ && str.size() <= stringPool_->maxLength()) {
+                *value = stringPool_->intern(str);
+            } else {
+                _POCKETJSON_STATS(if (!value->isString() || value->container_->count() > 1) { ++stats_.allocations; })
+                value->setString(str);
+            }
+        } else if (Target == kTargetHandler && !handler->onString(str)) {
+            return this->fail(kErrorHandlerCancel, itr);
         }
         return true;
     } else {
@@ -1199,7 +2618,7 @@ template<typename Iter> inline bool Parser::parse_hex(uint16_t& hex, Iter& itr)
         } else if ('A' <= *itr && *itr <= 'F') {
             hex |= uint16_t(*itr - 'A' + 0xa) << i;
         } else {
-            return this->fail("Invalid unicode hex string is found while parsing string.");
+            return this->fail(kErrorInvalidHex, itr);
         }
         if (i > 0) { ++itr; }
     }
@@ -1210,26 +2629,32 @@ template<typename Iter> inline bool Parser::parse_unicode(String& str, Iter& itr
     uint16_t u2 = 0;
     if (!this->parse_hex(u1, ++itr)) { return false; }
     if (0xd800 <= u1 && u1 <= 0xdfff) {
-        if (0xdc00 <= u1) { return false; }
+        if (0xdc00 <= u1) { return this->fail(kErrorInvalidSurrogate, itr); }
         // Surrogate pair
         if (*(++itr) != '\\' || *(++itr) != 'u') {
-            return this->fail("Invalid unicode surrogate pair is found while parsing string.");
+            return this->fail(kErrorInvalidSurrogate, itr);
         }
         if (!this->parse_hex(u2, ++itr)) { return false; }
         if (u2 < 0xdc00 || 0xdfff < u2) {
-            return this->fail("Invalid unicode surrogate pair is found while parsing string.");
+            return this->fail(kErrorInvalidSurrogate, itr);
         }
     }
     CodePoint cp(u1, u2);
     cp.toUtf8(std::back_inserter(str));
     return true;
 }
-template<typename Iter> inline bool Parser::parse_string(String& str, Iter& itr) {
+/**
+ * Decode a string. Runs of plain characters in contiguous input are copied by scan_string.
+ * With Utf8, multibyte sequences are validated while they are copied.
+ */
+template<bool Utf8, typename Iter> inline bool Parser::parse_string(String& str, Iter& itr) {
     while (++itr) {
+        this->scan_string<Utf8>(itr, &str);
         if (*itr == '"') {
             ++itr;
             return true;
         } else if (*itr == '\\') {
+            _POCKETJSON_STATS(++stats_.escapes;)
             ++itr;
             switch (*itr) {
             case '"': str.push_back('"'); break;
@@ -1242,122 +2667,285 @@ template<typename Iter> inline bool Parser::parse_string(String& str, Iter& itr)
             case 't': str.push_back('\t'); break;
             case 'u': if (!this->parse_unicode(str, itr)) { return false; } break;
             default:
-                return this->fail("Unexpected escape character is found while parsing string.");
+                return this->fail(kErrorInvalidEscape, itr);
             }
+        } else if (Utf8 && (static_cast<unsigned char>(*itr) & 0x80)) {
+            if (!this->parse_utf8(&str, itr)) { return false; }
         } else {
+            if (*itr == '\n') { itr.newline(); }
             str.push_back(*itr);
         }
     }
-    return this->fail("Expected string ending character '\"' is not found.");
+    return this->fail(kErrorUnterminatedString, itr);
 }
-template<typename Iter> inline bool Parser::parse_array(Value* value, AbstractParseHandler* handler, Iter& itr, const ParseOption& options) {
-    size_t count = 0;
-    if (value) {
-        value->setType(kArray);
-    } else if (handler && !handler->beginArray()) {
-        return this->fail("SAX handler cancels parsing.");
+/**
+ * Check a string without decoding it. Unicode escapes are decoded into the scratch buffer to check surrogate pairs.
+ */
+template<bool Utf8, typename Iter> inline bool Parser::skip_string(Iter& itr) {
+    while (++itr) {
+        this->scan_string<Utf8>(itr, 0);
+        if (*itr == '"') {
+            ++itr;
+            return true;
+        } else if (*itr == '\\') {
+            _POCKETJSON_STATS(++stats_.escapes;)
+            ++itr;
+            switch (*itr) {
+            case '"': case '/': case '\\': case 'b': case 'f': case 'n': case 'r': case 't': break;
+            case 'u':
+                string_.clear();
+                if (!this->parse_unicode(string_, itr)) { return false; }
+                break;
+            default:
+                return this->fail(kErrorInvalidEscape, itr);
+            }
+        } else if (Utf8 && (static_cast<unsigned char>(*itr) & 0x80)) {
+            if (!this->parse_utf8(0, itr)) { return false; }
+        } else if (*itr == '\n') {
+            itr.newline();
+        } else if (!itr) {
+            break;
+        }
+    }
+    return this->fail(kErrorUnterminatedString, itr);
+}
+/**
+ * Check one multibyte UTF-8 sequence starting at itr (RFC 3629), appending it to str when given.
+ * Overlong forms, surrogates and code points above U+10FFFF are rejected. itr is left on the last byte.
+ */
+template<typename Iter> inline bool Parser::parse_utf8(String* str, Iter& itr) {
+    const unsigned char lead = static_cast<unsigned char>(*itr);
+    size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    if (0xc2 <= lead && lead <= 0xdf) {
+        length = 2;
+    } else if (0xe0 <= lead && lead <= 0xef) {
+        length = 3;
+        if (lead == 0xe0) { low = 0xa0; } else if (lead == 0xed) { high = 0x9f; }
+    } else if (0xf0 <= lead && lead <= 0xf4) {
+        length = 4;
+        if (lead == 0xf0) { low = 0x90; } else if (lead == 0xf4) { high = 0x8f; }
+    } else {
+        return this->fail(kErrorInvalidUtf8, itr);
+    }
+    if (str) { str->push_back(static_cast<char>(lead)); }
+    for (size_t i = 1; i < length; ++i) {
+        const unsigned char c = static_cast<unsigned char>(*(++itr));
+        if (c < low || high < c) {
+            return this->fail(kErrorInvalidUtf8, itr);
+        }
+        if (str) { str->push_back(static_cast<char>(c)); }
+        low = 0x80;
+        high = 0xbf;
     }
+    return true;
+}
+/**
+ * Advance itr to the next character which parse_string or skip_string has to look at,
+ * appending skipped characters to str when given.
+ * Generic iterators are scanned one by one by the callers.
+ */
+template<bool Utf8, typename Iter> inline void Parser::scan_string(Iter&, String*) {}
+#ifdef _POCKETJSON_SSE2
+template<bool Utf8> inline void Parser::scan_string(Iterator<const char*>& itr, String* str) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lineBreak = _mm_set1_epi8('\n');
+    const char* begin = itr.position();
+    const char* p = begin;
+    const char* end = itr.last();
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), _mm_cmpeq_epi8(chunk, lineBreak));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(hit));
+        if (Utf8) {
+            // Bytes with the high bit set start or continue multibyte sequences.
+            mask |= static_cast<unsigned int>(_mm_movemask_epi8(chunk));
+        }
+        if (mask != 0) {
+#ifdef _MSC_VER
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            p += index;
+#else
+            p += __builtin_ctz(mask);
+#endif
+            break;
+        }
+        p += 16;
+    }
+    if (str) { str->append(begin, p); }
+    itr.skip(static_cast<size_t>(p - begin));
+}
+#endif
+template<int Options, int Target, typename Handler, typename Iter> inline bool Parser::parse_array(Value* value, Handler* handler, Iter& itr) {
+    size_t count = 0;
+    if (Target == kTargetValue) {
+        const bool reused = this->begin_container(value, kArray, static_cast<ParseOption>(Options));
+        _POCKETJSON_STATS(if (!reused) { ++stats_.allocations; })
+        (void)reused;
+    } else if (Target == kTargetHandler && !handler->beginArray()) {
+        return this->fail(kErrorHandlerCancel, itr);
+    }
+    _POCKETJSON_STATS(stats_.addNode(kArray); stats_.enter(depth_);)
+    Array* array = Target == kTargetValue ? &value->as<Array>() : 0;
+    bool ok = true;
+    bool closed = false;
     while (++itr) {
         this->skip_white_space(itr);
         if (*itr == ']') {
-            if (count == 0 || (options & kParseOptionAllowCommaEnding)) {
-                if (handler && !handler->endArray(count)) {
-                    return this->fail("SAX handler cancels parsing.");
+            if (count == 0 || (Options & kParseOptionAllowCommaEnding)) {
+                if (Target == kTargetHandler && !handler->endArray(count)) {
+                    ok = this->fail(kErrorHandlerCancel, itr);
+                    break;
                 }
                 ++itr;
+                closed = true;
                 break;
             } else {
-                return this->fail("Unexpected comma exists while parsing array.");
+                ok = this->fail(kErrorArrayTrailingComma, itr);
+                break;
             }
-            break;
         } else {
-            bool ok = false;
-            if (value) {
-                Value newValue;
-                ok = this->parse_value(&newValue, handler, itr, options);
-                value->push_back(newValue);
+            if (array) {
+                if (count >= array->size()) {
+                    array->push_back(Value());
+                }
+                ok = this->parse_value<Options, Target>(&(*array)[count], handler, itr);
             } else {
-                ok = this->parse_value(0, handler, itr, options);
+                ok = this->parse_value<Options, Target>(0, handler, itr);
             }
-            if (!ok) { return false; }
             ++count;
+            if (!ok) { break; }
 
             this->skip_white_space(itr);
             if (*itr == ',') {
                 continue;
             } else if (*itr == ']') {
-                if (handler && !handler->endArray(count)) {
-                    return this->fail("SAX handler cancels parsing.");
+                if (Target == kTargetHandler && !handler->endArray(count)) {
+                    ok = this->fail(kErrorHandlerCancel, itr);
+                    break;
                 }
                 ++itr;
+                closed = true;
                 break;
             } else {
-                return this->fail("Unexpected string exists while parsing array.");
+                ok = this->fail(kErrorArraySeparator, itr);
+                break;
             }
         }
     }
-    return true;
+    if (ok && !closed) {
+        ok = this->fail(kErrorUnterminatedArray, itr);
+    }
+    if (array && array->size() > count) {
+        // Drop elements left over from the reused value.
+        array->erase(array->begin() + count, array->end());
+    }
+    _POCKETJSON_STATS(--depth_;)
+    return ok;
 }
-template<typename Iter> inline bool Parser::parse_object(Value* value, AbstractParseHandler* handler, Iter& itr, const ParseOption& options) {
+template<int Options, int Target, typename Handler, typename Iter> inline bool Parser::parse_object(Value* value, Handler* handler, Iter& itr) {
     size_t count = 0;
-    if (value) {
-        value->setType(kObject);
-    } else if (handler && !handler->beginObject()) {
-        return this->fail("SAX handler cancels parsing.");
-    }
+    bool reused = false;
+    if (Target == kTargetValue) {
+        reused = this->begin_container(value, kObject, static_cast<ParseOption>(Options));
+        _POCKETJSON_STATS(if (!reused) { ++stats_.allocations; })
+    } else if (Target == kTargetHandler && !handler->beginObject()) {
+        return this->fail(kErrorHandlerCancel, itr);
+    }
+    _POCKETJSON_STATS(stats_.addNode(kObject); stats_.enter(depth_);)
+    Object* object = Target == kTargetValue ? &value->as<Object>() : 0;
+    bool ok = true;
+    bool closed = false;
     while (++itr) {
         this->skip_white_space(itr);
         if (*itr == '"') {
-            String key;
-            if (!this->parse_string(key, itr)) {
-                return false;
+            key_.clear();
+            const bool utf8 = (Options & kParseOptionValidateUtf8) != 0;
+            if (!(Target == kTargetNone ? this->skip_string<utf8>(itr) : this->parse_string<utf8>(key_, itr))) {
+                ok = false;
+                break;
             }
-            if (handler && !handler->onObjectKey(key)) {
-                return this->fail("SAX handler cancels parsing.");
+            if (Target == kTargetHandler && !handler->onObjectKey(key_)) {
+                ok = this->fail(kErrorHandlerCancel, itr);
+                break;
+            }
+            if (stringPool_ && Target != kTargetNone && key_.size() <= stringPool_->maxLength()) {
+                // Interned keys are written by a Serializer sharing the pool without escaping them again.
+                stringPool_->intern(key_);
             }
 
             this->skip_white_space(itr);
             if (*itr == ':') {
                 ++itr;
-                bool ok = false;
-                if (value) {
-                    Value newValue;
-                    ok = this->parse_value(&newValue, handler, itr, options);
-                    value->insert(key, newValue);
+                if (object) {
+                    // The first value wins when a key is duplicated.
+                    Value* target = 0;
+                    Value duplicated;
+                    Object::iterator oitr = object->find(key_);
+                    if (oitr == object->end()) {
+                        oitr = object->insert(oitr, std::make_pair(key_, Value()));
+                        target = &oitr->second;
+                    } else if (reused && !(oitr->second.format_.flags & Value::kMemberTouched)) {
+                        target = &oitr->second;
+                    } else {
+                        target = &duplicated;
+                    }
+                    ok = this->parse_value<Options, Target>(target, handler, itr);
+                    if (reused && target != &duplicated) { target->format_.flags |= Value::kMemberTouched; }
                 } else {
-                    ok = this->parse_value(0, handler, itr, options);
+                    ok = this->parse_value<Options, Target>(0, handler, itr);
                 }
-                if (!ok) { return false; }
+                if (!ok) { break; }
                 ++count;
 
                 this->skip_white_space(itr);
                 if (*itr == ',') {
                     continue;
                 } else if (*itr == '}') {
-                    if (handler && !handler->endObject(count)) {
-                        return this->fail("SAX handler cancels parsing.");
+                    if (Target == kTargetHandler && !handler->endObject(count)) {
+                        ok = this->fail(kErrorHandlerCancel, itr);
+                        break;
                     }
                     ++itr;
+                    closed = true;
                     break;
                 } else {
-                    return this->fail("Unexpected string exists while parsing object.");
+                    ok = this->fail(kErrorObjectSeparator, itr);
+                    break;
                 }
             } else {
-                return this->fail("Unexpected string exists while parsing object.");
+                ok = this->fail(kErrorObjectSeparator, itr);
+                break;
             }
         } else if (*itr == '}') {
-            if (count == 0 || (options & kParseOptionAllowCommaEnding)) {
-                if (handler && !handler->endObject(count)) {
-                    return this->fail("SAX handler cancels parsing.");
+            if (count == 0 || (Options & kParseOptionAllowCommaEnding)) {
+                if (Target == kTargetHandler && !handler->endObject(count)) {
+                    ok = this->fail(kErrorHandlerCancel, itr);
+                    break;
                 }
                 ++itr;
+                closed = true;
                 break;
             } else {
-                return this->fail("Unexpected comma exists while parsing object.");
+                ok = this->fail(kErrorObjectTrailingComma, itr);
+                break;
             }
+        } else if (itr) {
+            ok = this->fail(kErrorObjectSeparator, itr);
+            break;
         }
     }
-    return true;
+    if (ok && !closed) {
+        ok = this->fail(kErrorUnterminatedObject, itr);
+    }
+    if (reused) {
+        this->erase_untouched(*object);
+    }
+    _POCKETJSON_STATS(--depth_;)
+    return ok;
 }
 
 template<typename CharType> inline bool Parser::is_white_space(const CharType& c) {
@@ -1365,6 +2953,7 @@ template<typename CharType> inline bool Parser::is_white_space(const CharType& c
 }
 template<typename Iter> inline void Parser::skip_white_space(Iter& itr) {
     while (itr && is_white_space(*itr)) {
+        if (*itr == '\n') { itr.newline(); }
         ++itr;
     }
 }
@@ -1373,17 +2962,245 @@ template<typename Iter> inline void Parser::skip_utf8_bom(Iter& itr) {
         ++itr;
     }
 }
-inline bool Parser::fail(const String& error) {
-    lastError_ = error;
+/**
+ * Prepare value to receive a parsed container.
+ * Returns true when the existing container of the same type is reused (kParseOptionReuseValue),
+ * otherwise value gets a new empty container.
+ */
+inline bool Parser::begin_container(Value* value, const Type& type, const ParseOption& options) {
+    if ((options & kParseOptionReuseValue) && value->type_ == type && value->container_->count() == 1) {
+        return true;
+    }
+    value->setNull();
+    value->setType(type);
     return false;
 }
+/**
+ * Parse the bytes buffered in the get area of the stream in place.
+ * When a value continues past the buffered bytes, they are moved to stream_ and the following blocks
+ * are only scanned for the end of the value, which is then parsed once. Only bytes of the value are
+ * consumed from the stream. For a handler, the value is validated before any event is sent.
+ * Streams without a get area, like std::cin unless std::ios::sync_with_stdio(false) is called,
+ * are read through std::istreambuf_iterator one byte at a time.
+ */
+template<typename Handler> inline bool Parser::parse_stream(Value* value, Handler* handler, std::istream& is, const ParseOption& options, String* errorMessage) {
+    typedef std::char_traits<char> Traits;
+    const ParseOption streamOptions = static_cast<ParseOption>(options | kParseOptionAllowGabage);
+    std::streambuf* buf = is.rdbuf();
+    StreamScanner scanner;
+    bool ok = false;
+    stream_.clear();
+    while (buf) {
+        const bool eof = Traits::eq_int_type(buf->sgetc(), Traits::eof());
+        const char* next = StreamBuffer::next(buf);
+        const char* last = eof ? next : StreamBuffer::last(buf);
+        if (!eof && next == last) {
+            if (stream_.empty()) {
+                std::istreambuf_iterator<char> itr(buf);
+                ok = this->parse(value, handler, itr, std::istreambuf_iterator<char>(), streamOptions, 0);
+                break;
+            }
+            // The get area is gone, so the rest of the value is taken byte by byte up to its end.
+            const char c = Traits::to_char_type(buf->sgetc());
+            if (scanner.scan(&c, &c + 1) != &c) {
+                stream_.push_back(c);
+                buf->sbumpc();
+            }
+            if (!scanner.done()) { continue; }
+        } else if (!stream_.empty()) {
+            const char* end = scanner.scan(next, last);
+            stream_.append(next, end);
+            StreamBuffer::consume(buf, static_cast<size_t>(end - next));
+            if (!eof && !scanner.done()) { continue; }
+        }
+
+        if (!stream_.empty()) {
+            ok = this->parse(value, handler, stream_.data(), stream_.data() + stream_.size(), streamOptions, 0);
+            if (eof && (ok ? offset_ : error_.offset) >= stream_.size()) {
+                is.setstate(std::ios::eofbit);
+            }
+            break;
+        }
+        const size_t size = static_cast<size_t>(last - next);
+        // Handler events cannot be taken back, so the extent of the value is found first.
+        ok = this->parse(value, static_cast<AbstractParseHandler*>(0), next, last, streamOptions, 0);
+        const size_t offset = ok ? offset_ : error_.offset;
+        // A failure or a number at the end of the buffered bytes may continue in the next block.
+        if (!eof && offset >= size && (!ok || (offset > 0 && '0' <= next[offset - 1] && next[offset - 1] <= '9'))) {
+            if (scanner.scan(next, last) == last && !scanner.done()) {
+                stream_.assign(next, last);
+                StreamBuffer::consume(buf, size);
+                continue;
+            }
+        }
+        if (handler) {
+            ok = this->parse(0, handler, next, last, streamOptions, 0);
+        }
+        StreamBuffer::consume(buf, offset);
+        if (eof && offset >= size) {
+            is.setstate(std::ios::eofbit);
+        }
+        break;
+    }
+    if (!ok) {
+        is.setstate(std::ios::failbit);
+    }
+    if (errorMessage) { errorMessage->assign(error_.message()); }
+    return ok;
+}
+
+/**
+ * Parser::StreamScanner class implementation.
+ */
+inline const char* Parser::StreamScanner::scan(const char* p, const char* last) {
+    for (; p < last; ++p) {
+        const char c = *p;
+        const unsigned char u = static_cast<unsigned char>(c);
+        switch (state_) {
+        case kBefore:
+            if (c == '"') {
+                state_ = kString;
+            } else if (c == '[' || c == '{') {
+                state_ = kContainer;
+                depth_ = 1;
+            } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && u != 0xef && u != 0xbb && u != 0xbf) {
+                // Bytes of the UTF-8 BOM are skipped like white space.
+                state_ = kScalar;
+            }
+            break;
+        case kScalar:
+            if (!(('0' <= c && c <= '9') || ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '+' || c == '-' || c == '.')) {
+                state_ = kDone;
+                return p;
+            }
+            break;
+        case kString:
+            if (escaped_) {
+                escaped_ = false;
+            } else if (c == '\\') {
+                escaped_ = true;
+            } else if (c == '"') {
+                if (depth_ == 0) {
+                    state_ = kDone;
+                    return p + 1;
+                }
+                state_ = kContainer;
+            }
+            break;
+        case kContainer:
+            if (c == '"') {
+                state_ = kString;
+            } else if (c == '[' || c == '{') {
+                ++depth_;
+            } else if ((c == ']' || c == '}') && --depth_ == 0) {
+                state_ = kDone;
+                return p + 1;
+            }
+            break;
+        default:
+            return p;
+        }
+    }
+    return p;
+}
+
+/**
+ * Drop members of a reused object which were not in the input, and clear the marks of the others.
+ */
+inline void Parser::erase_untouched(Object& object) {
+    for (Object::iterator oitr = object.begin(); oitr != object.end();) {
+        if (oitr->second.format_.flags & Value::kMemberTouched) {
+            oitr->second.format_.flags &= static_cast<uint8_t>(~Value::kMemberTouched);
+            ++oitr;
+        } else {
+            object.erase(oitr++);
+        }
+    }
+}
+template<typename Iter> inline bool Parser::fail(const ErrorCode& code, const Iter& itr) {
+    error_.code = code;
+    error_.offset = itr.offset();
+    error_.line = itr.line();
+    error_.column = itr.column();
+    return false;
+}
+
+/**
+ * ParseError struct implementation.
+ */
+inline String ParseError::toString() const {
+    if (code == kErrorNone) { return String(); }
+    return "line " + Serializer::int64ToString(static_cast<int64_t>(line)) + ", column " + Serializer::int64ToString(static_cast<int64_t>(column)) + ": " + this->message();
+}
+inline const char* ParseError::message(const ErrorCode& code) {
+    switch (code) {
+    case kErrorNone: return "";
+    case kErrorGabage: return "Gabage string exists after json string.";
+    case kErrorUnexpectedCharacter: return "Unexpected character exists while parsing.";
+    case kErrorInvalidBoolean: return "Invalid boolean type string exists.";
+    case kErrorInvalidNull: return "Invalid null type string exists.";
+    case kErrorLeadingZero: return "Unexpected '0' character is found while parsing number.";
+    case kErrorMissingDigit: return "Digit is not found while parsing number.";
+    case kErrorMissingFraction: return "Digit is not found after the decimal point while parsing number.";
+    case kErrorMissingExponent: return "Digit is not found after exponent keyword while parsing number.";
+    case kErrorInvalidFloat: return "Failed to parse floating point.";
+    case kErrorInvalidHex: return "Invalid unicode hex string is found while parsing string.";
+    case kErrorInvalidSurrogate: return "Invalid unicode surrogate pair is found while parsing string.";
+    case kErrorInvalidEscape: return "Unexpected escape character is found while parsing string.";
+    case kErrorUnterminatedString: return "Expected string ending character '\"' is not found.";
+    case kErrorInvalidUtf8: return "Invalid UTF-8 sequence is found while parsing string.";
+    case kErrorArrayTrailingComma: return "Unexpected comma exists while parsing array.";
+    case kErrorArraySeparator: return "Unexpected string exists while parsing array.";
+    case kErrorUnterminatedArray: return "Expected array ending character ']' is not found.";
+    case kErrorObjectTrailingComma: return "Unexpected comma exists while parsing object.";
+    case kErrorObjectSeparator: return "Unexpected string exists while parsing object.";
+    case kErrorUnterminatedObject: return "Expected object ending character '}' is not found.";
+    case kErrorHandlerCancel: return "SAX handler cancels parsing.";
+    case kErrorExpectedBoolean: return "Boolean value is expected.";
+    case kErrorExpectedInteger: return "Integer value is expected.";
+    case kErrorIntegerRange: return "Integer value is out of range.";
+    case kErrorExpectedNumber: return "Number value is expected.";
+    case kErrorExpectedString: return "String value is expected.";
+    case kErrorExpectedArray: return "Array value is expected.";
+    case kErrorExpectedObject: return "Object value is expected.";
+    }
+    return "Unknown error.";
+}
 
 /**
  * Serializer class implementation.
  */
 template<typename Iter> inline bool Serializer::serialize(const Iter& itr, const Value& value, const SerializeOption& options, String* errorMessage) {
+    const Attributes attr = Serializer::attributes(options);
+    Iter tmp = itr;
+    if (attr.pretty) {
+        return this->serialize_root<true>(tmp, value, attr, errorMessage);
+    }
+    return this->serialize_root<false>(tmp, value, attr, errorMessage);
+}
+template<int Options, typename Iter> inline bool Serializer::serialize(const Iter& itr, const Value& value, String* errorMessage) {
+    Iter tmp = itr;
+    return this->serialize_root<(Options & kSerializeOptionPretty) != 0>(tmp, value, Serializer::attributes(Options), errorMessage);
+}
+template<bool Pretty, typename Iter> inline bool Serializer::serialize_root(Iter& itr, const Value& value, const Attributes& attr, String* errorMessage) {
+#ifdef POCKETJSON_ENABLE_STATS
+    stats_.clear();
+    depth_ = 0;
+    const uint64_t start = statsClock();
+    CountingIterator<Iter> counter(itr, stats_.bytes);
+    const bool ok = this->serialize<Pretty>(counter, value, attr, Pretty ? 0 : -1, errorMessage);
+    stats_.nanoseconds = statsClock() - start;
+    if (statsCallback_) { statsCallback_(stats_, statsContext_); }
+    return ok;
+#else
+    return this->serialize<Pretty>(itr, value, attr, Pretty ? 0 : -1, errorMessage);
+#endif
+}
+inline Serializer::Attributes Serializer::attributes(const int& options) {
     Attributes attr;
     attr.pretty = options & kSerializeOptionPretty ? true : false;
+    attr.tab = "";
+    attr.lineBreak = "";
     if (attr.pretty) {
         switch (options & 0x03) {
         case kSerializeOption4Spaces: attr.tab = "    "; break;
@@ -1392,8 +3209,9 @@ template<typename Iter> inline bool Serializer::serialize(const Iter& itr, const
         }
         attr.lineBreak = (options & kSerializeOptionCRLF) ? "\r\n" : "\n";
     }
-    Iter tmp = itr;
-    return this->serialize(tmp, value, attr, attr.pretty ? 0 : -1, errorMessage);
+    attr.tabLength = strlen(attr.tab);
+    attr.lineBreakLength = strlen(attr.lineBreak);
+    return attr;
 }
 
 template<typename Iter> inline void Serializer::int64ToString(Iter itr, const int64_t& value) {
@@ -1410,14 +3228,33 @@ template<typename Iter> inline void Serializer::int64ToString(Iter itr, const in
 inline String Serializer::int64ToString(const int64_t& value) {
     String s; Serializer::int64ToString(std::back_inserter(s), value); return s;
 }
+template<typename Iter> inline void Serializer::uint64ToString(Iter itr, const uint64_t& value) {
+    char buf[128] = {0};
+#ifdef _MSC_VER
+    const int s = _snprintf_s(buf, 127, _TRUNCATE, "%llu", static_cast<unsigned long long>(value));
+#else
+    const int s = snprintf(buf, 127, "%llu", static_cast<unsigned long long>(value));
+#endif
+    for (int i = 0; i < s; ++i) {
+        *itr++ = buf[i];
+    }
+}
+inline String Serializer::uint64ToString(const uint64_t& value) {
+    String s; Serializer::uint64ToString(std::back_inserter(s), value); return s;
+}
 
-template<typename Iter> inline bool Serializer::serialize(Iter& itr, const Value& value, const Attributes& attr, const int& indentLevel, String* errorMessage) {
+template<bool Pretty, typename Iter> inline bool Serializer::serialize(Iter& itr, const Value& value, const Attributes& attr, const int& indentLevel, String* errorMessage) {
+    _POCKETJSON_STATS(stats_.addNode(value.type());)
     switch (value.type()) {
     case kNull: this->append(itr, "null"); break;
     case kBoolean:
     case kInteger:
         this->append(itr, value.toString()); break;
     case kFloat: {
+        if (value.format_.flags & Value::kNumberRaw) {
+            value.raw_to_string(itr);
+            break;
+        }
         Double d(value.as<double>());
         if (d.isNanOrInf()) {
             if (errorMessage) { *errorMessage = "Floating point is nan or inf."; }
@@ -1427,60 +3264,74 @@ template<typename Iter> inline bool Serializer::serialize(Iter& itr, const Value
         break;
     }
     case kString: {
-        this->serialize_string(itr, value.as<String>());
+        const String* escaped = stringPool_ ? stringPool_->escaped(value.as<String>()) : 0;
+        if (escaped) {
+            this->append(itr, escaped->data(), escaped->size());
+        } else {
+            this->serialize_string(itr, value.as<String>());
+        }
         break;
     }
     case kObject: {
+        _POCKETJSON_STATS(stats_.enter(depth_);)
         int indent = indentLevel;
         *itr++ = '{';
-        if (indent > -1) {
+        if (Pretty) {
             ++indent;
         }
         const Object& object = value.as<Object>();
         for (Object::const_iterator oitr = object.begin(); oitr != object.end(); ++oitr) {
             if (oitr != object.begin()) { *itr++ = ','; }
-            if (indent > -1) {
+            if (Pretty) {
                 this->indent(itr, attr, indent);
             }
-            this->serialize_string(itr, oitr->first);
+            const String* escaped = stringPool_ ? stringPool_->escaped(oitr->first) : 0;
+            if (escaped) {
+                this->append(itr, escaped->data(), escaped->size());
+            } else {
+                this->serialize_string(itr, oitr->first);
+            }
             *itr++ = ':';
-            if (attr.pretty) { *itr++ = ' '; }
-            if (!this->serialize(itr, oitr->second, attr, indent, errorMessage)) {
+            if (Pretty) { *itr++ = ' '; }
+            if (!this->serialize<Pretty>(itr, oitr->second, attr, indent, errorMessage)) {
                 return false;
             }
         }
-        if (indent > -1) {
+        if (Pretty) {
             --indent;
             if (!object.empty()) {
                 this->indent(itr, attr, indent);
             }
         }
         *itr++ = '}';
+        _POCKETJSON_STATS(--depth_;)
         break;
     }
     case kArray: {
+        _POCKETJSON_STATS(stats_.enter(depth_);)
         int indent = indentLevel;
         *itr++ = '[';
-        if (indent > -1) {
+        if (Pretty) {
             ++indent;
         }
         const Array& array = value.as<Array>();
         for (size_t i = 0; i < array.size(); ++i) {
             if (i > 0) { *itr++ = ','; }
-            if (indent > -1) {
+            if (Pretty) {
                 this->indent(itr, attr, indent);
             }
-            if (!this->serialize(itr, array[i], attr, indent, errorMessage)) {
+            if (!this->serialize<Pretty>(itr, array[i], attr, indent, errorMessage)) {
                 return false;
             }
         }
-        if (indent > -1) {
+        if (Pretty) {
             --indent;
             if (!array.empty()) {
                 this->indent(itr, attr, indent);
             }
         }
         *itr++ = ']';
+        _POCKETJSON_STATS(--depth_;)
         break;
     }
     default: break;
@@ -1509,11 +3360,13 @@ template<typename Iter> inline void Serializer::serialize_string(Iter& itr, cons
           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0  // f0
     };
     *itr++ = '"';
+    size_t run = 0;
     for (size_t i = 0; i < value.size(); ++i) {
         const char ch = kEscape[static_cast<uint8_t>(value[i])];
-        if (ch == 0) {
-            *itr++ = value[i];
-        } else {
+        if (ch != 0) {
+            _POCKETJSON_STATS(++stats_.escapes;)
+            this->append(itr, value.data() + run, i - run);
+            run = i + 1;
             *itr++ = '\\';
             *itr++ =  ch;
             if (ch == 'u') {
@@ -1524,20 +3377,102 @@ template<typename Iter> inline void Serializer::serialize_string(Iter& itr, cons
             }
         }
     }
+    this->append(itr, value.data() + run, value.size() - run);
     *itr++ = '"';
 }
 
 template<typename Iter> inline void Serializer::indent(Iter& itr, const Attributes& attr, const int& indent) {
     if (attr.pretty) {
-        this->append(itr, attr.lineBreak);
+        this->append(itr, attr.lineBreak, attr.lineBreakLength);
         for (int i = 0; i < indent; ++i) {
-            this->append(itr, attr.tab);
+            this->append(itr, attr.tab, attr.tabLength);
         }
     }
 }
 template<typename Iter> inline void Serializer::append(Iter& itr, const String& app) {
-    for (size_t i = 0; i < app.size(); ++i) {
-        *itr++ = app[i];
+    this->append(itr, app.data(), app.size());
+}
+template<typename Iter> inline void Serializer::append(CountingIterator<Iter>& itr, const char* data, const size_t& size) {
+    itr.count(size);
+    this->append(itr.base(), data, size);
+}
+template<typename Iter> inline void Serializer::append(Iter& itr, const char* data, const size_t& size) {
+    for (size_t i = 0; i < size; ++i) {
+        *itr++ = data[i];
+    }
+}
+inline void Serializer::append(StringAppender& itr, const char* data, const size_t& size) {
+    itr.append(data, size);
+}
+
+/**
+ * StringPool class implementation.
+ */
+inline Value StringPool::intern(const String& str) {
+    if (str.size() > maxLength_) { return Value(str); }
+    const uint32_t h = StringPool::hash(str.data(), str.size());
+    const Entry* entry = this->find(str, h);
+    if (!entry) { entry = this->insert(str, h); }
+    return entry ? entry->value : Value(str);
+}
+inline const String* StringPool::escaped(const String& str) {
+    if (str.size() > maxLength_ || entries_.empty()) { return 0; }
+    Entry* entry = this->find(str, StringPool::hash(str.data(), str.size()));
+    if (!entry) { return 0; }
+    if (entry->escaped.empty()) { entry->escaped = entry->value.serialize(); }
+    return &entry->escaped;
+}
+inline bool StringPool::contains(const String& str) const {
+    return this->find(str, StringPool::hash(str.data(), str.size())) != 0;
+}
+inline void StringPool::clear() {
+    entries_.clear();
+    slots_.clear();
+}
+inline uint32_t StringPool::hash(const char* str, const size_t& length) {
+    // FNV-1a
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < length; ++i) {
+        h = (h ^ static_cast<uint8_t>(str[i])) * 16777619U;
+    }
+    return h;
+}
+inline StringPool::Entry* StringPool::find(const String& str, const uint32_t& hash) {
+    return const_cast<Entry*>(static_cast<const StringPool*>(this)->find(str, hash));
+}
+inline const StringPool::Entry* StringPool::find(const String& str, const uint32_t& hash) const {
+    if (slots_.empty()) { return 0; }
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask; slots_[i] != 0; i = (i + 1) & mask) {
+        const Entry& entry = entries_[slots_[i] - 1];
+        if (entry.hash == hash && entry.value.as<String>() == str) {
+            return &entry;
+        }
+    }
+    return 0;
+}
+inline const StringPool::Entry* StringPool::insert(const String& str, const uint32_t& hash) {
+    if (entries_.size() >= maxEntries_) { return 0; }
+    if ((entries_.size() + 1) * 2 > slots_.size()) {
+        this->rehash(slots_.empty() ? 64 : slots_.size() * 2);
+    }
+    entries_.push_back(Entry());
+    Entry& entry = entries_.back();
+    entry.hash = hash;
+    entry.value = str;
+    const size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (slots_[i] != 0) { i = (i + 1) & mask; }
+    slots_[i] = static_cast<uint32_t>(entries_.size());
+    return &entry;
+}
+inline void StringPool::rehash(const size_t& slotCount) {
+    slots_.assign(slotCount, 0);
+    const size_t mask = slotCount - 1;
+    for (size_t n = 0; n < entries_.size(); ++n) {
+        size_t i = entries_[n].hash & mask;
+        while (slots_[i] != 0) { i = (i + 1) & mask; }
+        slots_[i] = static_cast<uint32_t>(n + 1);
     }
 }
 
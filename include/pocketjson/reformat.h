@@ -0,0 +1,322 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_REFORMAT_H
+#define POCKETJSON_REFORMAT_H
+
+#include <pocketjson/pocketjson.h>
+
+namespace pocketjson {
+
+/**
+ * Rewrite JSON text in compact or pretty form without building Value tree.
+ * Object keys keep their order, and strings and numbers are copied as written, escapes included.
+ * Memory is bounded by nesting depth, so input and output can be streams.
+ * kParseOptionAllowCommaEnding, kParseOptionAllowGabage and kParseOptionValidateUtf8 are effective.
+ */
+class Reformatter {
+public:
+    inline Reformatter() {}
+    inline ~Reformatter() {}
+
+public:
+    template<typename InIter, typename OutIter> bool reformat(const InIter& begin, const InIter& end, const OutIter& out, const SerializeOption& options = kSerializeOptionNone, const ParseOption& parseOptions = kParseOptionNone, String* errorMessage = 0);
+    bool reformat(const String& in, String& out, const SerializeOption& options = kSerializeOptionNone, const ParseOption& parseOptions = kParseOptionNone, String* errorMessage = 0);
+    inline const ParseError& error() const { return parser_.error(); }
+
+private:
+    template<typename Iter, typename OutIter> bool copy_value(Iter& itr, OutIter& out);
+    template<typename Iter, typename OutIter> bool copy_key(Iter& itr, OutIter& out);
+    template<typename Iter, typename OutIter> bool copy_string(Iter& itr, OutIter& out);
+    template<typename Iter, typename OutIter> bool copy_hex(Iter& itr, OutIter& out, uint16_t& hex);
+    template<typename Iter, typename OutIter> bool copy_number(Iter& itr, OutIter& out);
+    template<typename Iter, typename OutIter> bool copy_literal(Iter& itr, OutIter& out, const char* literal, const ErrorCode& code);
+    template<typename Iter, typename OutIter> bool copy_digits(Iter& itr, OutIter& out);
+    template<typename Iter> bool unterminated(const Iter& itr);
+
+private:
+    Parser parser_;
+    Serializer serializer_;
+    Serializer::Attributes attr_;
+    ParseOption parseOptions_;
+    String utf8_;
+    String run_;
+    // Closing characters of open containers.
+    String stack_;
+
+}; // Reformatter class
+
+template<typename InIter, typename OutIter> inline bool reformat(const InIter& begin, const InIter& end, const OutIter& out, const SerializeOption& options = kSerializeOptionNone, const ParseOption& parseOptions = kParseOptionNone, String* errorMessage = 0) {
+    Reformatter reformatter;
+    return reformatter.reformat(begin, end, out, options, parseOptions, errorMessage);
+}
+inline bool reformat(const String& in, String& out, const SerializeOption& options = kSerializeOptionNone, const ParseOption& parseOptions = kParseOptionNone, String* errorMessage = 0) {
+    Reformatter reformatter;
+    return reformatter.reformat(in, out, options, parseOptions, errorMessage);
+}
+
+/**
+ * Reformatter class implementation.
+ */
+template<typename InIter, typename OutIter> inline bool Reformatter::reformat(const InIter& begin, const InIter& end, const OutIter& out, const SerializeOption& options, const ParseOption& parseOptions, String* errorMessage) {
+    parser_.error_.clear();
+    attr_ = Serializer::attributes(options);
+    parseOptions_ = parseOptions;
+    stack_.clear();
+    Parser::Iterator<InIter> itr(begin, end);
+    OutIter o = out;
+    parser_.skip_utf8_bom(itr);
+
+    bool ok = true;
+    while (ok) {
+        // A value is expected.
+        parser_.skip_white_space(itr);
+        if (*itr == '[' || *itr == '{') {
+            const char close = *itr == '[' ? ']' : '}';
+            *o++ = *itr;
+            ++itr;
+            parser_.skip_white_space(itr);
+            if (*itr == close) {
+                *o++ = close;
+                ++itr;
+            } else {
+                stack_.push_back(close);
+                serializer_.indent(o, attr_, static_cast<int>(stack_.size()));
+                if (close == '}' && !this->copy_key(itr, o)) { ok = false; }
+                continue;
+            }
+        } else if (!itr && !stack_.empty()) {
+            ok = this->unterminated(itr);
+            break;
+        } else if (!this->copy_value(itr, o)) {
+            ok = false;
+            break;
+        }
+
+        // Close finished containers until the next value is expected.
+        while (ok && !stack_.empty()) {
+            parser_.skip_white_space(itr);
+            const char close = stack_[stack_.size() - 1];
+            bool closing = *itr == close;
+            if (*itr == ',') {
+                ++itr;
+                parser_.skip_white_space(itr);
+                if (*itr == close) {
+                    if (!(parseOptions_ & kParseOptionAllowCommaEnding)) {
+                        ok = parser_.fail(close == ']' ? kErrorArrayTrailingComma : kErrorObjectTrailingComma, itr);
+                        break;
+                    }
+                    closing = true;
+                } else {
+                    *o++ = ',';
+                    serializer_.indent(o, attr_, static_cast<int>(stack_.size()));
+                    if (close == '}' && !this->copy_key(itr, o)) { ok = false; }
+                    break;
+                }
+            } else if (!closing) {
+                ok = parser_.fail(close == ']' ? kErrorArraySeparator : kErrorObjectSeparator, itr);
+                break;
+            }
+            ++itr;
+            stack_.erase(stack_.size() - 1);
+            serializer_.indent(o, attr_, static_cast<int>(stack_.size()));
+            *o++ = close;
+        }
+        if (stack_.empty()) { break; }
+    }
+
+    if (ok && !(parseOptions_ & kParseOptionAllowGabage)) {
+        parser_.skip_white_space(itr);
+        if (itr && *itr != 0) {
+            ok = parser_.fail(kErrorGabage, itr);
+        }
+    }
+    if (errorMessage) { errorMessage->assign(parser_.error_.message()); }
+    return ok;
+}
+inline bool Reformatter::reformat(const String& in, String& out, const SerializeOption& options, const ParseOption& parseOptions, String* errorMessage) {
+    const char* data = in.data();
+    return this->reformat(data, data + in.size(), StringAppender(out), options, parseOptions, errorMessage);
+}
+
+/**
+ * Copy a scalar value.
+ */
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_value(Iter& itr, OutIter& out) {
+    switch (*itr) {
+    case '"': return this->copy_string(itr, out);
+    case 't': return this->copy_literal(itr, out, "true", kErrorInvalidBoolean);
+    case 'f': return this->copy_literal(itr, out, "false", kErrorInvalidBoolean);
+    case 'n': return this->copy_literal(itr, out, "null", kErrorInvalidNull);
+    default:
+        if (*itr == '-' || ('0' <= *itr && *itr <= '9')) {
+            return this->copy_number(itr, out);
+        }
+        return parser_.fail(kErrorUnexpectedCharacter, itr);
+    }
+}
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_key(Iter& itr, OutIter& out) {
+    if (*itr != '"') {
+        return itr ? parser_.fail(kErrorObjectSeparator, itr) : this->unterminated(itr);
+    }
+    if (!this->copy_string(itr, out)) { return false; }
+    parser_.skip_white_space(itr);
+    if (*itr != ':') {
+        return parser_.fail(kErrorObjectSeparator, itr);
+    }
+    ++itr;
+    *out++ = ':';
+    if (attr_.pretty) { *out++ = ' '; }
+    return true;
+}
+/**
+ * Copy a string as written, checking escapes the same way as Parser.
+ */
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_string(Iter& itr, OutIter& out) {
+    *out++ = '"';
+    const bool utf8 = (parseOptions_ & kParseOptionValidateUtf8) != 0;
+    while (++itr) {
+        // Runs of plain characters in contiguous input are found at once.
+        run_.clear();
+        if (utf8) {
+            parser_.scan_string<true>(itr, &run_);
+        } else {
+            parser_.scan_string<false>(itr, &run_);
+        }
+        serializer_.append(out, run_);
+        const char c = *itr;
+        if (c == '"') {
+            *out++ = c;
+            ++itr;
+            return true;
+        } else if (c == '\\') {
+            *out++ = c;
+            ++itr;
+            switch (*itr) {
+            case '"': case '/': case '\\': case 'b': case 'f': case 'n': case 'r': case 't':
+                *out++ = *itr;
+                break;
+            case 'u': {
+                uint16_t u1 = 0;
+                if (!this->copy_hex(itr, out, u1)) { return false; }
+                if (0xdc00 <= u1 && u1 <= 0xdfff) {
+                    return parser_.fail(kErrorInvalidSurrogate, itr);
+                } else if (0xd800 <= u1 && u1 <= 0xdbff) {
+                    uint16_t u2 = 0;
+                    if (*(++itr) != '\\') {
+                        return parser_.fail(kErrorInvalidSurrogate, itr);
+                    }
+                    *out++ = '\\';
+                    ++itr;
+                    if (*itr != 'u') {
+                        return parser_.fail(kErrorInvalidSurrogate, itr);
+                    }
+                    if (!this->copy_hex(itr, out, u2)) { return false; }
+                    if (u2 < 0xdc00 || 0xdfff < u2) {
+                        return parser_.fail(kErrorInvalidSurrogate, itr);
+                    }
+                }
+                break;
+            }
+            default:
+                return parser_.fail(kErrorInvalidEscape, itr);
+            }
+        } else if (utf8 && (static_cast<unsigned char>(c) & 0x80)) {
+            utf8_.clear();
+            if (!parser_.parse_utf8(&utf8_, itr)) { return false; }
+            serializer_.append(out, utf8_);
+        } else if (itr) {
+            if (c == '\n') { itr.newline(); }
+            *out++ = c;
+        }
+    }
+    return parser_.fail(kErrorUnterminatedString, itr);
+}
+/**
+ * Copy 'u' and four hex digits at itr. itr is left on the last digit.
+ */
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_hex(Iter& itr, OutIter& out, uint16_t& hex) {
+    *out++ = 'u';
+    hex = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = *(++itr);
+        if ('0' <= c && c <= '9') {
+            hex = static_cast<uint16_t>((hex << 4) | (c - '0'));
+        } else if ('a' <= c && c <= 'f') {
+            hex = static_cast<uint16_t>((hex << 4) | (c - 'a' + 0xa));
+        } else if ('A' <= c && c <= 'F') {
+            hex = static_cast<uint16_t>((hex << 4) | (c - 'A' + 0xa));
+        } else {
+            return parser_.fail(kErrorInvalidHex, itr);
+        }
+        *out++ = c;
+    }
+    return true;
+}
+/**
+ * Copy a number as written, checking the same grammar as Parser.
+ */
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_number(Iter& itr, OutIter& out) {
+    if (*itr == '-') {
+        *out++ = '-';
+        ++itr;
+    }
+    if (*itr == '0') {
+        *out++ = '0';
+        ++itr;
+        if ('0' <= *itr && *itr <= '9') {
+            return parser_.fail(kErrorLeadingZero, itr);
+        }
+    } else if (!this->copy_digits(itr, out)) {
+        return parser_.fail(kErrorMissingDigit, itr);
+    }
+    if (*itr == '.') {
+        *out++ = '.';
+        ++itr;
+        if (!this->copy_digits(itr, out)) {
+            return parser_.fail(kErrorMissingFraction, itr);
+        }
+    }
+    if (*itr == 'e' || *itr == 'E') {
+        *out++ = *itr;
+        ++itr;
+        if (*itr == '+' || *itr == '-') {
+            *out++ = *itr;
+            ++itr;
+        }
+        if (!this->copy_digits(itr, out)) {
+            return parser_.fail(kErrorMissingExponent, itr);
+        }
+    }
+    return true;
+}
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_digits(Iter& itr, OutIter& out) {
+    bool found = false;
+    while ('0' <= *itr && *itr <= '9') {
+        *out++ = *itr;
+        ++itr;
+        found = true;
+    }
+    return found;
+}
+template<typename Iter, typename OutIter> inline bool Reformatter::copy_literal(Iter& itr, OutIter& out, const char* literal, const ErrorCode& code) {
+    for (const char* p = literal; *p; ++p) {
+        if (*itr != *p) {
+            return parser_.fail(code, itr);
+        }
+        *out++ = *p;
+        ++itr;
+    }
+    return true;
+}
+template<typename Iter> inline bool Reformatter::unterminated(const Iter& itr) {
+    return parser_.fail(stack_[stack_.size() - 1] == ']' ? kErrorUnterminatedArray : kErrorUnterminatedObject, itr);
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_REFORMAT_H
@@ -0,0 +1,551 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_SCHEMA_H
+#define POCKETJSON_SCHEMA_H
+
+#include <pocketjson/pocketjson.h>
+
+namespace pocketjson {
+
+class SchemaValidator;
+
+/**
+ * Compiled JSON Schema.
+ * Supported keywords are type, enum (scalar values), minimum, maximum, exclusiveMinimum,
+ * exclusiveMaximum, minLength, maxLength, items, minItems, maxItems, properties, required
+ * and additionalProperties (boolean). Other keywords are ignored.
+ */
+class Schema {
+public:
+    inline Schema() {}
+    // isCompiled() is false when the schema is invalid, and errorMessage tells why.
+    inline explicit Schema(const Value& schema, String* errorMessage = 0) { this->compile(schema, errorMessage); }
+    inline ~Schema() {}
+
+public:
+    bool compile(const Value& schema, String* errorMessage = 0);
+    inline bool isCompiled() const { return !nodes_.empty(); }
+
+private:
+    friend class SchemaValidator;
+    static const size_t kAny = static_cast<size_t>(-1);
+    // Bit of null in Node::types, since kNull is 0.
+    static const int kNullType = 0x100;
+
+    struct Node {
+        Node();
+        int types;
+        bool hasMinimum;
+        bool hasMaximum;
+        bool exclusiveMinimum;
+        bool exclusiveMaximum;
+        double minimum;
+        double maximum;
+        size_t minLength;
+        size_t maxLength;
+        size_t minItems;
+        size_t maxItems;
+        size_t items;
+        bool additionalProperties;
+        std::map<String, size_t> properties;
+        std::vector<String> required;
+        std::vector<Value> enumValues;
+    }; // Node struct
+
+    bool compile(const Value& schema, size_t& index, String& error);
+    static bool compile_type(const String& name, int& types);
+    static bool compile_size(const Value& schema, const char* keyword, size_t& size, String& error);
+
+private:
+    std::vector<Node> nodes_;
+
+}; // Schema class
+
+/**
+ * SAX handler validating events against a Schema while parsing.
+ * Events are forwarded to the wrapped handler, and parsing is canceled at the first violation.
+ */
+class SchemaValidator: public AbstractParseHandler {
+public:
+    inline SchemaValidator(const Schema& schema, AbstractParseHandler* handler = 0): schema_(schema), handler_(handler), depth_(0) {}
+    inline ~SchemaValidator() {}
+
+public:
+    inline bool isValid() const { return error_.empty(); }
+    inline const String& error() const { return error_; }
+    inline const String& errorPath() const { return errorPath_; }
+    void reset();
+
+public:
+    virtual bool onNull();
+    virtual bool onBoolean(const bool& v);
+    virtual bool onInteger(const int64_t& v);
+    virtual bool onFloat(const double& v);
+    virtual bool onString(const String& v);
+    virtual bool beginArray();
+    virtual bool endArray(const size_t& count);
+    virtual bool beginObject();
+    virtual bool onObjectKey(const String& key);
+    virtual bool endObject(const size_t& count);
+    virtual bool onUInteger(const uint64_t& v);
+
+private:
+    struct Frame {
+        size_t node;
+        Type type;
+        size_t count;
+        size_t child;
+        String key;
+        std::vector<bool> seen;
+    }; // Frame struct
+
+    const Schema::Node* enter(const Type& type, size_t& index);
+    bool check_number(const Schema::Node* node, const double& v);
+    bool check_enum(const Schema::Node* node, const Value& v);
+    bool begin(const Type& type);
+    bool end();
+    bool fail(const String& error, const size_t& depth);
+    static size_t length(const String& str);
+
+private:
+    const Schema& schema_;
+    AbstractParseHandler* handler_;
+    std::vector<Frame> stack_;
+    size_t depth_;
+    String error_;
+    String errorPath_;
+
+}; // SchemaValidator class
+
+/**
+ * SAX handler building a Value tree.
+ */
+class ValueBuilder: public AbstractParseHandler {
+public:
+    inline explicit ValueBuilder(Value& value): root_(value) {}
+    inline ~ValueBuilder() {}
+
+public:
+    inline virtual bool onNull() { this->next()->setNull(); return true; }
+    inline virtual bool onBoolean(const bool& v) { this->next()->setBoolean(v); return true; }
+    inline virtual bool onInteger(const int64_t& v) { this->next()->setInteger(v); return true; }
+    inline virtual bool onFloat(const double& v) { this->next()->setFloat(v); return true; }
+    inline virtual bool onString(const String& v) { this->next()->setString(v); return true; }
+    inline virtual bool beginArray() { return this->begin(kArray); }
+    inline virtual bool endArray(const size_t&) { stack_.pop_back(); return true; }
+    inline virtual bool beginObject() { return this->begin(kObject); }
+    inline virtual bool onObjectKey(const String& key) { key_ = key; return true; }
+    inline virtual bool endObject(const size_t&) { stack_.pop_back(); return true; }
+    inline virtual bool onUInteger(const uint64_t& v) { this->next()->setInteger(static_cast<unsigned long long>(v)); return true; }
+
+private:
+    inline Value* next() {
+        if (stack_.empty()) {
+            return &root_;
+        }
+        Value* parent = stack_.back();
+        if (parent->isArray()) {
+            Array& array = parent->as<Array>();
+            array.push_back(Value());
+            return &array.back();
+        }
+        // The first value wins when a key is duplicated, as Parser does.
+        std::pair<Object::iterator, bool> inserted = parent->as<Object>().insert(std::make_pair(key_, Value()));
+        if (!inserted.second) {
+            duplicated_.setNull();
+            return &duplicated_;
+        }
+        return &inserted.first->second;
+    }
+    inline bool begin(const Type& type) {
+        Value* value = this->next();
+        value->setNull();
+        value->setType(type);
+        stack_.push_back(value);
+        return true;
+    }
+
+private:
+    Value& root_;
+    std::vector<Value*> stack_;
+    String key_;
+    Value duplicated_;
+
+}; // ValueBuilder class
+
+template<typename Iter> bool parse(Value& value, const Schema& schema, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+inline bool parse(Value& value, const Schema& schema, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+template<typename Iter> bool parse(AbstractParseHandler* handler, const Schema& schema, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+inline bool parse(AbstractParseHandler* handler, const Schema& schema, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+/**
+ * Parse and validate in one pass. A schema violation is reported as "<path>: <error>",
+ * where path is JSON Pointer of the invalid value.
+ */
+template<typename Iter> inline bool parse(AbstractParseHandler* handler, const Schema& schema, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    SchemaValidator validator(schema, handler);
+    Parser parser;
+    const bool ok = parser.parse(&validator, begin, end, options, errorMessage);
+    if (!validator.isValid() && errorMessage) {
+        *errorMessage = validator.errorPath().empty() ? validator.error() : validator.errorPath() + ": " + validator.error();
+    }
+    return ok;
+}
+inline bool parse(AbstractParseHandler* handler, const Schema& schema, const String& str, const ParseOption& options, String* errorMessage) {
+    return parse(handler, schema, str.begin(), str.end(), options, errorMessage);
+}
+template<typename Iter> inline bool parse(Value& value, const Schema& schema, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    ValueBuilder builder(value);
+    return parse(&builder, schema, begin, end, options, errorMessage);
+}
+inline bool parse(Value& value, const Schema& schema, const String& str, const ParseOption& options, String* errorMessage) {
+    return parse(value, schema, str.begin(), str.end(), options, errorMessage);
+}
+
+/**
+ * Schema class implementation.
+ */
+inline Schema::Node::Node():
+    types(0), hasMinimum(false), hasMaximum(false), exclusiveMinimum(false), exclusiveMaximum(false),
+    minimum(0.0), maximum(0.0), minLength(0), maxLength(kAny), minItems(0), maxItems(kAny),
+    items(kAny), additionalProperties(true) {}
+
+inline bool Schema::compile(const Value& schema, String* errorMessage) {
+    nodes_.clear();
+    String error;
+    size_t index = 0;
+    const bool ok = this->compile(schema, index, error);
+    if (!ok) { nodes_.clear(); }
+    if (errorMessage) { *errorMessage = error; }
+    return ok;
+}
+inline bool Schema::compile(const Value& schema, size_t& index, String& error) {
+    if (!schema.isObject()) {
+        error = "Schema must be an object.";
+        return false;
+    }
+    index = nodes_.size();
+    nodes_.push_back(Node());
+
+    int types = 0;
+    const Value& type = schema["type"];
+    if (type.isString()) {
+        if (!Schema::compile_type(type.as<String>(), types)) {
+            error = "Unknown type \"" + type.as<String>() + "\" exists in schema.";
+            return false;
+        }
+    } else if (type.isArray()) {
+        for (size_t i = 0; i < type.size(); ++i) {
+            if (!type[i].isString() || !Schema::compile_type(type[i].as<String>(), types)) {
+                error = "Invalid type exists in schema.";
+                return false;
+            }
+        }
+    }
+    nodes_[index].types = types;
+
+    const char* keywords[] = {"minimum", "maximum", "exclusiveMinimum", "exclusiveMaximum"};
+    for (size_t i = 0; i < 4; ++i) {
+        const Value& limit = schema[keywords[i]];
+        if (limit.isNull()) { continue; }
+        if (!limit.isNumber()) {
+            error = String(keywords[i]) + " must be a number.";
+            return false;
+        }
+        Node& node = nodes_[index];
+        if (i % 2 == 0) {
+            node.hasMinimum = true;
+            node.minimum = limit.toDouble();
+            node.exclusiveMinimum = i >= 2;
+        } else {
+            node.hasMaximum = true;
+            node.maximum = limit.toDouble();
+            node.exclusiveMaximum = i >= 2;
+        }
+    }
+    if (!Schema::compile_size(schema, "minLength", nodes_[index].minLength, error) ||
+        !Schema::compile_size(schema, "maxLength", nodes_[index].maxLength, error) ||
+        !Schema::compile_size(schema, "minItems", nodes_[index].minItems, error) ||
+        !Schema::compile_size(schema, "maxItems", nodes_[index].maxItems, error)) {
+        return false;
+    }
+
+    const Value& enums = schema["enum"];
+    if (!enums.isNull()) {
+        if (!enums.isArray()) {
+            error = "enum must be an array.";
+            return false;
+        }
+        for (size_t i = 0; i < enums.size(); ++i) {
+            if (enums[i].isArray() || enums[i].isObject()) {
+                error = "enum supports only scalar values.";
+                return false;
+            }
+            nodes_[index].enumValues.push_back(enums[i]);
+        }
+    }
+
+    const Value& items = schema["items"];
+    if (!items.isNull()) {
+        size_t child = 0;
+        if (!this->compile(items, child, error)) { return false; }
+        nodes_[index].items = child;
+    }
+
+    const Value& properties = schema["properties"];
+    if (!properties.isNull()) {
+        if (!properties.isObject()) {
+            error = "properties must be an object.";
+            return false;
+        }
+        const Object& object = properties.as<Object>();
+        for (Object::const_iterator itr = object.begin(); itr != object.end(); ++itr) {
+            size_t child = 0;
+            if (!this->compile(itr->second, child, error)) { return false; }
+            nodes_[index].properties[itr->first] = child;
+        }
+    }
+
+    const Value& required = schema["required"];
+    if (!required.isNull()) {
+        if (!required.isArray()) {
+            error = "required must be an array.";
+            return false;
+        }
+        for (size_t i = 0; i < required.size(); ++i) {
+            if (!required[i].isString()) {
+                error = "required must be an array of strings.";
+                return false;
+            }
+            nodes_[index].required.push_back(required[i].as<String>());
+        }
+    }
+
+    const Value& additional = schema["additionalProperties"];
+    if (additional.isBoolean()) {
+        nodes_[index].additionalProperties = additional.toBoolean();
+    }
+    return true;
+}
+inline bool Schema::compile_type(const String& name, int& types) {
+    if (name == "null") { types |= kNullType; }
+    else if (name == "boolean") { types |= kBoolean; }
+    else if (name == "integer") { types |= kInteger; }
+    else if (name == "number") { types |= kNumber; }
+    else if (name == "string") { types |= kString; }
+    else if (name == "array") { types |= kArray; }
+    else if (name == "object") { types |= kObject; }
+    else { return false; }
+    return true;
+}
+inline bool Schema::compile_size(const Value& schema, const char* keyword, size_t& size, String& error) {
+    const Value& v = schema[keyword];
+    if (v.isNull()) { return true; }
+    if (!v.isInteger() || v.toLLong() < 0) {
+        error = String(keyword) + " must be a non-negative integer.";
+        return false;
+    }
+    size = static_cast<size_t>(v.toLLong());
+    return true;
+}
+
+/**
+ * SchemaValidator class implementation.
+ */
+inline void SchemaValidator::reset() {
+    depth_ = 0;
+    error_.clear();
+    errorPath_.clear();
+}
+
+inline bool SchemaValidator::onNull() {
+    size_t index = 0;
+    if (!this->enter(kNull, index)) { return false; }
+    return handler_ ? handler_->onNull() : true;
+}
+inline bool SchemaValidator::onBoolean(const bool& v) {
+    size_t index = 0;
+    const Schema::Node* node = this->enter(kBoolean, index);
+    if (!node || !this->check_enum(node, Value(v))) { return false; }
+    return handler_ ? handler_->onBoolean(v) : true;
+}
+inline bool SchemaValidator::onInteger(const int64_t& v) {
+    size_t index = 0;
+    const Schema::Node* node = this->enter(kInteger, index);
+    if (!node || !this->check_number(node, static_cast<double>(v)) || !this->check_enum(node, Value(v))) { return false; }
+    return handler_ ? handler_->onInteger(v) : true;
+}
+inline bool SchemaValidator::onUInteger(const uint64_t& v) {
+    size_t index = 0;
+    const Schema::Node* node = this->enter(kInteger, index);
+    if (!node || !this->check_number(node, static_cast<double>(v)) || !this->check_enum(node, Value(static_cast<unsigned long long>(v)))) { return false; }
+    return handler_ ? handler_->onUInteger(v) : true;
+}
+inline bool SchemaValidator::onFloat(const double& v) {
+    size_t index = 0;
+    const Schema::Node* node = this->enter(kFloat, index);
+    if (!node || !this->check_number(node, v) || !this->check_enum(node, Value(v))) { return false; }
+    return handler_ ? handler_->onFloat(v) : true;
+}
+inline bool SchemaValidator::onString(const String& v) {
+    size_t index = 0;
+    const Schema::Node* node = this->enter(kString, index);
+    if (!node) { return false; }
+    if (node->minLength > 0 || node->maxLength != Schema::kAny) {
+        const size_t len = SchemaValidator::length(v);
+        if (len < node->minLength) { return this->fail("String is shorter than minLength.", depth_); }
+        if (len > node->maxLength) { return this->fail("String is longer than maxLength.", depth_); }
+    }
+    if (!node->enumValues.empty() && !this->check_enum(node, Value(v))) { return false; }
+    return handler_ ? handler_->onString(v) : true;
+}
+inline bool SchemaValidator::beginArray() {
+    if (!this->begin(kArray)) { return false; }
+    return handler_ ? handler_->beginArray() : true;
+}
+inline bool SchemaValidator::endArray(const size_t& count) {
+    if (!this->end()) { return false; }
+    return handler_ ? handler_->endArray(count) : true;
+}
+inline bool SchemaValidator::beginObject() {
+    if (!this->begin(kObject)) { return false; }
+    return handler_ ? handler_->beginObject() : true;
+}
+inline bool SchemaValidator::onObjectKey(const String& key) {
+    Frame& frame = stack_[depth_ - 1];
+    frame.key = key;
+    frame.child = Schema::kAny;
+    if (frame.node != Schema::kAny) {
+        const Schema::Node& node = schema_.nodes_[frame.node];
+        const std::map<String, size_t>::const_iterator itr = node.properties.find(key);
+        if (itr != node.properties.end()) {
+            frame.child = itr->second;
+        } else if (!node.additionalProperties) {
+            return this->fail("Additional property is not allowed.", depth_);
+        }
+        for (size_t i = 0; i < node.required.size(); ++i) {
+            if (node.required[i] == key) { frame.seen[i] = true; }
+        }
+    }
+    return handler_ ? handler_->onObjectKey(key) : true;
+}
+inline bool SchemaValidator::endObject(const size_t& count) {
+    if (!this->end()) { return false; }
+    return handler_ ? handler_->endObject(count) : true;
+}
+
+/**
+ * Find the schema node of the value beginning now and check its type.
+ * Returns 0 when the value is invalid. A value without constraints gets an empty node.
+ */
+inline const Schema::Node* SchemaValidator::enter(const Type& type, size_t& index) {
+    static const Schema::Node any;
+    if (!schema_.isCompiled()) {
+        this->fail("Schema is not compiled.", 0);
+        return 0;
+    }
+    index = 0;
+    if (depth_ > 0) {
+        Frame& frame = stack_[depth_ - 1];
+        if (frame.type == kArray) {
+            index = frame.node != Schema::kAny ? schema_.nodes_[frame.node].items : Schema::kAny;
+        } else {
+            index = frame.child;
+        }
+        ++frame.count;
+    }
+    const Schema::Node* node = index != Schema::kAny ? &schema_.nodes_[index] : &any;
+    if (node->types != 0 && !(node->types & (type == kNull ? Schema::kNullType : type))) {
+        this->fail("Type is not allowed.", depth_);
+        return 0;
+    }
+    return node;
+}
+inline bool SchemaValidator::check_number(const Schema::Node* node, const double& v) {
+    if (node->hasMinimum && (v < node->minimum || (node->exclusiveMinimum && v == node->minimum))) {
+        return this->fail("Number is less than minimum.", depth_);
+    }
+    if (node->hasMaximum && (v > node->maximum || (node->exclusiveMaximum && v == node->maximum))) {
+        return this->fail("Number is greater than maximum.", depth_);
+    }
+    return true;
+}
+inline bool SchemaValidator::check_enum(const Schema::Node* node, const Value& v) {
+    if (node->enumValues.empty()) { return true; }
+    for (size_t i = 0; i < node->enumValues.size(); ++i) {
+        const Value& e = node->enumValues[i];
+        if (e == v || (e.isNumber() && v.isNumber() && e.toDouble() == v.toDouble())) { return true; }
+    }
+    return this->fail("Value is not in enum.", depth_);
+}
+inline bool SchemaValidator::begin(const Type& type) {
+    size_t index = 0;
+    const Schema::Node* node = this->enter(type, index);
+    if (!node) { return false; }
+    // Frames are reused between containers to keep their buffers.
+    if (stack_.size() <= depth_) { stack_.push_back(Frame()); }
+    Frame& frame = stack_[depth_++];
+    frame.node = index;
+    frame.type = type;
+    frame.count = 0;
+    frame.child = Schema::kAny;
+    frame.key.clear();
+    frame.seen.assign(node->required.size(), false);
+    return true;
+}
+inline bool SchemaValidator::end() {
+    const Frame& frame = stack_[depth_ - 1];
+    if (frame.node != Schema::kAny) {
+        const Schema::Node& node = schema_.nodes_[frame.node];
+        if (frame.type == kArray) {
+            if (frame.count < node.minItems) { return this->fail("Array has fewer items than minItems.", depth_ - 1); }
+            if (frame.count > node.maxItems) { return this->fail("Array has more items than maxItems.", depth_ - 1); }
+        } else {
+            for (size_t i = 0; i < node.required.size(); ++i) {
+                if (!frame.seen[i]) { return this->fail("Required property \"" + node.required[i] + "\" does not exist.", depth_ - 1); }
+            }
+        }
+    }
+    --depth_;
+    return true;
+}
+/**
+ * Record the error and the JSON Pointer of the value at depth, e.g. "/users/0/name".
+ */
+inline bool SchemaValidator::fail(const String& error, const size_t& depth) {
+    error_ = error;
+    errorPath_.clear();
+    for (size_t i = 0; i < depth; ++i) {
+        const Frame& frame = stack_[i];
+        errorPath_.push_back('/');
+        if (frame.type == kArray) {
+            errorPath_ += Serializer::int64ToString(static_cast<int64_t>(frame.count - 1));
+        } else {
+            for (size_t k = 0; k < frame.key.size(); ++k) {
+                if (frame.key[k] == '~') { errorPath_ += "~0"; }
+                else if (frame.key[k] == '/') { errorPath_ += "~1"; }
+                else { errorPath_.push_back(frame.key[k]); }
+            }
+        }
+    }
+    return false;
+}
+/**
+ * Count code points of UTF-8 string.
+ */
+inline size_t SchemaValidator::length(const String& str) {
+    size_t n = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        if ((static_cast<unsigned char>(str[i]) & 0xc0) != 0x80) { ++n; }
+    }
+    return n;
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_SCHEMA_H
@@ -0,0 +1,515 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_SNAPSHOT_H
+#define POCKETJSON_SNAPSHOT_H
+
+#include <pocketjson/pocketjson.h>
+#include <string.h>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace pocketjson {
+
+/**
+ * Read only view of a value stored in a binary snapshot.
+ * Children are located through offsets, so no value is deserialized until it is queried.
+ * A default constructed view or a view of missing key/index is null.
+ */
+class SnapshotValue {
+public:
+    inline SnapshotValue(): base_(0), offset_(0) {}
+    inline SnapshotValue(const char* base, const uint64_t& offset): base_(base), offset_(offset) {}
+    inline ~SnapshotValue() {}
+
+public:
+    inline SnapshotValue operator [](const String& key) const { SnapshotValue v; this->find(key.c_str(), key.size(), &v); return v; }
+    template<size_t N> inline SnapshotValue operator [](const char (&key)[N]) const { SnapshotValue v; this->find(key, strlen(key), &v); return v; }
+    SnapshotValue operator [](const size_t& index) const;
+
+public:
+    Type type() const;
+    inline bool isNull() const { return this->type() == kNull; }
+    inline bool isBoolean() const { return this->type() == kBoolean; }
+    inline bool isInteger() const { return this->type() == kInteger; }
+    inline bool isFloat() const { return this->type() == kFloat; }
+    inline bool isNumber() const { return this->type() & kNumber ? true : false; }
+    inline bool isString() const { return this->type() == kString; }
+    inline bool isArray() const { return this->type() == kArray; }
+    inline bool isObject() const { return this->type() == kObject; }
+
+    inline bool toBoolean(const bool& defaults = false) const { return this->scalar().toBoolean(defaults); }
+    inline char toChar(const char& defaults = 0) const { return this->scalar().toChar(defaults); }
+    inline short toShort(const short& defaults = 0) const { return this->scalar().toShort(defaults); }
+    inline int toInt(const int& defaults = 0) const { return this->scalar().toInt(defaults); }
+    inline long toLong(const long& defaults = 0) const { return this->scalar().toLong(defaults); }
+    inline long long toLLong(const long long& defaults = 0) const { return this->scalar().toLLong(defaults); }
+    inline unsigned char toUChar(const unsigned char& defaults = 0) const { return this->scalar().toUChar(defaults); }
+    inline unsigned short toUShort(const unsigned short& defaults = 0) const { return this->scalar().toUShort(defaults); }
+    inline unsigned int toUInt(const unsigned int& defaults = 0) const { return this->scalar().toUInt(defaults); }
+    inline unsigned long toULong(const unsigned long& defaults = 0) const { return this->scalar().toULong(defaults); }
+    inline unsigned long long toULLong(const unsigned long long& defaults = 0) const { return this->scalar().toULLong(defaults); }
+    inline float toFloat(const float& defaults = 0.0f) const { return this->scalar().toFloat(defaults); }
+    inline double toDouble(const double& defaults = 0.0) const { return this->scalar().toDouble(defaults); }
+    String toString(const String& defaults = "") const;
+    template<typename T> inline T toEnum(const T& defaults = T(0)) const { return this->scalar().toEnum(defaults); }
+
+    const char* c_str() const;
+    bool empty() const;
+    size_t size() const;
+    inline bool contains(const String& key) const { return this->find(key.c_str(), key.size(), 0); }
+    inline bool contains(const size_t& index) const { return this->isArray() && index < this->size(); }
+
+    String keyAt(const size_t& index) const;
+    SnapshotValue valueAt(const size_t& index) const;
+
+    Value toValue() const;
+
+private:
+    bool find(const char* key, const size_t& length, SnapshotValue* value) const;
+    Value scalar() const;
+
+    // Fields are copied out, so a buffer passed to Snapshot::load() needs no alignment.
+    inline uint32_t header(const size_t& i) const { uint32_t v = 0; memcpy(&v, base_ + offset_ + i * sizeof(v), sizeof(v)); return v; }
+    inline const char* payload() const { return base_ + offset_ + 8; }
+    inline uint64_t offsetAt(const size_t& i) const { uint64_t v = 0; memcpy(&v, this->payload() + i * sizeof(v), sizeof(v)); return v; }
+
+private:
+    const char* base_;
+    uint64_t offset_;
+}; // SnapshotValue class
+
+/**
+ * Binary snapshot holder.
+ * Maps a snapshot file into memory (or wraps a caller owned buffer) and exposes its root value.
+ * Pages are loaded on demand by the operating system while values are queried.
+ * Snapshot files are trusted input: only the header and trailer are validated.
+ */
+class Snapshot {
+public:
+    inline Snapshot(): data_(0), size_(0), mapped_(false) {}
+    inline ~Snapshot() { this->close(); }
+
+public:
+    bool open(const String& path, String* errorMessage = 0);
+    bool load(const char* data, const size_t& size, String* errorMessage = 0);
+    void close();
+
+    inline bool isOpen() const { return data_ != 0; }
+    inline size_t size() const { return size_; }
+    SnapshotValue root() const;
+
+private:
+    Snapshot(const Snapshot&);
+    Snapshot& operator =(const Snapshot&);
+
+    bool validate(const char* data, const size_t& size, String* errorMessage);
+    bool fail(const String& error, String* errorMessage);
+
+private:
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+}; // Snapshot class
+
+template<typename Iter> inline bool writeSnapshot(const Iter& itr, const Value& value, String* errorMessage = 0);
+inline bool writeSnapshot(String& str, const Value& value, String* errorMessage = 0);
+inline bool saveSnapshot(const String& path, const Value& value, String* errorMessage = 0);
+
+
+/*-----------------------------------------------------------
+ * Inline implementation.
+ *-----------------------------------------------------------*/
+/**
+ * Snapshot file layout.
+ *
+ *   header:  "PJSN" magic, uint32 byte order mark
+ *   nodes:   8 byte aligned, children are always written before their parent
+ *   trailer: uint64 offset of the root node
+ *
+ * Every node starts with uint32 type and uint32 length followed by the payload.
+ *   null/boolean: no payload (length holds the boolean)
+ *   integer/float: 8 byte value (integer length is 1 for uint64 above INT64_MAX)
+ *   string: length bytes and '\0'
+ *   array: length child offsets
+ *   object: length pairs of key string offset and value offset sorted by key
+ */
+class SnapshotFormat {
+public:
+    static const uint32_t kByteOrderMark = 0x01020304;
+    static const size_t kHeaderSize = 8;
+    static const size_t kTrailerSize = 8;
+    static const size_t kNodeHeaderSize = 8;
+
+    static inline const char* magic() { return "PJSN"; }
+    static inline uint64_t padding(const uint64_t& size) { return (8 - (size & 7)) & 7; }
+    static inline int compare(const char* lhs, const size_t& lhsLength, const char* rhs, const size_t& rhsLength) {
+        const int c = memcmp(lhs, rhs, std::min(lhsLength, rhsLength));
+        if (c != 0) { return c; }
+        return lhsLength < rhsLength ? -1 : (lhsLength > rhsLength ? 1 : 0);
+    }
+}; // SnapshotFormat class
+
+template<typename Iter>
+class SnapshotWriter {
+public:
+    inline SnapshotWriter(const Iter& itr): itr_(itr), offset_(0), ok_(true) {}
+    inline ~SnapshotWriter() {}
+
+public:
+    /**
+     * Returns false when a string, array or object has more than UINT32_MAX bytes or elements.
+     * The output is incomplete then.
+     */
+    inline bool write(const Value& value) {
+        this->append(SnapshotFormat::magic(), 4);
+        const uint32_t bom = SnapshotFormat::kByteOrderMark;
+        this->append(&bom, sizeof(bom));
+        const uint64_t root = this->write_value(value);
+        if (!ok_) { return false; }
+        this->append(&root, sizeof(root));
+        return true;
+    }
+
+private:
+    uint64_t write_value(const Value& value) {
+        if (!ok_) { return 0; }
+        switch (value.type()) {
+        case kBoolean: return this->write_node(kBoolean, value.as<bool>() ? 1 : 0, 0, 0);
+        case kInteger: {
+            // as<int64_t>() keeps the bits of a uint64 above INT64_MAX, which toULLong() reads back.
+            const int64_t v = value.as<int64_t>();
+            return this->write_node(kInteger, v < 0 && value.toULLong() != 0 ? 1 : 0, &v, sizeof(int64_t));
+        }
+        case kFloat: {
+            const double v = value.toDouble();
+            return this->write_node(kFloat, 0, &v, sizeof(double));
+        }
+        case kString: return this->write_string(value.as<String>());
+        case kArray: {
+            const Array& array = value.as<Array>();
+            std::vector<uint64_t> children(array.size());
+            for (size_t i = 0; i < array.size(); ++i) {
+                children[i] = this->write_value(array[i]);
+            }
+            if (!this->fits(array.size())) { return 0; }
+            return this->write_node(kArray, static_cast<uint32_t>(children.size()), children.empty() ? 0 : &children[0], children.size() * sizeof(uint64_t));
+        }
+        case kObject: {
+            // Object keys are already sorted by std::map, which matches SnapshotFormat::compare.
+            const Object& object = value.as<Object>();
+            if (!this->fits(object.size())) { return 0; }
+            std::vector<uint64_t> children;
+            children.reserve(object.size() * 2);
+            for (Object::const_iterator itr = object.begin(); itr != object.end(); ++itr) {
+                std::map<String, uint64_t>::const_iterator key = keys_.find(itr->first);
+                const uint64_t keyOffset = key != keys_.end() ? key->second : this->write_key(itr->first);
+                children.push_back(keyOffset);
+                children.push_back(this->write_value(itr->second));
+            }
+            return this->write_node(kObject, static_cast<uint32_t>(object.size()), children.empty() ? 0 : &children[0], children.size() * sizeof(uint64_t));
+        }
+        default: break;
+        }
+        return this->write_node(kNull, 0, 0, 0);
+    }
+    inline uint64_t write_key(const String& key) {
+        const uint64_t offset = this->write_string(key);
+        keys_.insert(std::make_pair(key, offset));
+        return offset;
+    }
+    inline uint64_t write_string(const String& str) {
+        if (!this->fits(str.size())) { return 0; }
+        return this->write_node(kString, static_cast<uint32_t>(str.size()), str.c_str(), str.size() + 1);
+    }
+    inline uint64_t write_node(const Type& type, const uint32_t& length, const void* payload, const size_t& size) {
+        const uint64_t offset = offset_;
+        const uint32_t header[2] = {static_cast<uint32_t>(type), length};
+        this->append(header, sizeof(header));
+        this->append(payload, size);
+        static const char kZero[8] = {0};
+        this->append(kZero, static_cast<size_t>(SnapshotFormat::padding(offset_)));
+        return offset;
+    }
+    // Lengths are stored as uint32.
+    inline bool fits(const size_t& length) {
+        if (static_cast<uint64_t>(length) > 0xffffffffULL) { ok_ = false; }
+        return ok_;
+    }
+    inline void append(const void* data, const size_t& size) {
+        const char* p = static_cast<const char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            *itr_++ = p[i];
+        }
+        offset_ += size;
+    }
+
+private:
+    Iter itr_;
+    uint64_t offset_;
+    bool ok_;
+    std::map<String, uint64_t> keys_;
+}; // SnapshotWriter class
+
+template<typename Iter> inline bool writeSnapshot(const Iter& itr, const Value& value, String* errorMessage) {
+    SnapshotWriter<Iter> writer(itr);
+    const bool ok = writer.write(value);
+    if (errorMessage) {
+        if (ok) { errorMessage->clear(); } else { *errorMessage = "Length exceeds the snapshot limit of UINT32_MAX."; }
+    }
+    return ok;
+}
+inline bool writeSnapshot(String& str, const Value& value, String* errorMessage) {
+    return writeSnapshot(std::back_inserter(str), value, errorMessage);
+}
+inline bool saveSnapshot(const String& path, const Value& value, String* errorMessage) {
+    std::ofstream ofs(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        if (errorMessage) { *errorMessage = "Failed to open snapshot file for writing."; }
+        return false;
+    }
+    if (!writeSnapshot(std::ostreambuf_iterator<char>(ofs), value, errorMessage)) {
+        return false;
+    }
+    ofs.flush();
+    if (!ofs) {
+        if (errorMessage) { *errorMessage = "Failed to write snapshot file."; }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * SnapshotValue class implementation.
+ */
+inline SnapshotValue SnapshotValue::operator [](const size_t& index) const {
+    if (this->isArray() && index < this->header(1)) {
+        return SnapshotValue(base_, this->offsetAt(index));
+    }
+    return SnapshotValue();
+}
+
+inline Type SnapshotValue::type() const {
+    return base_ ? static_cast<Type>(this->header(0)) : kNull;
+}
+
+inline String SnapshotValue::toString(const String& defaults) const {
+    if (this->isString()) {
+        return String(this->payload(), this->header(1));
+    }
+    return this->scalar().toString(defaults);
+}
+
+inline const char* SnapshotValue::c_str() const {
+    return this->isString() ? this->payload() : "";
+}
+inline bool SnapshotValue::empty() const {
+    return this->size() == 0;
+}
+inline size_t SnapshotValue::size() const {
+    switch (this->type()) {
+    case kString:
+    case kArray:
+    case kObject:
+        return this->header(1);
+    default: break;
+    }
+    return 0;
+}
+
+inline String SnapshotValue::keyAt(const size_t& index) const {
+    if (this->isObject() && index < this->header(1)) {
+        return SnapshotValue(base_, this->offsetAt(index * 2)).toString();
+    }
+    return String();
+}
+inline SnapshotValue SnapshotValue::valueAt(const size_t& index) const {
+    if (this->isObject()) {
+        return index < this->header(1) ? SnapshotValue(base_, this->offsetAt(index * 2 + 1)) : SnapshotValue();
+    }
+    return (*this)[index];
+}
+
+inline Value SnapshotValue::toValue() const {
+    switch (this->type()) {
+    case kArray: {
+        Value value(kArray);
+        Array& array = value.as<Array>();
+        array.reserve(this->size());
+        for (size_t i = 0; i < this->size(); ++i) {
+            array.push_back((*this)[i].toValue());
+        }
+        return value;
+    }
+    case kObject: {
+        Value value(kObject);
+        Object& object = value.as<Object>();
+        for (size_t i = 0; i < this->size(); ++i) {
+            object.insert(object.end(), std::make_pair(this->keyAt(i), this->valueAt(i).toValue()));
+        }
+        return value;
+    }
+    default: break;
+    }
+    return this->scalar();
+}
+
+inline bool SnapshotValue::find(const char* key, const size_t& length, SnapshotValue* value) const {
+    if (!this->isObject()) { return false; }
+    size_t first = 0;
+    size_t last = this->header(1);
+    while (first < last) {
+        const size_t middle = first + (last - first) / 2;
+        const SnapshotValue k(base_, this->offsetAt(middle * 2));
+        const int c = SnapshotFormat::compare(k.payload(), k.header(1), key, length);
+        if (c == 0) {
+            if (value) { *value = SnapshotValue(base_, this->offsetAt(middle * 2 + 1)); }
+            return true;
+        } else if (c < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return false;
+}
+
+inline Value SnapshotValue::scalar() const {
+    switch (this->type()) {
+    case kBoolean: return Value(this->header(1) != 0);
+    case kInteger: {
+        int64_t v = 0; memcpy(&v, this->payload(), sizeof(v));
+        return this->header(1) ? Value(static_cast<unsigned long long>(v)) : Value(static_cast<long long>(v));
+    }
+    case kFloat: {
+        double v = 0.0; memcpy(&v, this->payload(), sizeof(v)); return Value(v);
+    }
+    case kString: return Value(String(this->payload(), this->header(1)));
+    default: break;
+    }
+    return Value();
+}
+
+/**
+ * Snapshot class implementation.
+ */
+inline bool Snapshot::open(const String& path, String* errorMessage) {
+    this->close();
+#ifdef _WIN32
+    HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return this->fail("Failed to open snapshot file.", errorMessage);
+    }
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        ::CloseHandle(file);
+        return this->fail("Failed to get snapshot file size.", errorMessage);
+    }
+    HANDLE mapping = ::CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    ::CloseHandle(file);
+    if (!mapping) {
+        return this->fail("Failed to map snapshot file.", errorMessage);
+    }
+    const void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (!data) {
+        return this->fail("Failed to map snapshot file.", errorMessage);
+    }
+    const size_t size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return this->fail("Failed to open snapshot file.", errorMessage);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return this->fail("Failed to get snapshot file size.", errorMessage);
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return this->fail("Failed to map snapshot file.", errorMessage);
+    }
+#endif
+    if (!this->validate(static_cast<const char*>(data), size, errorMessage)) {
+#ifdef _WIN32
+        ::UnmapViewOfFile(data);
+#else
+        ::munmap(data, size);
+#endif
+        return false;
+    }
+    data_ = static_cast<const char*>(data);
+    size_ = size;
+    mapped_ = true;
+    return true;
+}
+inline bool Snapshot::load(const char* data, const size_t& size, String* errorMessage) {
+    this->close();
+    if (!this->validate(data, size, errorMessage)) {
+        return false;
+    }
+    data_ = data;
+    size_ = size;
+    return true;
+}
+inline void Snapshot::close() {
+    if (data_ && mapped_) {
+#ifdef _WIN32
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+    data_ = 0;
+    size_ = 0;
+    mapped_ = false;
+}
+inline SnapshotValue Snapshot::root() const {
+    if (!data_) { return SnapshotValue(); }
+    uint64_t root = 0;
+    memcpy(&root, data_ + size_ - SnapshotFormat::kTrailerSize, sizeof(root));
+    return SnapshotValue(data_, root);
+}
+inline bool Snapshot::validate(const char* data, const size_t& size, String* errorMessage) {
+    if (!data || size < SnapshotFormat::kHeaderSize + SnapshotFormat::kTrailerSize + SnapshotFormat::kNodeHeaderSize) {
+        return this->fail("Snapshot is too small.", errorMessage);
+    }
+    uint32_t bom = 0;
+    memcpy(&bom, data + 4, sizeof(bom));
+    if (memcmp(data, SnapshotFormat::magic(), 4) != 0 || bom != SnapshotFormat::kByteOrderMark) {
+        return this->fail("Snapshot header is invalid.", errorMessage);
+    }
+    uint64_t root = 0;
+    memcpy(&root, data + size - SnapshotFormat::kTrailerSize, sizeof(root));
+    if (root < SnapshotFormat::kHeaderSize || root > size - SnapshotFormat::kTrailerSize - SnapshotFormat::kNodeHeaderSize || (root & 7) != 0) {
+        return this->fail("Snapshot root offset is invalid.", errorMessage);
+    }
+    if (errorMessage) { errorMessage->clear(); }
+    return true;
+}
+inline bool Snapshot::fail(const String& error, String* errorMessage) {
+    if (errorMessage) { *errorMessage = error; }
+    return false;
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_SNAPSHOT_H
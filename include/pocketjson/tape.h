@@ -0,0 +1,380 @@
+/**
+ * pocketjson
+ * Copyright (c) 2016 Jun Nishimura.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef POCKETJSON_TAPE_H
+#define POCKETJSON_TAPE_H
+
+#include <pocketjson/pocketjson.h>
+#include <string.h>
+
+namespace pocketjson {
+
+class Tape;
+
+/**
+ * Read only accessor of a value stored in a tape.
+ * A default constructed accessor or an accessor of missing key/index is null.
+ */
+class TapeValue {
+public:
+    inline TapeValue(): tape_(0), index_(0) {}
+    inline TapeValue(const Tape* tape, const size_t& index): tape_(tape), index_(index) {}
+    inline ~TapeValue() {}
+
+public:
+    inline TapeValue operator [](const String& key) const { return this->find(key.c_str(), key.size()); }
+    template<size_t N> inline TapeValue operator [](const char (&key)[N]) const { return this->find(key, strlen(key)); }
+    TapeValue operator [](const size_t& index) const;
+
+public:
+    Type type() const;
+    inline bool isNull() const { return this->type() == kNull; }
+    inline bool isBoolean() const { return this->type() == kBoolean; }
+    inline bool isInteger() const { return this->type() == kInteger; }
+    inline bool isFloat() const { return this->type() == kFloat; }
+    inline bool isNumber() const { return this->type() & kNumber ? true : false; }
+    inline bool isString() const { return this->type() == kString; }
+    inline bool isArray() const { return this->type() == kArray; }
+    inline bool isObject() const { return this->type() == kObject; }
+
+    inline bool toBoolean(const bool& defaults = false) const { return this->scalar().toBoolean(defaults); }
+    inline char toChar(const char& defaults = 0) const { return this->scalar().toChar(defaults); }
+    inline short toShort(const short& defaults = 0) const { return this->scalar().toShort(defaults); }
+    inline int toInt(const int& defaults = 0) const { return this->scalar().toInt(defaults); }
+    inline long toLong(const long& defaults = 0) const { return this->scalar().toLong(defaults); }
+    inline long long toLLong(const long long& defaults = 0) const { return this->scalar().toLLong(defaults); }
+    inline unsigned char toUChar(const unsigned char& defaults = 0) const { return this->scalar().toUChar(defaults); }
+    inline unsigned short toUShort(const unsigned short& defaults = 0) const { return this->scalar().toUShort(defaults); }
+    inline unsigned int toUInt(const unsigned int& defaults = 0) const { return this->scalar().toUInt(defaults); }
+    inline unsigned long toULong(const unsigned long& defaults = 0) const { return this->scalar().toULong(defaults); }
+    inline unsigned long long toULLong(const unsigned long long& defaults = 0) const { return this->scalar().toULLong(defaults); }
+    inline float toFloat(const float& defaults = 0.0f) const { return this->scalar().toFloat(defaults); }
+    inline double toDouble(const double& defaults = 0.0) const { return this->scalar().toDouble(defaults); }
+    String toString(const String& defaults = "") const;
+    template<typename T> inline T toEnum(const T& defaults = T(0)) const { return this->scalar().toEnum(defaults); }
+
+    const char* c_str() const;
+    inline bool empty() const { return this->size() == 0; }
+    size_t size() const;
+    inline bool contains(const String& key) const { return this->find_index(key.c_str(), key.size()) != 0; }
+    inline bool contains(const size_t& index) const { return this->isArray() && index < this->size(); }
+
+    String keyAt(const size_t& index) const;
+    TapeValue valueAt(const size_t& index) const;
+
+    Value toValue() const;
+
+private:
+    TapeValue find(const char* key, const size_t& length) const;
+    size_t find_index(const char* key, const size_t& length) const;
+    Value scalar() const;
+
+private:
+    const Tape* tape_;
+    size_t index_;
+}; // TapeValue class
+
+/**
+ * Immutable document stored in one contiguous array of 64 bit tape entries.
+ * Each entry holds a tag in the upper 8 bits and a payload in the lower 56 bits.
+ * Strings are stored in a separate buffer, containers record the index after their
+ * last child, so skipping a container is O(1).
+ */
+class Tape {
+public:
+    inline Tape() {}
+    inline ~Tape() {}
+
+public:
+    template<typename Iter> bool parse(const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+    bool parse(const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+    inline TapeValue root() const { return tape_.empty() ? TapeValue() : TapeValue(this, 0); }
+    inline size_t size() const { return tape_.size(); }
+    inline void clear() { tape_.clear(); strings_.clear(); }
+
+public:
+    enum Tag {
+        kTagNull    = 'n',
+        kTagTrue    = 't',
+        kTagFalse   = 'f',
+        kTagInteger = 'l',
+        kTagFloat   = 'd',
+        kTagString  = '"',
+        kTagArray   = '[',
+        kTagObject  = '{'
+    }; // Tag enum
+
+    static const uint64_t kPayloadMask = 0x00ffffffffffffffULL;
+    static const uint64_t kEndMask = 0x00000000ffffffffULL;
+    static const uint64_t kCountMax = 0x0000000000ffffffULL;
+
+    inline Tag tag(const size_t& index) const { return static_cast<Tag>(tape_[index] >> 56); }
+    inline uint64_t payload(const size_t& index) const { return tape_[index] & kPayloadMask; }
+    inline uint64_t word(const size_t& index) const { return tape_[index]; }
+    inline const char* string(const size_t& index) const { return &strings_[static_cast<size_t>(this->payload(index)) + sizeof(uint32_t)]; }
+    inline uint32_t stringLength(const size_t& index) const {
+        uint32_t length = 0; memcpy(&length, &strings_[static_cast<size_t>(this->payload(index))], sizeof(length)); return length;
+    }
+    inline size_t next(const size_t& index) const {
+        switch (this->tag(index)) {
+        case kTagInteger:
+        case kTagFloat:
+            return index + 2;
+        case kTagArray:
+        case kTagObject:
+            return static_cast<size_t>(this->payload(index) & kEndMask);
+        default: break;
+        }
+        return index + 1;
+    }
+
+private:
+    friend class TapeBuilder;
+
+    std::vector<uint64_t> tape_;
+    String strings_;
+}; // Tape class
+
+template<typename Iter> inline bool parse(Tape& tape, const Iter& begin, const Iter& end, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+inline bool parse(Tape& tape, const String& str, const ParseOption& options = kParseOptionNone, String* errorMessage = 0);
+
+
+/*-----------------------------------------------------------
+ * Inline implementation.
+ *-----------------------------------------------------------*/
+/**
+ * Parse handler which appends parse events to a tape.
+ */
+class TapeBuilder: public AbstractParseHandler {
+public:
+    inline TapeBuilder(Tape& tape): tape_(tape.tape_), strings_(tape.strings_) {}
+    inline ~TapeBuilder() {}
+
+public:
+    inline virtual bool onNull() { this->append(Tape::kTagNull, 0); return true; }
+    inline virtual bool onBoolean(const bool& v) { this->append(v ? Tape::kTagTrue : Tape::kTagFalse, 0); return true; }
+    inline virtual bool onInteger(const int64_t& v) {
+        this->append(Tape::kTagInteger, 0);
+        tape_.push_back(static_cast<uint64_t>(v));
+        return true;
+    }
+    inline virtual bool onUInteger(const uint64_t& v) {
+        this->append(Tape::kTagInteger, 1);
+        tape_.push_back(v);
+        return true;
+    }
+    inline virtual bool onFloat(const double& v) {
+        uint64_t u = 0;
+        memcpy(&u, &v, sizeof(u));
+        this->append(Tape::kTagFloat, 0);
+        tape_.push_back(u);
+        return true;
+    }
+    inline virtual bool onString(const String& v) { this->append_string(v); return true; }
+    inline virtual bool beginArray() { return this->begin(Tape::kTagArray); }
+    inline virtual bool endArray(const size_t& count) { return this->end(Tape::kTagArray, count); }
+    inline virtual bool beginObject() { return this->begin(Tape::kTagObject); }
+    inline virtual bool onObjectKey(const String& key) { this->append_string(key); return true; }
+    inline virtual bool endObject(const size_t& count) { return this->end(Tape::kTagObject, count); }
+
+private:
+    inline void append(const Tape::Tag& tag, const uint64_t& payload) {
+        tape_.push_back((static_cast<uint64_t>(tag) << 56) | (payload & Tape::kPayloadMask));
+    }
+    inline void append_string(const String& str) {
+        const uint32_t length = static_cast<uint32_t>(str.size());
+        this->append(Tape::kTagString, strings_.size());
+        strings_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        strings_.append(str.c_str(), str.size() + 1);
+    }
+    inline bool begin(const Tape::Tag& tag) {
+        stack_.push_back(tape_.size());
+        this->append(tag, 0);
+        return true;
+    }
+    inline bool end(const Tape::Tag& tag, const size_t& count) {
+        const size_t start = stack_.back();
+        stack_.pop_back();
+        const uint64_t c = count < Tape::kCountMax ? count : Tape::kCountMax;
+        tape_[start] = (static_cast<uint64_t>(tag) << 56) | (c << 32) | static_cast<uint64_t>(tape_.size());
+        return true;
+    }
+
+private:
+    std::vector<uint64_t>& tape_;
+    String& strings_;
+    std::vector<size_t> stack_;
+}; // TapeBuilder class
+
+template<typename Iter> inline bool parse(Tape& tape, const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    return tape.parse(begin, end, options, errorMessage);
+}
+inline bool parse(Tape& tape, const String& str, const ParseOption& options, String* errorMessage) {
+    return tape.parse(str.begin(), str.end(), options, errorMessage);
+}
+
+/**
+ * Tape class implementation.
+ */
+template<typename Iter> inline bool Tape::parse(const Iter& begin, const Iter& end, const ParseOption& options, String* errorMessage) {
+    this->clear();
+    TapeBuilder builder(*this);
+    Parser parser;
+    if (!parser.parse(&builder, begin, end, options, errorMessage)) {
+        this->clear();
+        return false;
+    }
+    return true;
+}
+inline bool Tape::parse(const String& str, const ParseOption& options, String* errorMessage) {
+    return this->parse(str.begin(), str.end(), options, errorMessage);
+}
+
+/**
+ * TapeValue class implementation.
+ */
+inline TapeValue TapeValue::operator [](const size_t& index) const {
+    if (!this->isArray()) { return TapeValue(); }
+    const size_t end = tape_->next(index_);
+    size_t i = index_ + 1;
+    for (size_t n = 0; i < end && n < index; ++n) {
+        i = tape_->next(i);
+    }
+    return i < end ? TapeValue(tape_, i) : TapeValue();
+}
+
+inline Type TapeValue::type() const {
+    if (!tape_) { return kNull; }
+    switch (tape_->tag(index_)) {
+    case Tape::kTagTrue:
+    case Tape::kTagFalse:
+        return kBoolean;
+    case Tape::kTagInteger: return kInteger;
+    case Tape::kTagFloat: return kFloat;
+    case Tape::kTagString: return kString;
+    case Tape::kTagArray: return kArray;
+    case Tape::kTagObject: return kObject;
+    default: break;
+    }
+    return kNull;
+}
+
+inline String TapeValue::toString(const String& defaults) const {
+    if (this->isString()) {
+        return String(tape_->string(index_), tape_->stringLength(index_));
+    }
+    return this->scalar().toString(defaults);
+}
+inline const char* TapeValue::c_str() const {
+    return this->isString() ? tape_->string(index_) : "";
+}
+inline size_t TapeValue::size() const {
+    switch (this->type()) {
+    case kString: return tape_->stringLength(index_);
+    case kArray:
+    case kObject: {
+        const size_t count = static_cast<size_t>(tape_->payload(index_) >> 32);
+        if (count < Tape::kCountMax) { return count; }
+        // Saturated count, walk the children.
+        const size_t end = tape_->next(index_);
+        const size_t step = this->isObject() ? 2 : 1;
+        size_t n = 0;
+        for (size_t i = index_ + 1; i < end; ++n) {
+            for (size_t s = 0; s < step; ++s) { i = tape_->next(i); }
+        }
+        return n;
+    }
+    default: break;
+    }
+    return 0;
+}
+
+inline String TapeValue::keyAt(const size_t& index) const {
+    if (!this->isObject()) { return String(); }
+    const size_t end = tape_->next(index_);
+    size_t i = index_ + 1;
+    for (size_t n = 0; i < end && n < index; ++n) {
+        i = tape_->next(i + 1);
+    }
+    return i < end ? TapeValue(tape_, i).toString() : String();
+}
+inline TapeValue TapeValue::valueAt(const size_t& index) const {
+    if (!this->isObject()) { return (*this)[index]; }
+    const size_t end = tape_->next(index_);
+    size_t i = index_ + 1;
+    for (size_t n = 0; i < end && n < index; ++n) {
+        i = tape_->next(i + 1);
+    }
+    return i < end ? TapeValue(tape_, i + 1) : TapeValue();
+}
+
+inline Value TapeValue::toValue() const {
+    switch (this->type()) {
+    case kArray: {
+        Value value(kArray);
+        Array& array = value.as<Array>();
+        const size_t end = tape_->next(index_);
+        for (size_t i = index_ + 1; i < end; i = tape_->next(i)) {
+            array.push_back(TapeValue(tape_, i).toValue());
+        }
+        return value;
+    }
+    case kObject: {
+        Value value(kObject);
+        Object& object = value.as<Object>();
+        const size_t end = tape_->next(index_);
+        for (size_t i = index_ + 1; i < end; i = tape_->next(i + 1)) {
+            object.insert(std::make_pair(TapeValue(tape_, i).toString(), TapeValue(tape_, i + 1).toValue()));
+        }
+        return value;
+    }
+    default: break;
+    }
+    return this->scalar();
+}
+
+inline TapeValue TapeValue::find(const char* key, const size_t& length) const {
+    const size_t index = this->find_index(key, length);
+    return index != 0 ? TapeValue(tape_, index) : TapeValue();
+}
+inline size_t TapeValue::find_index(const char* key, const size_t& length) const {
+    if (!this->isObject()) { return 0; }
+    const size_t end = tape_->next(index_);
+    for (size_t i = index_ + 1; i < end; i = tape_->next(i + 1)) {
+        if (tape_->stringLength(i) == length && memcmp(tape_->string(i), key, length) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+inline Value TapeValue::scalar() const {
+    if (!tape_) { return Value(); }
+    switch (tape_->tag(index_)) {
+    case Tape::kTagTrue: return Value(true);
+    case Tape::kTagFalse: return Value(false);
+    case Tape::kTagInteger: {
+        // Payload 1 marks an integer above INT64_MAX.
+        const uint64_t u = tape_->word(index_ + 1);
+        return tape_->payload(index_) ? Value(static_cast<unsigned long long>(u)) : Value(static_cast<long long>(u));
+    }
+    case Tape::kTagFloat: {
+        const uint64_t u = tape_->word(index_ + 1);
+        double d = 0.0;
+        memcpy(&d, &u, sizeof(d));
+        return Value(d);
+    }
+    case Tape::kTagString: return Value(String(tape_->string(index_), tape_->stringLength(index_)));
+    default: break;
+    }
+    return Value();
+}
+
+} // namespace pocketjson
+
+#endif // POCKETJSON_TAPE_H
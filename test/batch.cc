@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <pocketjson/batch.h>
+
+namespace {
+/**
+ * Batch handler writing events in a compact text form.
+ */
+class Recorder {
+public:
+    Recorder(): batches(0), action(pocketjson::kBatchContinue) {}
+    pocketjson::BatchAction onBatch(const pocketjson::EventBatch& batch) {
+        ++batches;
+        for (const pocketjson::Event* e = batch.begin(); e != batch.end(); ++e) {
+            switch (e->type) {
+            case pocketjson::kEventNull: events += "n"; break;
+            case pocketjson::kEventBoolean: events += e->boolean ? "t" : "f"; break;
+            case pocketjson::kEventInteger: events += "i" + pocketjson::Serializer::int64ToString(e->integer); break;
+            case pocketjson::kEventUInteger: events += "u" + pocketjson::Serializer::uint64ToString(e->uinteger); break;
+            case pocketjson::kEventFloat: events += e->number == 1.5 ? "d" : "?"; break;
+            case pocketjson::kEventString: events += "s" + batch.toString(*e); break;
+            case pocketjson::kEventObjectKey: events += "k" + std::string(batch.string(*e), e->length); break;
+            case pocketjson::kEventBeginArray: events += "["; break;
+            case pocketjson::kEventEndArray: events += "]" + pocketjson::Serializer::int64ToString(e->length); break;
+            case pocketjson::kEventBeginObject: events += "{"; break;
+            case pocketjson::kEventEndObject: events += "}" + pocketjson::Serializer::int64ToString(e->length); break;
+            }
+        }
+        events += "|";
+        return action;
+    }
+    size_t batches;
+    pocketjson::BatchAction action;
+    std::string events;
+};
+} // namespace
+
+TEST(Batch, TestEvents) {
+    EXPECT_EQ(16u, sizeof(pocketjson::Event));
+    const std::string json = "{\"a\": [1, -2, 1.5, true, false, null, \"x\"], \"b\": 18446744073709551615}";
+    pocketjson::BatchParser parser;
+    Recorder recorder;
+    ASSERT_TRUE(parser.parse(&recorder, json));
+    EXPECT_EQ("{ka[i1i-2dtfnsx]7kbu18446744073709551615}2|", recorder.events);
+    EXPECT_EQ(1u, recorder.batches);
+
+    pocketjson::BatchParser small(4);
+    Recorder batched;
+    ASSERT_TRUE(small.parse(&batched, json));
+    EXPECT_EQ("{ka[i1|i-2dtf|nsx]7kb|u18446744073709551615}2|", batched.events);
+    EXPECT_EQ(4u, batched.batches);
+}
+TEST(Batch, TestStop) {
+    pocketjson::BatchParser parser(2);
+    Recorder recorder;
+    recorder.action = pocketjson::kBatchStop;
+    EXPECT_FALSE(parser.parse(&recorder, std::string("[1, 2, 3, 4]")));
+    EXPECT_EQ(pocketjson::kErrorHandlerCancel, parser.error().code);
+    EXPECT_EQ("[i1|", recorder.events);
+
+    // Stopping after the last batch is not an error.
+    Recorder last;
+    last.action = pocketjson::kBatchStop;
+    EXPECT_TRUE(parser.parse(&last, std::string("1")));
+    EXPECT_EQ("i1|", last.events);
+
+    Recorder invalid;
+    EXPECT_FALSE(parser.parse(&invalid, std::string("[1, 2, 3,]")));
+    EXPECT_EQ(pocketjson::kErrorArrayTrailingComma, parser.error().code);
+}
+TEST(Batch, TestSkip) {
+    pocketjson::BatchParser parser(3);
+    Recorder recorder;
+    recorder.action = pocketjson::kBatchSkip;
+    // The first batch ends inside "a", so the rest of "a" is skipped up to its end event.
+    // The second one ends inside the root object, so "c" is skipped.
+    ASSERT_TRUE(parser.parse(&recorder, std::string("{\"a\": [1, [2, 3], {\"x\": 4}], \"b\": 5, \"c\": [6, 7]}")));
+    EXPECT_EQ("{ka[|]3kbi5|}3|", recorder.events);
+}
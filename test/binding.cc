@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <pocketjson/binding.h>
+
+namespace {
+struct Address {
+    std::string city;
+    int zip;
+};
+struct User {
+    User(): id(0), active(false), score(0.0) {}
+    int64_t id;
+    std::string name;
+    bool active;
+    double score;
+    std::vector<std::string> tags;
+    std::map<std::string, int> counts;
+    Address address;
+    std::vector<Address> history;
+    pocketjson::Value extra;
+};
+} // namespace
+
+POCKETJSON_BIND(Address, city, zip)
+POCKETJSON_BIND(User, id, name, active, score, tags, counts, address, history, extra)
+
+TEST(Binding, TestDecode) {
+    const std::string json =
+        "{\"id\": 12, \"name\": \"alice\", \"active\": true, \"score\": 1.5,"
+        " \"tags\": [\"a\", \"b\"], \"counts\": {\"x\": 1, \"y\": 2},"
+        " \"unknown\": {\"skip\": [1, 2, {\"me\": null}]},"
+        " \"address\": {\"city\": \"Tokyo\", \"zip\": 100},"
+        " \"history\": [{\"city\": \"Osaka\", \"zip\": 530}], \"extra\": [null, 1]}";
+    User user;
+    std::string error;
+    ASSERT_TRUE(pocketjson::decode(user, json, pocketjson::kParseOptionNone, &error)) << error;
+    EXPECT_EQ(12, user.id);
+    EXPECT_STREQ("alice", user.name.c_str());
+    EXPECT_TRUE(user.active);
+    EXPECT_DOUBLE_EQ(1.5, user.score);
+    ASSERT_EQ(2, user.tags.size());
+    EXPECT_STREQ("b", user.tags[1].c_str());
+    EXPECT_EQ(2, user.counts["y"]);
+    EXPECT_STREQ("Tokyo", user.address.city.c_str());
+    EXPECT_EQ(100, user.address.zip);
+    ASSERT_EQ(1, user.history.size());
+    EXPECT_EQ(530, user.history[0].zip);
+    EXPECT_STREQ("[null,1]", user.extra.serialize().c_str());
+}
+TEST(Binding, TestMissingKey) {
+    User user;
+    user.name = "keep";
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"id\": 3}")));
+    EXPECT_EQ(3, user.id);
+    EXPECT_STREQ("keep", user.name.c_str());
+}
+TEST(Binding, TestVector) {
+    std::vector<Address> list;
+    EXPECT_TRUE(pocketjson::decode(list, std::string("[{\"city\": \"a\"}, {\"zip\": 1},]"), pocketjson::kParseOptionAllowCommaEnding));
+    ASSERT_EQ(2, list.size());
+    EXPECT_STREQ("a", list[0].city.c_str());
+}
+TEST(Binding, TestVectorBool) {
+    std::vector<bool> flags(1, true);
+    EXPECT_TRUE(pocketjson::decode(flags, std::string("[false, true, true]")));
+    ASSERT_EQ(3, flags.size());
+    EXPECT_FALSE(flags[0]);
+    EXPECT_TRUE(flags[2]);
+    EXPECT_STREQ("[false,true,true]", pocketjson::encode(flags).c_str());
+    EXPECT_FALSE(pocketjson::decode(flags, std::string("[true, 1]")));
+}
+#if __cplusplus >= 201703L
+TEST(Binding, TestOptional) {
+    std::map<std::string, std::optional<int> > values;
+    EXPECT_TRUE(pocketjson::decode(values, std::string("{\"a\": null, \"b\": 2}")));
+    EXPECT_FALSE(values["a"].has_value());
+    EXPECT_EQ(2, *values["b"]);
+}
+#endif
+TEST(Binding, TestFail) {
+    User user;
+    std::string error;
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"id\": \"12\"}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Number value is expected.", error.c_str());
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"id\": 1.5}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Integer value is expected.", error.c_str());
+    Address address;
+    EXPECT_FALSE(pocketjson::decode(address, std::string("{\"zip\": 99999999999}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Integer value is out of range.", error.c_str());
+    EXPECT_FALSE(pocketjson::decode(address, std::string("{\"zip\": 1} x"), pocketjson::kParseOptionNone, &error));
+    EXPECT_FALSE(pocketjson::decode(address, std::string("{\"zip\": 1"), pocketjson::kParseOptionNone, &error));
+    EXPECT_TRUE(pocketjson::decode(address, std::string("{\"city\": \"\xff\"}")));
+    EXPECT_FALSE(pocketjson::decode(address, std::string("{\"city\": \"\xff\"}"), pocketjson::kParseOptionValidateUtf8, &error));
+    EXPECT_STREQ("Invalid UTF-8 sequence is found while parsing string.", error.c_str());
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"extra\": [\"\xc0\x80\"]}"), pocketjson::kParseOptionValidateUtf8));
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"id\": 9223372036854775808}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Integer value is out of range.", error.c_str());
+}
+TEST(Binding, TestNestedOptions) {
+    // Value members are parsed with the options given to decode.
+    User user;
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"extra\": [1,]}")));
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"extra\": [1,]}"), pocketjson::kParseOptionAllowCommaEnding));
+    EXPECT_STREQ("[1]", user.extra.serialize().c_str());
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"extra\": \"\xff\"}")));
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"extra\": \"\xff\"}"), pocketjson::kParseOptionValidateUtf8));
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"extra\": [1.10, 2.5e3]}"), pocketjson::kParseOptionRawNumber));
+    EXPECT_STREQ("[1.10,2.5e3]", user.extra.serialize().c_str());
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"extra\": [1.10]}")));
+    EXPECT_STRNE("[1.10]", user.extra.serialize().c_str());
+    const pocketjson::Array* array = &user.extra.as<pocketjson::Array>();
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"extra\": [2, 3]}"), pocketjson::kParseOptionReuseValue));
+    EXPECT_EQ(array, &user.extra.as<pocketjson::Array>());
+    EXPECT_STREQ("[2,3]", user.extra.serialize().c_str());
+    // Gabage is only allowed after the whole input.
+    EXPECT_TRUE(pocketjson::decode(user, std::string("{\"extra\": 1} x"), pocketjson::kParseOptionAllowGabage));
+    EXPECT_FALSE(pocketjson::decode(user, std::string("{\"extra\": 1 x}"), pocketjson::kParseOptionAllowGabage));
+}
+TEST(Binding, TestUnsigned) {
+    uint64_t u = 0;
+    EXPECT_TRUE(pocketjson::decode(u, std::string("18446744073709551615")));
+    EXPECT_EQ(18446744073709551615ULL, u);
+    EXPECT_TRUE(pocketjson::decode(u, std::string("0")));
+    EXPECT_EQ(0u, u);
+    EXPECT_FALSE(pocketjson::decode(u, std::string("-1")));
+    unsigned int ui = 0;
+    EXPECT_FALSE(pocketjson::decode(ui, std::string("4294967296")));
+}
+TEST(Binding, TestEncode) {
+    User user;
+    user.id = -9223372036854775807LL - 1;
+    user.name = "a\"b";
+    user.active = true;
+    user.score = 0.5;
+    user.tags.push_back("x");
+    user.counts["k"] = 1;
+    user.address.city = "Tokyo";
+    user.address.zip = 100;
+    user.extra["v"] = true;
+    EXPECT_STREQ(
+        "{\"id\":-9223372036854775808,\"name\":\"a\\\"b\",\"active\":true,\"score\":0.5,"
+        "\"tags\":[\"x\"],\"counts\":{\"k\":1},\"address\":{\"city\":\"Tokyo\",\"zip\":100},"
+        "\"history\":[],\"extra\":{\"v\":true}}",
+        pocketjson::encode(user).c_str());
+
+    user.id = -12;
+    User decoded;
+    EXPECT_TRUE(pocketjson::decode(decoded, pocketjson::encode(user)));
+    EXPECT_STREQ(pocketjson::encode(user).c_str(), pocketjson::encode(decoded).c_str());
+}
+TEST(Binding, TestEncodePretty) {
+    std::vector<Address> list(1);
+    list[0].city = "Osaka";
+    list[0].zip = 530;
+    const std::string expected = pocketjson::parse("[{\"city\": \"Osaka\", \"zip\": 530}]").serialize(pocketjson::kSerializeOptionPretty4Spaces);
+    EXPECT_STREQ(expected.c_str(), pocketjson::encode(list, pocketjson::kSerializeOptionPretty4Spaces).c_str());
+
+    std::string out;
+    std::vector<double> nan(1, NAN);
+    std::string error;
+    EXPECT_FALSE(pocketjson::encode(out, nan, pocketjson::kSerializeOptionNone, &error));
+    EXPECT_STREQ("Floating point is nan or inf.", error.c_str());
+}
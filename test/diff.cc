@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <pocketjson/diff.h>
+#include <pocketjson/patch.h>
+#include <limits>
+
+namespace {
+/**
+ * Diff from into to, check that the patch turns from into to and return the patch.
+ */
+std::string diffed(const char* from, const char* to) {
+    const pocketjson::Value source = pocketjson::parse(from);
+    const pocketjson::Value target = pocketjson::parse(to);
+    const pocketjson::Value patch = pocketjson::diff(source, target);
+    pocketjson::Value v = source;
+    EXPECT_TRUE(pocketjson::patch(v, patch)) << patch.serialize();
+    EXPECT_TRUE(v == target) << patch.serialize();
+    return patch.serialize();
+}
+} // namespace
+
+TEST(Diff, TestShares) {
+    pocketjson::Value a = pocketjson::parse("{\"list\": [1, 2]}");
+    a["list"].push_back(std::numeric_limits<double>::quiet_NaN());
+    const pocketjson::Value b = a;
+    EXPECT_TRUE(a.shares(b));
+    // Shared containers are equal without comparing, even when they hold NaN.
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a["list"][2] == b["list"][2]);
+
+    const pocketjson::Value c = pocketjson::parse("{\"list\": [1, 2]}");
+    EXPECT_FALSE(a.shares(c));
+    EXPECT_FALSE(pocketjson::Value(1).shares(pocketjson::Value(1)));
+    EXPECT_FALSE(pocketjson::Value().shares(pocketjson::Value()));
+}
+TEST(Diff, TestObject) {
+    EXPECT_EQ("[]", diffed("{\"a\": 1, \"b\": [1, 2]}", "{\"b\": [1, 2], \"a\": 1}"));
+    EXPECT_EQ("[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"add\",\"path\":\"/c\",\"value\":{\"d\":true}}]",
+        diffed("{\"a\": 1, \"b\": 2}", "{\"b\": 2, \"c\": {\"d\": true}}"));
+    EXPECT_EQ("[{\"op\":\"replace\",\"path\":\"/a/b~1c/~0\",\"value\":\"x\"}]", diffed("{\"a\": {\"b/c\": {\"~\": 1}}}", "{\"a\": {\"b/c\": {\"~\": \"x\"}}}"));
+    EXPECT_EQ("[{\"op\":\"replace\",\"path\":\"\",\"value\":[1]}]", diffed("{\"a\": 1}", "[1]"));
+    EXPECT_EQ("[{\"op\":\"replace\",\"path\":\"/a\",\"value\":1}]", diffed("{\"a\": 1}", "{\"a\": 1.0}"));
+}
+TEST(Diff, TestArray) {
+    EXPECT_EQ("[{\"op\":\"add\",\"path\":\"/2\",\"value\":9}]", diffed("[1, 2, 3, 4]", "[1, 2, 9, 3, 4]"));
+    EXPECT_EQ("[{\"op\":\"remove\",\"path\":\"/1\"},{\"op\":\"remove\",\"path\":\"/1\"}]", diffed("[1, 2, 3, 4]", "[1, 4]"));
+    EXPECT_EQ("[{\"op\":\"replace\",\"path\":\"/1/a\",\"value\":3}]", diffed("[0, {\"a\": 1}, 5]", "[0, {\"a\": 3}, 5]"));
+    EXPECT_EQ("[{\"op\":\"replace\",\"path\":\"/0\",\"value\":5},{\"op\":\"add\",\"path\":\"/1\",\"value\":6}]", diffed("[1, 2]", "[5, 6, 2]"));
+    EXPECT_EQ("[{\"op\":\"add\",\"path\":\"/0\",\"value\":1},{\"op\":\"add\",\"path\":\"/1\",\"value\":2}]", diffed("[]", "[1, 2]"));
+    diffed("[1, 1, 1]", "[1, 1]");
+    diffed("[[1, 2], [3], 4]", "[[1], [3, 5], 4, 4]");
+}
+TEST(Diff, TestUpdated) {
+    const pocketjson::Value v1 = pocketjson::parse("{\"users\": [{\"name\": \"a\"}, {\"name\": \"b\"}], \"meta\": {\"n\": 2}}");
+    const pocketjson::Value v2 = v1.updated(pocketjson::Path().key("users").index(1).key("name"), pocketjson::Value("c"));
+    const pocketjson::Value patch = pocketjson::diff(v1, v2);
+    EXPECT_EQ("[{\"op\":\"replace\",\"path\":\"/users/1/name\",\"value\":\"c\"}]", patch.serialize());
+
+    pocketjson::Differ differ;
+    pocketjson::Value reused;
+    differ.diff(v2, v1, reused);
+    differ.diff(v1, v1, reused);
+    EXPECT_EQ("[]", reused.serialize());
+}
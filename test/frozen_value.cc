@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+#include <thread>
+#include <vector>
+
+TEST(FrozenValue, TestFreeze) {
+    pocketjson::Value v = pocketjson::parse("{\"name\": \"pocketjson\", \"list\": [1, 2, 3], \"nest\": {\"a\": true}}");
+    const pocketjson::FrozenValue frozen = v.freeze();
+    v["name"] = "changed";
+    v["list"].push_back(4);
+    EXPECT_STREQ("pocketjson", frozen["name"].toString().c_str());
+    EXPECT_EQ(3, frozen["list"].size());
+    EXPECT_TRUE(frozen["nest"]["a"].toBoolean());
+    EXPECT_TRUE(frozen["missing"].isNull());
+    EXPECT_TRUE((*frozen).isObject());
+    EXPECT_TRUE(pocketjson::FrozenValue().view().isNull());
+}
+TEST(FrozenValue, TestIterate) {
+    const pocketjson::FrozenValue frozen(pocketjson::parse("{\"a\": [1, 2], \"b\": 3}"));
+    std::string keys;
+    for (pocketjson::FrozenView::const_iterator itr = frozen.view().begin(); itr != frozen.view().end(); ++itr) {
+        keys += itr.key();
+    }
+    EXPECT_STREQ("ab", keys.c_str());
+    int sum = 0;
+    const pocketjson::FrozenView list = frozen["a"];
+    for (pocketjson::FrozenView::const_iterator itr = list.begin(); itr != list.end(); ++itr) {
+        sum += itr.value().toInt();
+    }
+    EXPECT_EQ(3, sum);
+    EXPECT_TRUE(frozen["b"].begin() == frozen["b"].end());
+}
+TEST(FrozenValue, TestToValue) {
+    const pocketjson::FrozenValue frozen(pocketjson::parse("{\"a\": [1, {\"b\": \"c\"}]}"));
+    pocketjson::Value copy = frozen.view().toValue();
+    EXPECT_TRUE(copy == frozen.view().toValue());
+    copy["a"][1]["b"] = "d";
+    EXPECT_STREQ("c", frozen["a"][1]["b"].toString().c_str());
+}
+TEST(FrozenValue, TestThreads) {
+    pocketjson::Value v;
+    for (int i = 0; i < 100; ++i) {
+        v["list"].push_back(i);
+    }
+    const pocketjson::FrozenValue frozen = v.freeze();
+    std::vector<int> sums(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < sums.size(); ++t) {
+        threads.push_back(std::thread([frozen, &sums, t]() {
+            const pocketjson::FrozenView list = frozen["list"];
+            for (size_t i = 0; i < list.size(); ++i) {
+                sums[t] += list[i].toInt();
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    for (size_t t = 0; t < sums.size(); ++t) {
+        EXPECT_EQ(4950, sums[t]);
+    }
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+#include <pocketjson/dedup.h>
+
+TEST(Hash, TestEqual) {
+    const char* json = "{\"a\": [1, 2.5, \"x\", null, true, {\"b\": -0.0}], \"c\": 18446744073709551615}";
+    const pocketjson::Value a = pocketjson::parse(json);
+    const pocketjson::Value b = pocketjson::parse(json);
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_EQ(a.hash(), pocketjson::parse(json, pocketjson::kParseOptionRawNumber).hash());
+    EXPECT_EQ(pocketjson::Value(0.0).hash(), pocketjson::Value(-0.0).hash());
+    EXPECT_EQ(pocketjson::ValueHash()(a), a.hash());
+
+    EXPECT_NE(pocketjson::Value(1).hash(), pocketjson::Value(1.0).hash());
+    EXPECT_NE(pocketjson::Value("1").hash(), pocketjson::Value(1).hash());
+    EXPECT_NE(pocketjson::parse("[1, 2]").hash(), pocketjson::parse("[2, 1]").hash());
+    EXPECT_NE(pocketjson::parse("{\"a\": 1}").hash(), pocketjson::parse("{\"a\": 2}").hash());
+    EXPECT_NE(pocketjson::parse("{\"a\": 1}").hash(), pocketjson::parse("{\"b\": 1}").hash());
+    EXPECT_NE(pocketjson::parse("[[]]").hash(), pocketjson::parse("[]").hash());
+}
+TEST(Hash, TestUpdate) {
+    pocketjson::Value v = pocketjson::parse("{\"a\": {\"b\": [1, 2]}}");
+    const size_t before = v.hash();
+    const pocketjson::Value copy = v;
+    v["a"]["b"].push_back(3);
+    EXPECT_NE(before, v.hash());
+    EXPECT_EQ(before, copy.hash());
+    EXPECT_EQ(pocketjson::parse("{\"a\": {\"b\": [1, 2, 3]}}").hash(), v.hash());
+    v.erase(pocketjson::Path().key("a").key("b").index(2));
+    EXPECT_EQ(before, v.hash());
+
+    // A child modified through a reference taken before hash() changes the hash.
+    pocketjson::Value& b = v["a"]["b"];
+    EXPECT_EQ(before, v.hash());
+    b.push_back(4);
+    EXPECT_EQ(pocketjson::parse("{\"a\": {\"b\": [1, 2, 4]}}").hash(), v.hash());
+}
+TEST(Deduplicate, TestMerge) {
+    pocketjson::Value v = pocketjson::parse("{\"items\": ["
+        "{\"user\": {\"id\": 1, \"name\": \"alice\"}, \"tags\": [\"a\", \"b\"]},"
+        "{\"user\": {\"id\": 1, \"name\": \"alice\"}, \"tags\": [\"a\", \"b\"]},"
+        "{\"user\": {\"id\": 2, \"name\": \"alice\"}, \"tags\": [\"a\"]}]}");
+    const pocketjson::Value original = pocketjson::parse(v.serialize());
+    // The second item and the strings "alice" and "a" of the third item are merged.
+    EXPECT_EQ(3u, pocketjson::deduplicate(v));
+    EXPECT_TRUE(v == original);
+    const pocketjson::Value& items = v["items"];
+    EXPECT_TRUE(items[0].shares(items[1]));
+    EXPECT_TRUE(items[0]["user"]["name"].shares(items[2]["user"]["name"]));
+    EXPECT_FALSE(items[0]["user"].shares(items[2]["user"]));
+
+    // Merged values are copied on write.
+    v["items"][1]["user"]["name"] = "bob";
+    EXPECT_EQ("alice", v["items"][0]["user"]["name"].toString());
+    EXPECT_EQ("bob", v["items"][1]["user"]["name"].toString());
+}
+TEST(Deduplicate, TestAcrossDocuments) {
+    pocketjson::Deduplicator deduplicator;
+    std::vector<pocketjson::Value> responses;
+    for (int i = 0; i < 100; ++i) {
+        responses.push_back(pocketjson::parse("{\"product\": {\"id\": 7, \"title\": \"book\"}, \"n\": " + pocketjson::Serializer::int64ToString(i) + "}"));
+        deduplicator.deduplicate(responses.back());
+    }
+    EXPECT_EQ(99u, deduplicator.merged());
+    EXPECT_TRUE(responses[0]["product"].shares(responses[99]["product"]));
+    deduplicator.clear();
+    EXPECT_EQ(0u, deduplicator.merged());
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+TEST(Key, TestLookup) {
+    pocketjson::Value v = pocketjson::parse("{\"name\": \"a\", \"id\": 1, \"a long key beyond small strings\": [true]}");
+    const pocketjson::Value& c = v;
+    const char* name = "name";
+    EXPECT_EQ("a", c["name"].toString());
+    EXPECT_EQ("a", c[name].toString());
+    EXPECT_EQ(1, c[pocketjson::Key("id")].toInt());
+    EXPECT_TRUE(c["a long key beyond small strings"][0].toBoolean());
+    EXPECT_TRUE(c["missing"].isNull());
+    EXPECT_TRUE(v.contains("id"));
+    EXPECT_TRUE(v.contains(pocketjson::Key(name)));
+    EXPECT_FALSE(v.contains("i"));
+    EXPECT_FALSE(v.contains(pocketjson::Key("idx")));
+    EXPECT_FALSE(pocketjson::Value(1).contains("id"));
+    EXPECT_TRUE(pocketjson::Value(1)["id"].isNull());
+    // Literal 0 is still the index.
+    EXPECT_TRUE(pocketjson::parse("[7]")[0] == pocketjson::Value(7));
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+    const std::string_view view("name, not a key", 4);
+    EXPECT_EQ("a", c[view].toString());
+    EXPECT_TRUE(v.contains(std::string_view("id")));
+#endif
+}
+TEST(Key, TestInsert) {
+    pocketjson::Value v;
+    const pocketjson::Key key("b");
+    v[key] = 2;
+    v["c"] = 3;
+    v[std::string("a")] = 1;
+    v[key] = 4;
+    const char* embedded = "d\0e";
+    v[pocketjson::Key(embedded, 3)] = 5;
+    EXPECT_EQ(std::string("{\"a\":1,\"b\":4,\"c\":3,\"d\\u0000e\":5}"), v.serialize());
+    EXPECT_EQ(4u, v.size());
+
+    // Insertion through a key copies on write.
+    const pocketjson::Value copy = v;
+    v["z"] = true;
+    EXPECT_FALSE(copy.contains("z"));
+    EXPECT_TRUE(v.contains("z"));
+}
+TEST(Key, TestOrder) {
+    const char* keys[] = { "", "a", "ab", "b", "\x7f", "\xc3\xa9", "\xff" };
+    const size_t n = sizeof(keys) / sizeof(keys[0]);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            const int expected = std::string(keys[i]).compare(keys[j]);
+            const int actual = pocketjson::Key(keys[i]).compare(keys[j]);
+            EXPECT_EQ(expected < 0, actual < 0) << i << " " << j;
+            EXPECT_EQ(expected == 0, actual == 0) << i << " " << j;
+        }
+    }
+    EXPECT_EQ(pocketjson::Key("name").hash(), pocketjson::Key(std::string("name")).hash());
+    EXPECT_NE(pocketjson::Key("name").hash(), pocketjson::Key("id").hash());
+    EXPECT_EQ(4u, pocketjson::Key("name").size());
+}
+TEST(Key, TestFrozen) {
+    const pocketjson::FrozenValue frozen = pocketjson::parse("{\"user\": {\"name\": \"a\"}}").freeze();
+    const pocketjson::Key user("user");
+    EXPECT_EQ("a", frozen[user]["name"].toString());
+    EXPECT_TRUE(frozen.view().contains(user));
+    EXPECT_FALSE(frozen["user"].contains("id"));
+}
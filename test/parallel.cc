@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <pocketjson/parallel.h>
+
+namespace {
+/**
+ * Records with strings holding quotes, escapes, commas and brackets, so a naive split would cut them.
+ */
+std::string records(const int& count) {
+    std::string json = "[";
+    for (int i = 0; i < count; ++i) {
+        if (i) { json += i % 3 ? "," : ",\n "; }
+        json += "{\"id\": " + pocketjson::Serializer::int64ToString(i);
+        json += R"(, "text": "a],[{\"b\\\", \\\"}, {")";
+        json += ", \"list\": [1.5, \"]\", [], {}, null, true], \"path\": \"c:\\\\\"}";
+    }
+    return json + "]";
+}
+class Recorder {
+public:
+    bool onNull() { events += "n"; return true; }
+    bool onBoolean(bool v) { events += v ? "t" : "f"; return true; }
+    bool onInteger(int64_t v) { events += "i" + pocketjson::Serializer::int64ToString(v); return true; }
+    bool onUInteger(uint64_t) { events += "u"; return true; }
+    bool onFloat(double) { events += "d"; return true; }
+    bool onString(const std::string& v) { events += "s" + v; return true; }
+    bool beginArray() { events += "["; return --limit != 0; }
+    bool endArray(size_t count) { events += "]" + pocketjson::Serializer::int64ToString(static_cast<int64_t>(count)); return true; }
+    bool beginObject() { events += "{"; return true; }
+    bool onObjectKey(const std::string& key) { events += "k" + key; return true; }
+    bool endObject(size_t count) { events += "}" + pocketjson::Serializer::int64ToString(static_cast<int64_t>(count)); return true; }
+    std::string events;
+    int limit = -1;
+};
+} // namespace
+
+TEST(Parallel, TestDom) {
+    const std::string json = records(200);
+    const pocketjson::Value expected = pocketjson::parse(json);
+    // Every chunk size moves the split points over every character of a record.
+    for (size_t size = 1; size < 300; size += 7) {
+        pocketjson::ParallelParser parser(4, size);
+        pocketjson::Value v;
+        ASSERT_TRUE(parser.parse(v, json)) << size;
+        EXPECT_EQ(4u, parser.chunks());
+        EXPECT_TRUE(v == expected) << size;
+    }
+    pocketjson::ParallelParser parser(3, 1);
+    pocketjson::Value v;
+    ASSERT_TRUE(parser.parse(v, "\xef\xbb\xbf [1, [2, 3], 4, \"5\", 6] \n", pocketjson::kParseOptionRawNumber));
+    EXPECT_EQ(3u, parser.chunks());
+    EXPECT_EQ("[1,[2,3],4,\"5\",6]", v.serialize());
+}
+TEST(Parallel, TestReuse) {
+    // Workers are kept between calls with different numbers of chunks.
+    pocketjson::ParallelParser parser(4, 1);
+    const size_t counts[] = { 2, 10, 3, 1, 4, 2 };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        const std::string json = records(static_cast<int>(counts[i]));
+        pocketjson::Value v;
+        ASSERT_TRUE(parser.parse(v, json)) << i;
+        EXPECT_EQ(counts[i] > 1, parser.chunks() > 1) << i;
+        EXPECT_TRUE(v == pocketjson::parse(json)) << i;
+
+        Recorder expected;
+        ASSERT_TRUE(pocketjson::parse(&expected, json));
+        std::vector<Recorder> handlers(i % 2 ? 2 : 4);
+        ASSERT_TRUE(parser.parse(handlers, json)) << i;
+        std::string events;
+        for (size_t k = 0; k < handlers.size(); ++k) { events += handlers[k].events; }
+        EXPECT_EQ(expected.events, events) << i;
+    }
+}
+TEST(Parallel, TestSequential) {
+    pocketjson::ParallelParser parser(4, 1);
+    pocketjson::Value v;
+    ASSERT_TRUE(parser.parse(v, "{\"a\": [1, 2, 3, 4, 5]}"));
+    EXPECT_EQ(1u, parser.chunks());
+    ASSERT_TRUE(parser.parse(v, "[[1, 2, 3, 4, 5]]"));
+    EXPECT_EQ(1u, parser.chunks());
+    EXPECT_EQ("[[1,2,3,4,5]]", v.serialize());
+    ASSERT_TRUE(parser.parse(v, "[1, 2, 3, 4, 5,]", pocketjson::kParseOptionAllowCommaEnding));
+    EXPECT_EQ(1u, parser.chunks());
+    EXPECT_EQ(5u, v.size());
+
+    pocketjson::ParallelParser large(4);
+    ASSERT_TRUE(large.parse(v, records(10)));
+    EXPECT_EQ(1u, large.chunks());
+    EXPECT_EQ(10u, v.size());
+}
+TEST(Parallel, TestError) {
+    const char* inputs[] = {
+        "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 1 8, 19, 20]",
+        "[1, 2, 3, 4, 5, 6, 7, 8,\n 9, 10, [11, 12, 13, 14, 15, 16, 17, 18, 19, 20]",
+        "[1, 2, 3, 4, 5, 6, 7, 8, 9, \"10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20]",
+        "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,]",
+        "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, x]"
+    };
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+        pocketjson::Parser sequential;
+        pocketjson::Value expected;
+        EXPECT_FALSE(sequential.parse(expected, inputs[i]));
+
+        pocketjson::ParallelParser parser(4, 4);
+        pocketjson::Value v;
+        std::string message;
+        EXPECT_FALSE(parser.parse(v, inputs[i], pocketjson::kParseOptionNone, &message)) << i;
+        EXPECT_EQ(sequential.error().code, parser.error().code) << i;
+        EXPECT_EQ(sequential.error().offset, parser.error().offset) << i;
+        EXPECT_EQ(sequential.error().message(), message) << i;
+
+        std::vector<Recorder> handlers(4);
+        EXPECT_FALSE(parser.parse(handlers, inputs[i])) << i;
+        EXPECT_EQ(sequential.error().toString(), parser.error().toString()) << i;
+    }
+}
+TEST(Parallel, TestHandler) {
+    const std::string json = records(50);
+    Recorder expected;
+    ASSERT_TRUE(pocketjson::parse(&expected, json));
+
+    pocketjson::ParallelParser parser(8, 100);
+    std::vector<Recorder> handlers(3);
+    ASSERT_TRUE(parser.parse(handlers, json));
+    EXPECT_EQ(3u, parser.chunks());
+    EXPECT_EQ(expected.events, handlers[0].events + handlers[1].events + handlers[2].events);
+
+    // A handler cancels its own chunk, and the error is located in the input.
+    const std::string lines = "[1, 2, 3,\n 4, 5, 6, [7], 8]";
+    pocketjson::Parser sequential;
+    Recorder first;
+    first.limit = 2;
+    EXPECT_FALSE(sequential.parse(&first, lines));
+
+    pocketjson::ParallelParser cancel(2, 4);
+    std::vector<Recorder> cancelled(2);
+    cancelled[1].limit = 1;
+    EXPECT_FALSE(cancel.parse(cancelled, lines));
+    EXPECT_EQ(2u, cancel.chunks());
+    EXPECT_EQ(pocketjson::kErrorHandlerCancel, cancel.error().code);
+    EXPECT_EQ(sequential.error().toString(), cancel.error().toString());
+}
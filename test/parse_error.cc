@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+TEST(ParseError, TestNone) {
+    pocketjson::Parser parser;
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, std::string("[1, 2]")));
+    EXPECT_EQ(pocketjson::kErrorNone, parser.error().code);
+    EXPECT_STREQ("", parser.error().message());
+    EXPECT_TRUE(parser.error().toString().empty());
+}
+TEST(ParseError, TestPosition) {
+    pocketjson::Parser parser;
+    pocketjson::Value v;
+    EXPECT_FALSE(parser.parse(v, std::string("{\n  \"a\": [1, 2],\n  \"b\": tru\n}")));
+    const pocketjson::ParseError& error = parser.error();
+    EXPECT_EQ(pocketjson::kErrorInvalidBoolean, error.code);
+    EXPECT_EQ(27, error.offset);
+    EXPECT_EQ(3, error.line);
+    EXPECT_EQ(11, error.column);
+    EXPECT_STREQ("Invalid boolean type string exists.", error.message());
+    EXPECT_STREQ("line 3, column 11: Invalid boolean type string exists.", error.toString().c_str());
+
+    // The previous error is cleared.
+    EXPECT_TRUE(parser.parse(v, std::string("1")));
+    EXPECT_EQ(pocketjson::kErrorNone, parser.error().code);
+
+    EXPECT_FALSE(parser.parse(v, std::string("\"a\nb\"x")));
+    EXPECT_EQ(pocketjson::kErrorGabage, parser.error().code);
+    EXPECT_EQ(5, parser.error().offset);
+    EXPECT_EQ(2, parser.error().line);
+    EXPECT_EQ(3, parser.error().column);
+}
+TEST(ParseError, TestCode) {
+    struct Case {
+        const char* json;
+        pocketjson::ErrorCode code;
+        size_t offset;
+    };
+    const Case cases[] = {
+        {"", pocketjson::kErrorUnexpectedCharacter, 0},
+        {"nul", pocketjson::kErrorInvalidNull, 3},
+        {"012", pocketjson::kErrorLeadingZero, 1},
+        {"-", pocketjson::kErrorMissingDigit, 1},
+        {"1.e", pocketjson::kErrorMissingFraction, 2},
+        {"1e+", pocketjson::kErrorMissingExponent, 3},
+        {"\"\\u12g4\"", pocketjson::kErrorInvalidHex, 5},
+        {"\"\\udc00\"", pocketjson::kErrorInvalidSurrogate, 6},
+        {"\"\\ud800\\u0041\"", pocketjson::kErrorInvalidSurrogate, 12},
+        {"\"\\x\"", pocketjson::kErrorInvalidEscape, 2},
+        {"\"abc", pocketjson::kErrorUnterminatedString, 4},
+        {"[1,]", pocketjson::kErrorArrayTrailingComma, 3},
+        {"[1 2]", pocketjson::kErrorArraySeparator, 3},
+        {"[1,", pocketjson::kErrorUnterminatedArray, 3},
+        {"{\"a\":1,}", pocketjson::kErrorObjectTrailingComma, 7},
+        {"{\"a\" 1}", pocketjson::kErrorObjectSeparator, 5},
+        {"{a}", pocketjson::kErrorObjectSeparator, 1},
+        {"{", pocketjson::kErrorUnterminatedObject, 1},
+        {"[] []", pocketjson::kErrorGabage, 3},
+    };
+    pocketjson::Parser parser;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        pocketjson::Value v;
+        EXPECT_FALSE(parser.parse(v, std::string(cases[i].json))) << cases[i].json;
+        EXPECT_EQ(cases[i].code, parser.error().code) << cases[i].json;
+        EXPECT_EQ(cases[i].offset, parser.error().offset) << cases[i].json;
+        EXPECT_FALSE(parser.parse(static_cast<pocketjson::AbstractParseHandler*>(0), std::string(cases[i].json))) << cases[i].json;
+        EXPECT_EQ(cases[i].code, parser.error().code) << cases[i].json;
+    }
+}
+TEST(ParseError, TestMessage) {
+    std::string error = "previous";
+    pocketjson::Value v;
+    EXPECT_FALSE(pocketjson::parse(v, std::string("[1,]"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Unexpected comma exists while parsing array.", error.c_str());
+    EXPECT_TRUE(pocketjson::parse(v, std::string("[1]"), pocketjson::kParseOptionNone, &error));
+    EXPECT_TRUE(error.empty());
+    EXPECT_STREQ("SAX handler cancels parsing.", pocketjson::ParseError::message(pocketjson::kErrorHandlerCancel));
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+#include <sstream>
+
+namespace {
+/**
+ * Handler without a base class, taking values by value.
+ */
+class Recorder {
+public:
+    bool onNull() { events += "n"; return true; }
+    bool onBoolean(bool v) { events += v ? "t" : "f"; return true; }
+    bool onInteger(int64_t v) { events += "i" + pocketjson::Serializer::int64ToString(v); return true; }
+    bool onUInteger(uint64_t v) { events += "u" + pocketjson::Serializer::uint64ToString(v); return true; }
+    bool onFloat(double) { events += "d"; return true; }
+    bool onString(const std::string& v) { events += "s" + v; return true; }
+    bool beginArray() { events += "["; return true; }
+    bool endArray(size_t count) { events += "]" + pocketjson::Serializer::int64ToString(static_cast<int64_t>(count)); return true; }
+    bool beginObject() { events += "{"; return true; }
+    bool onObjectKey(const std::string& key) { events += "k" + key; return true; }
+    bool endObject(size_t count) { events += "}" + pocketjson::Serializer::int64ToString(static_cast<int64_t>(count)); return true; }
+    std::string events;
+};
+/**
+ * Handler defining a few events on top of BaseParseHandler.
+ */
+class IntegerSum: public pocketjson::BaseParseHandler<IntegerSum> {
+public:
+    IntegerSum(): sum(0), floats(0), limit(1000) {}
+    bool onInteger(int64_t v) { sum += v; return sum < limit; }
+    bool onFloat(double) { ++floats; return true; }
+    int64_t sum;
+    int floats;
+    int64_t limit;
+};
+} // namespace
+
+TEST(ParseHandler, TestDuckTyped) {
+    Recorder recorder;
+    pocketjson::Parser parser;
+    ASSERT_TRUE(parser.parse(&recorder, std::string("{\"a\": [1, -2, 1.5, true, false, null, \"x\"], \"b\": 18446744073709551615}")));
+    EXPECT_EQ("{ka[i1i-2dtfnsx]7kbu18446744073709551615}2", recorder.events);
+
+    Recorder compileTime;
+    ASSERT_TRUE(parser.parse<pocketjson::kParseOptionAllowCommaEnding>(&compileTime, std::string("[1,]")));
+    EXPECT_EQ("[i1]1", compileTime.events);
+
+    Recorder stream;
+    std::istringstream is("[1] [2]");
+    ASSERT_TRUE(parser.parse(&stream, is));
+    ASSERT_TRUE(parser.parse(&stream, is));
+    EXPECT_EQ("[i1]1[i2]1", stream.events);
+}
+TEST(ParseHandler, TestBase) {
+    IntegerSum handler;
+    EXPECT_TRUE(pocketjson::parse(&handler, "{\"a\": [1, 2, {\"b\": 3}], \"c\": \"s\", \"d\": 0.5, \"e\": 18446744073709551615}"));
+    EXPECT_EQ(6, handler.sum);
+    // onUInteger defaults to onFloat of the derived class above INT64_MAX, and to onInteger below.
+    EXPECT_EQ(2, handler.floats);
+    EXPECT_TRUE(handler.onUInteger(5));
+    EXPECT_EQ(11, handler.sum);
+    EXPECT_EQ(2, handler.floats);
+
+    IntegerSum cancel;
+    cancel.limit = 3;
+    pocketjson::Parser parser;
+    EXPECT_FALSE(parser.parse(&cancel, std::string("[1, 2, 3, 4]")));
+    EXPECT_EQ(pocketjson::kErrorHandlerCancel, parser.error().code);
+    EXPECT_EQ(3, cancel.sum);
+}
+TEST(ParseHandler, TestAdapter) {
+    class Counter: public pocketjson::AbstractParseHandler {
+    public:
+        Counter(): count(0) {}
+        virtual bool onNull() { ++count; return true; }
+        virtual bool onBoolean(const bool&) { ++count; return true; }
+        virtual bool onInteger(const int64_t&) { ++count; return true; }
+        virtual bool onFloat(const double&) { ++count; return true; }
+        virtual bool onString(const std::string&) { ++count; return true; }
+        virtual bool beginArray() { ++count; return true; }
+        virtual bool endArray(const size_t&) { return true; }
+        virtual bool beginObject() { ++count; return true; }
+        virtual bool onObjectKey(const std::string&) { return true; }
+        virtual bool endObject(const size_t&) { return true; }
+        size_t count;
+    } counter;
+    // Runtime polymorphism through the abstract handler.
+    pocketjson::AbstractParseHandler* handler = &counter;
+    EXPECT_TRUE(pocketjson::parse(handler, "[1, {\"a\": null}, 18446744073709551615]"));
+    EXPECT_EQ(5u, counter.count);
+    EXPECT_TRUE(pocketjson::parse(&counter, "[true]"));
+    EXPECT_EQ(7u, counter.count);
+    EXPECT_TRUE(handler->onUInteger(1));
+    EXPECT_EQ(8u, counter.count);
+}
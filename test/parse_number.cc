@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <pocketjson/pocketjson.h>
+#include <limits.h>
+#include <stdlib.h>
 
 TEST(ParseNumber, Test0) {
     pocketjson::Value v;
@@ -62,13 +64,38 @@ TEST(ParseNumber, TestOverLLongMax) {
     pocketjson::Value v;
     EXPECT_TRUE(pocketjson::parse(v, "9223372036854775808"));
     EXPECT_TRUE(v.isNumber());
-    EXPECT_TRUE(v.isFloat());
-    EXPECT_EQ(9223372036854775808.0, v.as<double>());
+    EXPECT_TRUE(v.isInteger());
     EXPECT_EQ(true, v.toBoolean(false));
     EXPECT_EQ(123, v.toInt(123));
     EXPECT_EQ(123, v.toUInt(123));
+    EXPECT_EQ(123, v.toLLong(123));
+    EXPECT_EQ(9223372036854775808ULL, v.toULLong(123));
     EXPECT_EQ(9223372036854775808.0, v.toDouble(1.23));
-    EXPECT_STREQ("9.2233720368547758e+18", v.toString("null").c_str());
+    EXPECT_STREQ("9223372036854775808", v.toString("null").c_str());
+    EXPECT_EQ("9223372036854775808", v.serialize());
+}
+TEST(ParseNumber, TestULLongMax) {
+    pocketjson::Value v;
+    EXPECT_TRUE(pocketjson::parse(v, "18446744073709551615"));
+    EXPECT_TRUE(v.isInteger());
+    EXPECT_EQ(18446744073709551615ULL, v.toULLong(123));
+    EXPECT_EQ(-123, v.toLLong(-123));
+    EXPECT_EQ("18446744073709551615", v.serialize());
+    EXPECT_EQ(pocketjson::Value(18446744073709551615ULL), v);
+    EXPECT_NE(pocketjson::Value(-1), v);
+
+    EXPECT_TRUE(pocketjson::parse(v, "18446744073709551616"));
+    EXPECT_TRUE(v.isFloat());
+    EXPECT_EQ(18446744073709551616.0, v.toDouble());
+}
+TEST(ParseNumber, TestULLongValue) {
+    pocketjson::Value v(18446744073709551615ULL);
+    EXPECT_TRUE(v.isInteger());
+    EXPECT_EQ(18446744073709551615ULL, v.toULLong());
+    EXPECT_EQ("18446744073709551615", v.serialize());
+    v = 9223372036854775807ULL;
+    EXPECT_EQ(9223372036854775807LL, v.toLLong());
+    EXPECT_EQ(pocketjson::Value(9223372036854775807LL), v);
 }
 TEST(ParseNumber, TestLLongMin) {
     pocketjson::Value v;
@@ -86,10 +113,16 @@ TEST(ParseNumber, TestUnderLLongMin) {
     pocketjson::Value v;
     EXPECT_TRUE(pocketjson::parse(v, "-9223372036854775808"));
     EXPECT_TRUE(v.isNumber());
+    EXPECT_TRUE(v.isInteger());
+    EXPECT_EQ(LLONG_MIN, v.as<int64_t>());
+    EXPECT_EQ(LLONG_MIN, v.toLLong(123));
+    EXPECT_EQ(123, v.toULong(123));
+    EXPECT_STREQ("-9223372036854775808", v.toString("null").c_str());
+
+    EXPECT_TRUE(pocketjson::parse(v, "-9223372036854775809"));
     EXPECT_TRUE(v.isFloat());
-    EXPECT_EQ(-9223372036854775808.0, v.as<double>());
+    EXPECT_EQ(-9223372036854775809.0, v.as<double>());
     EXPECT_EQ(true, v.toBoolean(false));
-    EXPECT_EQ(-9223372036854775808.0, v.toDouble(1.23));
     EXPECT_EQ(123, v.toInt(123));
     EXPECT_EQ(123, v.toULong(123));
     EXPECT_STREQ("-9.2233720368547758e+18", v.toString("null").c_str());
@@ -185,3 +218,35 @@ TEST(ParseNumber, TestExpFail) {
     EXPECT_FALSE(pocketjson::parse(v, "2e0.1"));
     EXPECT_EQ(2, v.as<int64_t>());
 }
+TEST(ParseNumber, TestExact) {
+    // Converted from the significand, and through strtod when it is not exact.
+    const char* cases[] = {
+        "0.1", "-0.3", "1.7976931348623157e308", "2.2250738585072014e-308", "4.9e-324", "123456789012345678e-5",
+        "9007199254740993.0", "0.000001234", "1e22", "1e23", "3.14159265358979323846264338327950288",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        pocketjson::Value v;
+        EXPECT_TRUE(pocketjson::parse(v, cases[i])) << cases[i];
+        EXPECT_EQ(strtod(cases[i], 0), v.toDouble()) << cases[i];
+    }
+}
+TEST(ParseNumber, TestRaw) {
+    const char* cases[] = {
+        "1.50", "-0.0", "0.05", "10.5e-3", "1E+5", "2.5e-300", "6.02214076E23", "0e5", "123456789.1234567890",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        pocketjson::Value v;
+        EXPECT_TRUE(pocketjson::parse(v, cases[i], pocketjson::kParseOptionRawNumber)) << cases[i];
+        EXPECT_TRUE(v.isFloat()) << cases[i];
+        EXPECT_EQ(cases[i], v.serialize()) << cases[i];
+        EXPECT_EQ(cases[i], v.toString()) << cases[i];
+        EXPECT_EQ(strtod(cases[i], 0), v.toDouble()) << cases[i];
+        EXPECT_EQ(pocketjson::parse(cases[i]), v) << cases[i];
+    }
+    pocketjson::Value v;
+    EXPECT_TRUE(pocketjson::parse(v, "[1.50, 2, 18446744073709551615, 1.0e05]", pocketjson::kParseOptionRawNumber));
+    EXPECT_EQ("[1.50,2,18446744073709551615,100000]", v.serialize());
+    EXPECT_EQ(2, v[0].toInt());
+    EXPECT_EQ(1.5, v[0].as<double>());
+    EXPECT_EQ("[1.5,2,18446744073709551615,100000]", v.serialize());
+}
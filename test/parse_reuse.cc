@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+TEST(ParseReuse, TestReplace) {
+    pocketjson::Value v;
+    EXPECT_TRUE(pocketjson::parse(v, "[5, 6]"));
+    EXPECT_TRUE(pocketjson::parse(v, "[1]"));
+    EXPECT_EQ(1, v.size());
+    EXPECT_EQ(1, v[0].toInt());
+    EXPECT_TRUE(pocketjson::parse(v, "{\"a\": 1}"));
+    EXPECT_TRUE(pocketjson::parse(v, "{\"b\": 2}"));
+    EXPECT_EQ(1, v.size());
+    EXPECT_FALSE(v.contains("a"));
+}
+TEST(ParseReuse, TestReuseContainers) {
+    pocketjson::Parser parser;
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, "{\"name\": \"first\", \"list\": [1, 2, 3], \"old\": true}", pocketjson::kParseOptionReuseValue));
+    const pocketjson::Object* object = &v.as<pocketjson::Object>();
+    const std::string* name = &v["name"].as<std::string>();
+    const pocketjson::Array* list = &v["list"].as<pocketjson::Array>();
+
+    EXPECT_TRUE(parser.parse(v, "{\"name\": \"second\", \"list\": [4, 5], \"new\": null}", pocketjson::kParseOptionReuseValue));
+    EXPECT_EQ(object, &v.as<pocketjson::Object>());
+    EXPECT_EQ(name, &v["name"].as<std::string>());
+    EXPECT_EQ(list, &v["list"].as<pocketjson::Array>());
+    EXPECT_TRUE(pocketjson::parse("{\"name\": \"second\", \"list\": [4, 5], \"new\": null}") == v);
+    EXPECT_FALSE(v.contains("old"));
+}
+TEST(ParseReuse, TestReuseShared) {
+    pocketjson::Parser parser;
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, "{\"a\": [1, 2]}", pocketjson::kParseOptionReuseValue));
+    const pocketjson::Value copy = v;
+    EXPECT_TRUE(parser.parse(v, "{\"a\": [3]}", pocketjson::kParseOptionReuseValue));
+    EXPECT_EQ(2, copy["a"].size());
+    EXPECT_EQ(1, v["a"].size());
+    EXPECT_EQ(3, v["a"][0].toInt());
+}
+TEST(ParseReuse, TestDuplicateKey) {
+    pocketjson::Parser parser;
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, "{\"a\": 1, \"a\": 2}"));
+    EXPECT_EQ(1, v["a"].toInt());
+    EXPECT_TRUE(parser.parse(v, "{\"a\": 3, \"a\": 4}", pocketjson::kParseOptionReuseValue));
+    EXPECT_EQ(1, v.size());
+    EXPECT_EQ(3, v["a"].toInt());
+}
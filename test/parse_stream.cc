@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+#include <sstream>
+
+namespace {
+/**
+ * Stream buffer handing out the source a few bytes at a time, so values span blocks.
+ */
+class BlockBuffer: public std::streambuf {
+public:
+    BlockBuffer(const std::string& source, const size_t& block): source_(source), block_(block), pos_(0) {}
+protected:
+    virtual int_type underflow() {
+        if (gptr() < egptr()) { return traits_type::to_int_type(*gptr()); }
+        if (pos_ >= source_.size()) { return traits_type::eof(); }
+        const size_t n = std::min(block_, source_.size() - pos_);
+        char* p = &source_[pos_];
+        setg(p, p, p + n);
+        pos_ += n;
+        return traits_type::to_int_type(*p);
+    }
+private:
+    std::string source_;
+    size_t block_;
+    size_t pos_;
+};
+/**
+ * Stream buffer without a get area.
+ */
+class UnbufferedBuffer: public std::streambuf {
+public:
+    explicit UnbufferedBuffer(const std::string& source): source_(source), pos_(0) {}
+protected:
+    virtual int_type underflow() { return pos_ < source_.size() ? traits_type::to_int_type(source_[pos_]) : traits_type::eof(); }
+    virtual int_type uflow() { return pos_ < source_.size() ? traits_type::to_int_type(source_[pos_++]) : traits_type::eof(); }
+private:
+    std::string source_;
+    size_t pos_;
+};
+/**
+ * Stream buffer with a get area for the first block only.
+ */
+class ShrinkingBuffer: public std::streambuf {
+public:
+    ShrinkingBuffer(const std::string& source, const size_t& block): source_(source), block_(block), pos_(0) {}
+protected:
+    virtual int_type underflow() {
+        if (gptr() < egptr()) { return traits_type::to_int_type(*gptr()); }
+        if (gptr()) {
+            pos_ += static_cast<size_t>(gptr() - eback());
+            setg(0, 0, 0);
+        }
+        if (pos_ >= source_.size()) { return traits_type::eof(); }
+        if (pos_ == 0) {
+            char* p = &source_[0];
+            setg(p, p, p + std::min(block_, source_.size()));
+        }
+        return traits_type::to_int_type(source_[pos_]);
+    }
+    virtual int_type uflow() {
+        const int_type c = this->underflow();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            if (gptr() < egptr()) { gbump(1); } else { ++pos_; }
+        }
+        return c;
+    }
+private:
+    std::string source_;
+    size_t block_;
+    size_t pos_;
+};
+
+std::vector<std::string> readAll(std::istream& is) {
+    std::vector<std::string> values;
+    pocketjson::Value v;
+    while (is >> v) {
+        values.push_back(v.serialize());
+    }
+    return values;
+}
+} // namespace
+
+TEST(ParseStream, TestConcatenated) {
+    std::istringstream is("{\"a\": [1, 2]} [true]\n\"str\"12 null\n");
+    const std::vector<std::string> values = readAll(is);
+    ASSERT_EQ(5u, values.size());
+    EXPECT_EQ("{\"a\":[1,2]}", values[0]);
+    EXPECT_EQ("[true]", values[1]);
+    EXPECT_EQ("\"str\"", values[2]);
+    EXPECT_EQ("12", values[3]);
+    EXPECT_EQ("null", values[4]);
+    EXPECT_TRUE(is.eof());
+}
+TEST(ParseStream, TestSmallBlocks) {
+    const std::string source = "{\"key\": \"a string which is longer than the block\", \"n\": 12345}123 456 [1.5e3] ";
+    for (size_t block = 1; block < 8; ++block) {
+        BlockBuffer buf(source, block);
+        std::istream is(&buf);
+        const std::vector<std::string> values = readAll(is);
+        ASSERT_EQ(4u, values.size()) << block;
+        EXPECT_EQ("{\"key\":\"a string which is longer than the block\",\"n\":12345}", values[0]) << block;
+        EXPECT_EQ("123", values[1]) << block;
+        EXPECT_EQ("456", values[2]) << block;
+        EXPECT_EQ("[1500]", values[3]) << block;
+    }
+}
+TEST(ParseStream, TestLargeValue) {
+    std::string source = "\xef\xbb\xbf [";
+    for (int i = 0; i < 20000; ++i) {
+        source += i ? ", " : "";
+        source += "{\"s\": \"q\\\" ]}\\\\\", \"n\": -1.25e+2}";
+    }
+    source += "] \"a\\\"b\" true 7";
+    const pocketjson::Value expected = pocketjson::parse(source);
+    const size_t blocks[] = { 1, 2, 3, 4096 };
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); ++i) {
+        BlockBuffer buf(source, blocks[i]);
+        std::istream is(&buf);
+        const std::vector<std::string> values = readAll(is);
+        ASSERT_EQ(4u, values.size()) << blocks[i];
+        EXPECT_EQ(expected.serialize(), values[0]) << blocks[i];
+        EXPECT_EQ("\"a\\\"b\"", values[1]) << blocks[i];
+        EXPECT_EQ("true", values[2]) << blocks[i];
+        EXPECT_EQ("7", values[3]) << blocks[i];
+    }
+}
+TEST(ParseStream, TestUnbuffered) {
+    UnbufferedBuffer buf("[1] {\"a\": null} 2");
+    std::istream is(&buf);
+    const std::vector<std::string> values = readAll(is);
+    ASSERT_EQ(3u, values.size());
+    EXPECT_EQ("[1]", values[0]);
+    EXPECT_EQ("{\"a\":null}", values[1]);
+    EXPECT_EQ("2", values[2]);
+}
+TEST(ParseStream, TestGetAreaGone) {
+    // Only the rest of the value is read once the get area is gone.
+    for (size_t block = 1; block < 12; ++block) {
+        ShrinkingBuffer buf("{\"a\": [1, \"]\"]} 23 x", block);
+        std::istream is(&buf);
+        pocketjson::Value v;
+        ASSERT_TRUE(static_cast<bool>(is >> v)) << block;
+        EXPECT_EQ("{\"a\":[1,\"]\"]}", v.serialize()) << block;
+        ASSERT_TRUE(static_cast<bool>(is >> v)) << block;
+        EXPECT_EQ("23", v.serialize()) << block;
+        std::string rest;
+        std::getline(is, rest);
+        EXPECT_EQ(" x", rest) << block;
+    }
+}
+TEST(ParseStream, TestRemaining) {
+    // Bytes after the value stay in the stream.
+    std::istringstream is("[1, 2] rest");
+    pocketjson::Value v;
+    ASSERT_TRUE(static_cast<bool>(is >> v));
+    EXPECT_EQ(2u, v.size());
+    std::string rest;
+    std::getline(is, rest);
+    EXPECT_EQ(" rest", rest);
+}
+TEST(ParseStream, TestFail) {
+    std::istringstream is("[1, 2] [1, 2,]");
+    pocketjson::Parser parser;
+    pocketjson::Value v;
+    ASSERT_TRUE(parser.parse(v, is));
+    EXPECT_FALSE(parser.parse(v, is));
+    EXPECT_EQ(pocketjson::kErrorArrayTrailingComma, parser.error().code);
+    EXPECT_TRUE(is.fail());
+
+    const std::string source = "[\"abc\",\n tru]";
+    pocketjson::Parser reference;
+    EXPECT_FALSE(reference.parse(v, source));
+    BlockBuffer buf(source, 3);
+    std::istream blocks(&buf);
+    std::string error;
+    EXPECT_FALSE(parser.parse(v, blocks, pocketjson::kParseOptionNone, &error));
+    EXPECT_EQ(pocketjson::kErrorInvalidBoolean, parser.error().code);
+    EXPECT_EQ(reference.error().offset, parser.error().offset);
+    EXPECT_EQ(2u, parser.error().line);
+    EXPECT_FALSE(error.empty());
+}
+TEST(ParseStream, TestHandler) {
+    class Counter: public pocketjson::AbstractParseHandler {
+    public:
+        Counter(): count(0) {}
+        virtual bool onNull() { ++count; return true; }
+        virtual bool onBoolean(const bool&) { ++count; return true; }
+        virtual bool onInteger(const int64_t&) { ++count; return true; }
+        virtual bool onFloat(const double&) { ++count; return true; }
+        virtual bool onString(const std::string&) { ++count; return true; }
+        virtual bool beginArray() { ++count; return true; }
+        virtual bool endArray(const size_t&) { return true; }
+        virtual bool beginObject() { ++count; return true; }
+        virtual bool onObjectKey(const std::string&) { return true; }
+        virtual bool endObject(const size_t&) { return true; }
+        size_t count;
+    } counter;
+    BlockBuffer buf("[1, \"two\", {\"three\": 3}] [4]", 5);
+    std::istream is(&buf);
+    pocketjson::Parser parser;
+    EXPECT_TRUE(parser.parse(&counter, is));
+    EXPECT_EQ(5u, counter.count);
+    EXPECT_TRUE(parser.parse(&counter, is));
+    EXPECT_EQ(7u, counter.count);
+}
@@ -34,3 +34,51 @@ TEST(ParseString, TestStringFail) {
     EXPECT_FALSE(pocketjson::parse(v, "\"\\a \""));
     EXPECT_TRUE(v.isNumber());
 }
+TEST(ParseString, TestValidateUtf8) {
+    const pocketjson::ParseOption utf8 = pocketjson::kParseOptionValidateUtf8;
+    const char* valid[] = {
+        "\"ascii only, long enough for a vector block\"",
+        "\"\xc2\x80 \xdf\xbf \xe0\xa0\x80 \xed\x9f\xbf \xee\x80\x80 \xef\xbf\xbf \xf0\x90\x80\x80 \xf4\x8f\xbf\xbf\"",
+        "{\"\xe3\x81\x82\xe3\x81\x84\xe3\x81\x86\xe3\x81\x88\xe3\x81\x8a\xe3\x81\x8b\xe3\x81\x8d\": \"Unicode \\u3042\xe9\x9c\xb2\"}",
+    };
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i) {
+        const std::string json = valid[i];
+        pocketjson::Value strict;
+        pocketjson::Value loose;
+        EXPECT_TRUE(pocketjson::parse(strict, json, utf8)) << json;
+        EXPECT_TRUE(pocketjson::parse(loose, json)) << json;
+        EXPECT_TRUE(strict == loose) << json;
+        EXPECT_TRUE(pocketjson::validate(json, utf8)) << json;
+        EXPECT_TRUE(pocketjson::parse(strict, json.begin(), json.end(), utf8)) << json;
+    }
+
+    struct Case {
+        const char* json;
+        size_t offset;
+    };
+    const Case invalid[] = {
+        {"\"\x80\"", 1},                                            // Continuation byte without lead byte
+        {"\"\xc0\xaf\"", 1},                                        // Overlong
+        {"\"\xe0\x9f\xbf\"", 2},                                    // Overlong
+        {"\"\xed\xa0\x80\"", 2},                                    // Surrogate
+        {"\"\xf4\x90\x80\x80\"", 2},                                // Above U+10FFFF
+        {"\"\xf5\x80\x80\x80\"", 1},
+        {"\"\xe3\x81\"", 3},                                        // Truncated
+        {"\"0123456789abcdefghijklmnopqrstuvwxyz \xff\"", 38},      // After vector blocks
+        {"{\"key\": 1, \"0123456789abcdef\xe3\x81\x41\": 2}", 30},  // Object key
+    };
+    pocketjson::Parser parser;
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        const std::string json = invalid[i].json;
+        pocketjson::Value v;
+        EXPECT_TRUE(parser.parse(v, json)) << json;
+        EXPECT_FALSE(parser.parse(v, json, utf8)) << json;
+        EXPECT_EQ(pocketjson::kErrorInvalidUtf8, parser.error().code) << json;
+        EXPECT_EQ(invalid[i].offset, parser.error().offset) << json;
+        EXPECT_FALSE(parser.validate(json, utf8)) << json;
+        EXPECT_EQ(invalid[i].offset, parser.error().offset) << json;
+        EXPECT_FALSE(parser.parse(v, json.begin(), json.end(), utf8)) << json;
+        EXPECT_EQ(invalid[i].offset, parser.error().offset) << json;
+        EXPECT_FALSE(parser.parse<pocketjson::kParseOptionValidateUtf8>(v, json)) << json;
+    }
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <pocketjson/patch.h>
+
+namespace {
+std::string patched(const char* doc, const char* ops) {
+    pocketjson::Value v = pocketjson::parse(doc);
+    std::string error;
+    if (!pocketjson::patch(v, pocketjson::parse(ops), &error)) { return error; }
+    return v.serialize();
+}
+std::string merged(const char* doc, const char* patch) {
+    pocketjson::Value v = pocketjson::parse(doc);
+    pocketjson::mergePatch(v, pocketjson::parse(patch));
+    return v.serialize();
+}
+} // namespace
+
+TEST(Patch, TestPointer) {
+    pocketjson::Path path;
+    ASSERT_TRUE(pocketjson::parsePointer("/a~1b/m~0n/0/", path));
+    ASSERT_EQ(4u, path.size());
+    EXPECT_EQ("a/b", path.keyAt(0));
+    EXPECT_EQ("m~n", path.keyAt(1));
+    EXPECT_EQ("0", path.keyAt(2));
+    EXPECT_EQ("", path.keyAt(3));
+    ASSERT_TRUE(pocketjson::parsePointer("", path));
+    EXPECT_TRUE(path.empty());
+    EXPECT_FALSE(pocketjson::parsePointer("a", path));
+    EXPECT_FALSE(pocketjson::parsePointer("/a~2", path));
+    EXPECT_FALSE(pocketjson::parsePointer("/a~", path));
+
+    // RFC 6901 examples
+    const pocketjson::Value v = pocketjson::parse("{\"foo\": [\"bar\", \"baz\"], \"\": 0, \"a/b\": 1, \"m~n\": 8, \" \": 7}");
+    EXPECT_TRUE(pocketjson::resolve(v, "") == &v);
+    EXPECT_EQ("baz", pocketjson::resolve(v, "/foo/1")->toString());
+    EXPECT_EQ(0, pocketjson::resolve(v, "/")->toInt());
+    EXPECT_EQ(1, pocketjson::resolve(v, "/a~1b")->toInt());
+    EXPECT_EQ(8, pocketjson::resolve(v, "/m~0n")->toInt());
+    EXPECT_EQ(7, pocketjson::resolve(v, "/ ")->toInt());
+    EXPECT_TRUE(pocketjson::resolve(v, "/foo/2") == 0);
+    EXPECT_TRUE(pocketjson::resolve(v, "/foo/01") == 0);
+    EXPECT_TRUE(pocketjson::resolve(v, "foo") == 0);
+}
+TEST(Patch, TestOperations) {
+    // RFC 6902 appendix A
+    EXPECT_EQ("{\"baz\":\"qux\",\"foo\":\"bar\"}", patched("{\"foo\": \"bar\"}", "[{\"op\": \"add\", \"path\": \"/baz\", \"value\": \"qux\"}]"));
+    EXPECT_EQ("{\"foo\":[\"bar\",\"qux\",\"baz\"]}", patched("{\"foo\": [\"bar\", \"baz\"]}", "[{\"op\": \"add\", \"path\": \"/foo/1\", \"value\": \"qux\"}]"));
+    EXPECT_EQ("{\"foo\":\"bar\"}", patched("{\"baz\": \"qux\", \"foo\": \"bar\"}", "[{\"op\": \"remove\", \"path\": \"/baz\"}]"));
+    EXPECT_EQ("{\"foo\":[\"bar\",\"baz\"]}", patched("{\"foo\": [\"bar\", \"qux\", \"baz\"]}", "[{\"op\": \"remove\", \"path\": \"/foo/1\"}]"));
+    EXPECT_EQ("{\"baz\":\"boo\",\"foo\":\"bar\"}", patched("{\"baz\": \"qux\", \"foo\": \"bar\"}", "[{\"op\": \"replace\", \"path\": \"/baz\", \"value\": \"boo\"}]"));
+    EXPECT_EQ("{\"foo\":{\"bar\":\"baz\"},\"qux\":{\"corge\":\"grault\",\"thud\":\"fred\"}}",
+        patched("{\"foo\": {\"bar\": \"baz\", \"waldo\": \"fred\"}, \"qux\": {\"corge\": \"grault\"}}",
+            "[{\"op\": \"move\", \"from\": \"/foo/waldo\", \"path\": \"/qux/thud\"}]"));
+    EXPECT_EQ("{\"foo\":[\"all\",\"cows\",\"eat\",\"grass\"]}", patched("{\"foo\": [\"all\", \"grass\", \"cows\", \"eat\"]}", "[{\"op\": \"move\", \"from\": \"/foo/1\", \"path\": \"/foo/3\"}]"));
+    EXPECT_EQ("{\"baz\":[{\"qux\":\"hello\"}],\"foo\":1}",
+        patched("{\"baz\": [{\"qux\": \"hello\"}], \"foo\": 1}", "[{\"op\": \"test\", \"path\": \"/baz/0/qux\", \"value\": \"hello\"}, {\"op\": \"test\", \"path\": \"/foo\", \"value\": 1}]"));
+    EXPECT_EQ("{\"child\":{\"grandchild\":{}},\"foo\":\"bar\"}", patched("{\"foo\": \"bar\"}", "[{\"op\": \"add\", \"path\": \"/child\", \"value\": {\"grandchild\": {}}}]"));
+    EXPECT_EQ("{\"foo\":[\"bar\",[\"abc\",\"def\"]]}", patched("{\"foo\": [\"bar\"]}", "[{\"op\": \"add\", \"path\": \"/foo/-\", \"value\": [\"abc\", \"def\"]}]"));
+    EXPECT_EQ("{\"a\":[1,2],\"b\":[1,2]}", patched("{\"a\": [1, 2]}", "[{\"op\": \"copy\", \"from\": \"/a\", \"path\": \"/b\"}]"));
+    EXPECT_EQ("[1]", patched("{\"a\": 1}", "[{\"op\": \"add\", \"path\": \"\", \"value\": [1]}]"));
+    EXPECT_EQ("{\"a\":1}", patched("{\"a\": 1}", "[{\"op\": \"move\", \"from\": \"/a\", \"path\": \"/a\"}]"));
+
+    EXPECT_EQ("operation 0: Path is not found.", patched("{\"foo\": \"bar\"}", "[{\"op\": \"remove\", \"path\": \"/baz\"}]"));
+    EXPECT_EQ("operation 0: Test failed.", patched("{\"baz\": \"qux\"}", "[{\"op\": \"test\", \"path\": \"/baz\", \"value\": \"bar\"}]"));
+    EXPECT_EQ("operation 0: Parent of the path is not found.", patched("{\"foo\": \"bar\"}", "[{\"op\": \"add\", \"path\": \"/baz/bat\", \"value\": \"qux\"}]"));
+    EXPECT_EQ("operation 0: Array index is out of range.", patched("[1]", "[{\"op\": \"add\", \"path\": \"/2\", \"value\": 2}]"));
+    EXPECT_EQ("operation 0: Value cannot be moved into its own child.", patched("{\"a\": {\"b\": 1}}", "[{\"op\": \"move\", \"from\": \"/a\", \"path\": \"/a/c\"}]"));
+    EXPECT_EQ("operation 0: Member \"value\" is missing.", patched("{}", "[{\"op\": \"add\", \"path\": \"/a\"}]"));
+    EXPECT_EQ("operation 0: Unknown operation.", patched("{}", "[{\"op\": \"append\", \"path\": \"/a\"}]"));
+    EXPECT_EQ("Patch is not an array.", patched("{}", "{}"));
+}
+TEST(Patch, TestRollback) {
+    const char* doc = "{\"list\": [1, 2, 3], \"obj\": {\"a\": 1, \"b\": 2}, \"s\": \"x\"}";
+    pocketjson::Value v = pocketjson::parse(doc);
+    const pocketjson::Value original = pocketjson::parse(doc);
+    const pocketjson::Value ops = pocketjson::parse("["
+        "{\"op\": \"add\", \"path\": \"/list/-\", \"value\": 4},"
+        "{\"op\": \"remove\", \"path\": \"/list/0\"},"
+        "{\"op\": \"replace\", \"path\": \"/obj/a\", \"value\": [true]},"
+        "{\"op\": \"add\", \"path\": \"/obj/b\", \"value\": null},"
+        "{\"op\": \"move\", \"from\": \"/obj\", \"path\": \"/list/1\"},"
+        "{\"op\": \"copy\", \"from\": \"/s\", \"path\": \"/t\"},"
+        "{\"op\": \"add\", \"path\": \"\", \"value\": 1},"
+        "{\"op\": \"test\", \"path\": \"\", \"value\": 2}"
+        "]");
+    std::string error;
+    EXPECT_FALSE(pocketjson::patch(v, ops, &error));
+    EXPECT_EQ("operation 7: Test failed.", error);
+    EXPECT_TRUE(v == original);
+    EXPECT_EQ(original.serialize(), v.serialize());
+}
+TEST(Patch, TestMoveKeepsContainer) {
+    pocketjson::Value v = pocketjson::parse("{\"a\": {\"big\": [1, 2, 3]}, \"b\": {}}");
+    const pocketjson::Array* array = &v["a"]["big"].as<pocketjson::Array>();
+    EXPECT_TRUE(pocketjson::patch(v, pocketjson::parse("[{\"op\": \"move\", \"from\": \"/a/big\", \"path\": \"/b/moved\"}]")));
+    EXPECT_TRUE(array == &v["b"]["moved"].as<pocketjson::Array>());
+
+    // Untouched subtrees of a shared document stay shared.
+    const pocketjson::Value copy = v;
+    EXPECT_TRUE(pocketjson::patch(v, pocketjson::parse("[{\"op\": \"add\", \"path\": \"/a/x\", \"value\": 1}]")));
+    EXPECT_TRUE(&copy["b"].as<pocketjson::Object>() == &static_cast<const pocketjson::Value&>(v)["b"].as<pocketjson::Object>());
+    EXPECT_EQ("{\"a\":{},\"b\":{\"moved\":[1,2,3]}}", copy.serialize());
+}
+TEST(Patch, TestMerge) {
+    // RFC 7396 appendix A
+    EXPECT_EQ("{\"a\":\"c\"}", merged("{\"a\":\"b\"}", "{\"a\":\"c\"}"));
+    EXPECT_EQ("{\"a\":\"b\",\"b\":\"c\"}", merged("{\"a\":\"b\"}", "{\"b\":\"c\"}"));
+    EXPECT_EQ("{}", merged("{\"a\":\"b\"}", "{\"a\":null}"));
+    EXPECT_EQ("{\"b\":\"c\"}", merged("{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}"));
+    EXPECT_EQ("{\"a\":\"c\"}", merged("{\"a\":[\"b\"]}", "{\"a\":\"c\"}"));
+    EXPECT_EQ("{\"a\":[\"b\"]}", merged("{\"a\":\"c\"}", "{\"a\":[\"b\"]}"));
+    EXPECT_EQ("{\"a\":{\"b\":\"d\"}}", merged("{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}"));
+    EXPECT_EQ("{\"a\":[1]}", merged("{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}"));
+    EXPECT_EQ("[\"c\"]", merged("[\"a\",\"b\"]", "[\"c\"]"));
+    EXPECT_EQ("null", merged("{\"a\":\"foo\"}", "null"));
+    EXPECT_EQ("\"bar\"", merged("{\"a\":\"foo\"}", "\"bar\""));
+    EXPECT_EQ("{\"a\":\"foo\",\"e\":null}", merged("{\"e\":null}", "{\"a\":\"foo\"}"));
+    EXPECT_EQ("{\"a\":\"b\"}", merged("[1,2]", "{\"a\":\"b\",\"c\":null}"));
+    EXPECT_EQ("{\"a\":{\"bb\":{}}}", merged("{}", "{\"a\":{\"bb\":{\"ccc\":null}}}"));
+}
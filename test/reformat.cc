@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <pocketjson/reformat.h>
+#include <sstream>
+
+TEST(Reformat, TestMinify) {
+    const std::string json = " {\n  \"z\": [1, 2.50, -0e+3, 1E2],\n  \"a\": {\"s\": \"t\\u00e9xt \\/ \\\"q\\\"\", \"e\": {}, \"l\": [ ]},\n  \"b\": [true, false, null]\n}\n";
+    std::string out;
+    EXPECT_TRUE(pocketjson::reformat(json, out));
+    // Key order, number lexemes and escapes are kept.
+    EXPECT_STREQ("{\"z\":[1,2.50,-0e+3,1E2],\"a\":{\"s\":\"t\\u00e9xt \\/ \\\"q\\\"\",\"e\":{},\"l\":[]},\"b\":[true,false,null]}", out.c_str());
+    EXPECT_TRUE(pocketjson::parse(out) == pocketjson::parse(json));
+
+    out.clear();
+    EXPECT_TRUE(pocketjson::reformat(std::string("\"\\ud83d\\ude00\""), out));
+    EXPECT_STREQ("\"\\ud83d\\ude00\"", out.c_str());
+    out.clear();
+    EXPECT_TRUE(pocketjson::reformat(std::string(" 12 "), out));
+    EXPECT_STREQ("12", out.c_str());
+}
+TEST(Reformat, TestPretty) {
+    // Pretty output matches Serializer for documents without key order or number differences.
+    const std::string json = "{\"a\":[1,[],{},{\"b\":null,\"c\":[[\"x\"]]}],\"d\":{}}";
+    const pocketjson::Value v = pocketjson::parse(json);
+    const pocketjson::SerializeOption options[] = {
+        pocketjson::kSerializeOptionPretty,
+        pocketjson::kSerializeOptionPretty4Spaces,
+        pocketjson::kSerializeOptionPrettyTabCRLF,
+    };
+    for (size_t i = 0; i < sizeof(options) / sizeof(options[0]); ++i) {
+        std::string out;
+        EXPECT_TRUE(pocketjson::reformat(json, out, options[i]));
+        EXPECT_STREQ(v.serialize(options[i]).c_str(), out.c_str());
+    }
+}
+TEST(Reformat, TestStream) {
+    std::istringstream in("[1,\n {\"b\": 2, \"a\": \"x\"}]");
+    std::ostringstream out;
+    pocketjson::Reformatter reformatter;
+    EXPECT_TRUE(reformatter.reformat(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>(), std::ostreambuf_iterator<char>(out), pocketjson::kSerializeOptionPretty));
+    EXPECT_STREQ("[\n  1,\n  {\n    \"b\": 2,\n    \"a\": \"x\"\n  }\n]", out.str().c_str());
+}
+TEST(Reformat, TestOption) {
+    std::string out;
+    EXPECT_FALSE(pocketjson::reformat(std::string("[1, {\"a\": 2,},] x"), out));
+    out.clear();
+    EXPECT_TRUE(pocketjson::reformat(std::string("[1, {\"a\": 2,},] x"), out, pocketjson::kSerializeOptionNone, pocketjson::kParseOptionAllowLooseFormat));
+    EXPECT_STREQ("[1,{\"a\":2}]", out.c_str());
+    out.clear();
+    EXPECT_TRUE(pocketjson::reformat(std::string("[\"\xff\"]"), out));
+    EXPECT_FALSE(pocketjson::reformat(std::string("[\"\xff\"]"), out, pocketjson::kSerializeOptionNone, pocketjson::kParseOptionValidateUtf8));
+    out.clear();
+    EXPECT_TRUE(pocketjson::reformat(std::string("[\"\xe3\x81\x82\"]"), out, pocketjson::kSerializeOptionNone, pocketjson::kParseOptionValidateUtf8));
+    EXPECT_STREQ("[\"\xe3\x81\x82\"]", out.c_str());
+}
+TEST(Reformat, TestFail) {
+    // Errors match the ones reported by Parser.
+    const char* cases[] = {
+        "", "nul", "tru", "012", "-", "1.e", "1e+", "\"\\u12g4\"", "\"\\udc00\"", "\"\\ud800\\u0041\"", "\"\\ud800x\"",
+        "\"\\x\"", "\"abc", "[1,]", "[1 2]", "[1", "[1,", "[", "{\"a\":1,}", "{\"a\" 1}", "{a}", "{", "{\"a\":1,", "[] []",
+        "[[1, 2], {\"a\": [true, }]]",
+    };
+    pocketjson::Reformatter reformatter;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const std::string json = cases[i];
+        pocketjson::Parser parser;
+        pocketjson::Value v;
+        EXPECT_FALSE(parser.parse(v, json)) << json;
+        std::string out;
+        EXPECT_FALSE(reformatter.reformat(json, out)) << json;
+        EXPECT_EQ(parser.error().code, reformatter.error().code) << json;
+        EXPECT_EQ(parser.error().offset, reformatter.error().offset) << json;
+    }
+    std::string out;
+    std::string error;
+    EXPECT_FALSE(pocketjson::reformat(std::string("[1,\n 2 3]"), out, pocketjson::kSerializeOptionNone, pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Unexpected string exists while parsing array.", error.c_str());
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <pocketjson/schema.h>
+
+namespace {
+const char* kSchema =
+    "{\"type\": \"object\", \"required\": [\"id\", \"name\"], \"additionalProperties\": false,"
+    " \"properties\": {"
+    "  \"id\": {\"type\": \"integer\", \"minimum\": 1},"
+    "  \"name\": {\"type\": \"string\", \"minLength\": 1, \"maxLength\": 4},"
+    "  \"role\": {\"enum\": [\"admin\", \"user\"]},"
+    "  \"score\": {\"type\": [\"number\", \"null\"], \"exclusiveMaximum\": 100},"
+    "  \"tags\": {\"type\": \"array\", \"maxItems\": 2, \"items\": {\"type\": \"string\"}},"
+    "  \"extra\": {}"
+    " }}";
+} // namespace
+
+TEST(Schema, TestCompile) {
+    pocketjson::Schema schema;
+    std::string error;
+    EXPECT_TRUE(schema.compile(pocketjson::parse(kSchema), &error)) << error;
+    EXPECT_TRUE(schema.isCompiled());
+    EXPECT_FALSE(schema.compile(pocketjson::parse("{\"type\": \"text\"}"), &error));
+    EXPECT_STREQ("Unknown type \"text\" exists in schema.", error.c_str());
+    EXPECT_FALSE(schema.isCompiled());
+    EXPECT_FALSE(schema.compile(pocketjson::parse("{\"minLength\": -1}"), &error));
+
+    const pocketjson::Schema invalid(pocketjson::parse("{\"required\": \"id\"}"), &error);
+    EXPECT_FALSE(invalid.isCompiled());
+    EXPECT_STREQ("required must be an array.", error.c_str());
+}
+TEST(Schema, TestValid) {
+    const pocketjson::Schema schema(pocketjson::parse(kSchema));
+    pocketjson::Value v;
+    std::string error;
+    const std::string json = "{\"id\": 1, \"name\": \"\xe3\x81\x82\xe3\x81\x84\", \"role\": \"user\", \"score\": null,"
+                             " \"tags\": [\"a\"], \"extra\": {\"any\": [1, {}]}}";
+    EXPECT_TRUE(pocketjson::parse(v, schema, json, pocketjson::kParseOptionNone, &error)) << error;
+    EXPECT_TRUE(v == pocketjson::parse(json));
+}
+TEST(Schema, TestInvalid) {
+    const pocketjson::Schema schema(pocketjson::parse(kSchema));
+    pocketjson::Value v;
+    std::string error;
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 0, \"name\": \"a\"}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/id: Number is less than minimum.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1.5, \"name\": \"a\"}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/id: Type is not allowed.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1, \"name\": \"abcde\"}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/name: String is longer than maxLength.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1, \"name\": \"a\", \"role\": \"root\"}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/role: Value is not in enum.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1, \"name\": \"a\", \"score\": 100}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/score: Number is greater than maximum.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1, \"name\": \"a\", \"tags\": [\"a\", 2]}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/tags/1: Type is not allowed.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1, \"name\": \"a\", \"tags\": [\"a\", \"b\", \"c\"]}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/tags: Array has more items than maxItems.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Required property \"name\" does not exist.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("{\"id\": 1, \"name\": \"a\", \"a/b\": 1}"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("/a~1b: Additional property is not allowed.", error.c_str());
+    EXPECT_FALSE(pocketjson::parse(v, schema, std::string("[]"), pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Type is not allowed.", error.c_str());
+}
+TEST(Schema, TestHandler) {
+    const pocketjson::Schema schema(pocketjson::parse("{\"items\": {\"type\": \"integer\"}}"));
+    pocketjson::Value v;
+    pocketjson::ValueBuilder builder(v);
+    pocketjson::SchemaValidator validator(schema, &builder);
+    pocketjson::Parser parser;
+    EXPECT_TRUE(parser.parse(&validator, std::string("[1, 2]")));
+    EXPECT_TRUE(validator.isValid());
+    EXPECT_STREQ("[1,2]", v.serialize().c_str());
+
+    // The validator and the builder are reused for the next input.
+    validator.reset();
+    EXPECT_FALSE(parser.parse(&validator, std::string("[1, \"a\", 3]")));
+    EXPECT_FALSE(validator.isValid());
+    EXPECT_STREQ("/1", validator.errorPath().c_str());
+    EXPECT_EQ(1, v.size());
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <pocketjson/snapshot.h>
+#include <stdio.h>
+
+static pocketjson::Value snapshotSource() {
+    return pocketjson::parse("{\"name\": \"pocketjson\", \"version\": 2, \"pi\": 3.14, \"ok\": true, \"none\": null,"
+                             " \"list\": [1, \"two\", [3], {\"name\": \"nested\"}], \"empty\": {}}");
+}
+
+TEST(Snapshot, TestRoundTrip) {
+    const pocketjson::Value v = snapshotSource();
+    std::string data;
+    EXPECT_TRUE(pocketjson::writeSnapshot(data, v));
+    pocketjson::Snapshot snapshot;
+    EXPECT_TRUE(snapshot.load(data.data(), data.size()));
+    EXPECT_TRUE(v == snapshot.root().toValue());
+
+    const pocketjson::Value numbers = pocketjson::parse("[18446744073709551615, -1, 1.50]", pocketjson::kParseOptionRawNumber);
+    std::string numberData;
+    EXPECT_TRUE(pocketjson::writeSnapshot(numberData, numbers));
+    EXPECT_TRUE(snapshot.load(numberData.data(), numberData.size()));
+    EXPECT_EQ(18446744073709551615ULL, snapshot.root()[0].toULLong());
+    EXPECT_EQ(-1, snapshot.root()[1].toLLong());
+    EXPECT_TRUE(numbers == snapshot.root().toValue());
+}
+TEST(Snapshot, TestAccess) {
+    std::string data;
+    pocketjson::writeSnapshot(data, snapshotSource());
+    pocketjson::Snapshot snapshot;
+    EXPECT_TRUE(snapshot.load(data.data(), data.size()));
+    const pocketjson::SnapshotValue root = snapshot.root();
+    EXPECT_TRUE(root.isObject());
+    EXPECT_EQ(7, root.size());
+    EXPECT_STREQ("pocketjson", root["name"].toString().c_str());
+    EXPECT_STREQ("pocketjson", root["name"].c_str());
+    EXPECT_EQ(2, root["version"].toInt());
+    EXPECT_EQ(3.14, root["pi"].toDouble());
+    EXPECT_TRUE(root["ok"].toBoolean());
+    EXPECT_TRUE(root["none"].isNull());
+    EXPECT_TRUE(root.contains("none"));
+    EXPECT_FALSE(root.contains("missing"));
+    EXPECT_TRUE(root["missing"].isNull());
+    EXPECT_TRUE(root["empty"].isObject());
+    EXPECT_TRUE(root["empty"].empty());
+    EXPECT_STREQ("empty", root.keyAt(0).c_str());
+
+    const pocketjson::SnapshotValue list = root["list"];
+    EXPECT_TRUE(list.isArray());
+    EXPECT_EQ(4, list.size());
+    EXPECT_EQ(1, list[0].toInt());
+    EXPECT_EQ(2, list[1].toInt(2));
+    EXPECT_STREQ("two", list[1].toString().c_str());
+    EXPECT_EQ(3, list[2][0].toInt());
+    EXPECT_STREQ("nested", list[3]["name"].toString().c_str());
+    EXPECT_TRUE(list[4].isNull());
+}
+TEST(Snapshot, TestUnaligned) {
+    std::string data;
+    pocketjson::writeSnapshot(data, snapshotSource());
+    // A caller owned buffer may start at any address.
+    const std::string shifted = "x" + data;
+    pocketjson::Snapshot snapshot;
+    EXPECT_TRUE(snapshot.load(shifted.data() + 1, data.size()));
+    EXPECT_EQ(3.14, snapshot.root()["pi"].toDouble());
+    EXPECT_STREQ("nested", snapshot.root()["list"][3]["name"].c_str());
+    EXPECT_TRUE(snapshotSource() == snapshot.root().toValue());
+}
+TEST(Snapshot, TestFile) {
+    const std::string path = "pocketjson_snapshot_test.bin";
+    const pocketjson::Value v = snapshotSource();
+    EXPECT_TRUE(pocketjson::saveSnapshot(path, v));
+    pocketjson::Snapshot snapshot;
+    EXPECT_TRUE(snapshot.open(path));
+    EXPECT_TRUE(snapshot.isOpen());
+    EXPECT_STREQ("nested", snapshot.root()["list"][3]["name"].toString().c_str());
+    snapshot.close();
+    EXPECT_FALSE(snapshot.isOpen());
+    remove(path.c_str());
+}
+
+TEST(Snapshot, TestFail) {
+    pocketjson::Snapshot snapshot;
+    std::string err;
+    EXPECT_FALSE(snapshot.open("pocketjson_missing_snapshot.bin", &err));
+    EXPECT_FALSE(err.empty());
+    const std::string json = "{\"name\": \"pocketjson\"}";
+    EXPECT_FALSE(snapshot.load(json.data(), json.size(), &err));
+    EXPECT_FALSE(snapshot.isOpen());
+    EXPECT_TRUE(snapshot.root().isNull());
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+TEST(StaticOptions, TestParse) {
+    pocketjson::Value v;
+    std::string error;
+    EXPECT_TRUE(pocketjson::parse<pocketjson::kParseOptionAllowCommaEnding>(v, std::string("[1, 2,]")));
+    EXPECT_EQ(2, v.size());
+    EXPECT_FALSE(pocketjson::parse<pocketjson::kParseOptionNone>(v, std::string("[1, 2,]"), &error));
+    EXPECT_STREQ("Unexpected comma exists while parsing array.", error.c_str());
+
+    pocketjson::Parser parser;
+    const std::string json = "{\"a\": [true, null]} gabage";
+    EXPECT_FALSE(parser.parse<pocketjson::kParseOptionNone>(v, json, &error));
+    EXPECT_STREQ("Gabage string exists after json string.", error.c_str());
+    EXPECT_TRUE(parser.parse<pocketjson::kParseOptionAllowLooseFormat>(v, json.begin(), json.end()));
+    EXPECT_TRUE(v["a"][0].toBoolean());
+}
+TEST(StaticOptions, TestParseHandler) {
+    class Counter : public pocketjson::AbstractParseHandler {
+    public:
+        Counter(): count(0) {}
+        bool onNull() { ++count; return true; }
+        bool onBoolean(const bool&) { ++count; return true; }
+        bool onInteger(const int64_t&) { ++count; return true; }
+        bool onFloat(const double&) { ++count; return true; }
+        bool onString(const std::string&) { ++count; return true; }
+        bool onObjectKey(const std::string&) { return true; }
+        bool beginArray() { return true; }
+        bool endArray(const size_t&) { return true; }
+        bool beginObject() { return true; }
+        bool endObject(const size_t&) { return true; }
+        int count;
+    } counter;
+    pocketjson::Parser parser;
+    EXPECT_TRUE(parser.parse<pocketjson::kParseOptionAllowCommaEnding>(&counter, std::string("[1, \"a\", {\"b\": null},]")));
+    EXPECT_EQ(3, counter.count);
+}
+TEST(StaticOptions, TestSerialize) {
+    const pocketjson::Value v = pocketjson::parse("{\"a\": [1, {\"b\": \"c\"}], \"d\": {}}");
+    EXPECT_STREQ(v.serialize().c_str(), v.serialize<pocketjson::kSerializeOptionNone>().c_str());
+    EXPECT_STREQ(v.serialize(pocketjson::kSerializeOptionPretty).c_str(), v.serialize<pocketjson::kSerializeOptionPretty>().c_str());
+    EXPECT_STREQ(v.serialize(pocketjson::kSerializeOptionPrettyTabCRLF).c_str(), v.serialize<pocketjson::kSerializeOptionPrettyTabCRLF>().c_str());
+
+    std::string out;
+    pocketjson::Serializer serializer;
+    EXPECT_TRUE(serializer.serialize<pocketjson::kSerializeOptionPretty4Spaces>(std::back_inserter(out), v));
+    EXPECT_STREQ(v.serialize(pocketjson::kSerializeOptionPretty4Spaces).c_str(), out.c_str());
+}
@@ -0,0 +1,87 @@
+#define POCKETJSON_ENABLE_STATS
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+namespace {
+struct Collector {
+    Collector(): calls(0) {}
+    int calls;
+    pocketjson::Stats last;
+};
+void collect(const pocketjson::Stats& stats, void* context) {
+    Collector* collector = static_cast<Collector*>(context);
+    ++collector->calls;
+    collector->last = stats;
+}
+} // namespace
+
+TEST(Stats, TestParse) {
+    pocketjson::Parser parser;
+    // 2.5 is converted exactly from its significand, and 2.5e300 is not.
+    const std::string json = "{\"a\": [1, 2.5, 2.5e300, \"x\\ny\\t\"], \"b\": {\"c\": [true, null]}}";
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, json));
+    const pocketjson::Stats& stats = parser.stats();
+    EXPECT_EQ(json.size(), stats.bytes);
+    EXPECT_EQ(3, stats.maxDepth);
+    EXPECT_EQ(2, stats.escapes);
+    EXPECT_EQ(1, stats.slowFloats);
+    EXPECT_EQ(2, stats.nodes(pocketjson::kObject));
+    EXPECT_EQ(2, stats.nodes(pocketjson::kArray));
+    EXPECT_EQ(1, stats.nodes(pocketjson::kInteger));
+    EXPECT_EQ(2, stats.nodes(pocketjson::kFloat));
+    EXPECT_EQ(1, stats.nodes(pocketjson::kString));
+    EXPECT_EQ(1, stats.nodes(pocketjson::kBoolean));
+    EXPECT_EQ(1, stats.nodes(pocketjson::kNull));
+    EXPECT_EQ(10, stats.nodes());
+    EXPECT_EQ(5, stats.allocations);
+
+    // A reused value keeps its containers.
+    EXPECT_TRUE(parser.parse(v, json, pocketjson::kParseOptionReuseValue));
+    EXPECT_EQ(0, parser.stats().allocations);
+    EXPECT_EQ(10, parser.stats().nodes());
+}
+TEST(Stats, TestParseHandler) {
+    pocketjson::Parser parser;
+    pocketjson::Stats copy;
+    EXPECT_EQ(0, copy.nodes());
+    EXPECT_FALSE(parser.parse(static_cast<pocketjson::AbstractParseHandler*>(0), std::string("[1")));
+    EXPECT_EQ(2, parser.stats().bytes);
+}
+TEST(Stats, TestSerialize) {
+    pocketjson::Value v;
+    v["list"].push_back(1);
+    v["list"].push_back("a\"b");
+    v["name"] = pocketjson::Value();
+    pocketjson::Serializer serializer;
+    std::string out;
+    EXPECT_TRUE(serializer.serialize(pocketjson::StringAppender(out), v));
+    const pocketjson::Stats& stats = serializer.stats();
+    EXPECT_EQ(out.size(), stats.bytes);
+    EXPECT_EQ(2, stats.maxDepth);
+    EXPECT_EQ(1, stats.escapes);
+    EXPECT_EQ(5, stats.nodes());
+    EXPECT_EQ(1, stats.nodes(pocketjson::kString));
+
+    out.clear();
+    EXPECT_TRUE(serializer.serialize(std::back_inserter(out), v, pocketjson::kSerializeOptionPretty));
+    EXPECT_EQ(out.size(), serializer.stats().bytes);
+}
+TEST(Stats, TestCallback) {
+    Collector collector;
+    pocketjson::Parser parser;
+    parser.setStatsCallback(collect, &collector);
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, std::string("[1, 2, 3]")));
+    EXPECT_TRUE(parser.parse(v, std::string("[1.5]")));
+    EXPECT_EQ(2, collector.calls);
+    EXPECT_EQ(2, collector.last.nodes());
+    EXPECT_EQ(5, collector.last.bytes);
+
+    pocketjson::Serializer serializer;
+    serializer.setStatsCallback(collect, &collector);
+    std::string out;
+    EXPECT_TRUE(serializer.serialize(pocketjson::StringAppender(out), v));
+    EXPECT_EQ(3, collector.calls);
+    EXPECT_EQ(out.size(), collector.last.bytes);
+}
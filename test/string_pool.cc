@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+TEST(StringPool, TestIntern) {
+    pocketjson::StringPool pool(8);
+    const pocketjson::Value a = pool.intern("hello");
+    const pocketjson::Value b = pool.intern("hello");
+    EXPECT_TRUE(a.isString());
+    EXPECT_EQ(&a.as<std::string>(), &b.as<std::string>());
+    EXPECT_EQ(1, pool.size());
+    EXPECT_TRUE(pool.contains("hello"));
+
+    pocketjson::Value c = pool.intern("too long string");
+    EXPECT_STREQ("too long string", c.toString().c_str());
+    EXPECT_FALSE(pool.contains("too long string"));
+    EXPECT_EQ(1, pool.size());
+}
+TEST(StringPool, TestEscaped) {
+    pocketjson::StringPool pool;
+    // Lookups do not intern.
+    EXPECT_TRUE(pool.escaped("a\"b\n") == 0);
+    EXPECT_EQ(0, pool.size());
+    pool.intern("a\"b\n");
+    const std::string* escaped = pool.escaped("a\"b\n");
+    ASSERT_TRUE(escaped != 0);
+    EXPECT_STREQ("\"a\\\"b\\n\"", escaped->c_str());
+    pool.clear();
+    EXPECT_EQ(0, pool.size());
+}
+TEST(StringPool, TestParse) {
+    pocketjson::StringPool pool;
+    pocketjson::Parser parser;
+    parser.setStringPool(&pool);
+    const std::string json = "[{\"id\": 1, \"kind\": \"user\"}, {\"id\": 2, \"kind\": \"user\"}]";
+    pocketjson::Value v;
+    EXPECT_TRUE(parser.parse(v, json.begin(), json.end()));
+    EXPECT_EQ(2, v.size());
+    const pocketjson::Value& list = v;
+    EXPECT_EQ(&list[0]["kind"].as<std::string>(), &list[1]["kind"].as<std::string>());
+    EXPECT_TRUE(pool.contains("id"));
+    EXPECT_TRUE(pool.contains("kind"));
+    EXPECT_TRUE(pocketjson::parse(json) == v);
+}
+TEST(StringPool, TestSerialize) {
+    pocketjson::StringPool pool;
+    pocketjson::Value v = pocketjson::parse("{\"key\\t\": [\"x\\\"y\", \"x\\\"y\"], \"nest\": {\"key\\t\": 1}}");
+    pocketjson::Serializer serializer;
+    serializer.setStringPool(&pool);
+    std::string pooled;
+    EXPECT_TRUE(serializer.serialize(std::back_inserter(pooled), v));
+    EXPECT_STREQ(v.serialize().c_str(), pooled.c_str());
+    // Serializing only looks strings up.
+    EXPECT_EQ(0, pool.size());
+
+    pool.intern("key\t");
+    pool.intern("x\"y");
+    pooled.clear();
+    EXPECT_TRUE(serializer.serialize(std::back_inserter(pooled), v));
+    EXPECT_STREQ(v.serialize().c_str(), pooled.c_str());
+    EXPECT_EQ(2, pool.size());
+    std::string pretty;
+    EXPECT_TRUE(serializer.serialize(std::back_inserter(pretty), v, pocketjson::kSerializeOptionPretty));
+    EXPECT_STREQ(v.serialize(pocketjson::kSerializeOptionPretty).c_str(), pretty.c_str());
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <pocketjson/tape.h>
+
+TEST(Tape, TestScalar) {
+    pocketjson::Tape tape;
+    EXPECT_TRUE(pocketjson::parse(tape, "-123"));
+    EXPECT_TRUE(tape.root().isInteger());
+    EXPECT_EQ(-123, tape.root().toInt());
+    EXPECT_TRUE(pocketjson::parse(tape, "18446744073709551615"));
+    EXPECT_TRUE(tape.root().isInteger());
+    EXPECT_EQ(18446744073709551615ULL, tape.root().toULLong());
+    EXPECT_TRUE(pocketjson::parse(tape, "2.5"));
+    EXPECT_TRUE(tape.root().isFloat());
+    EXPECT_EQ(2.5, tape.root().toDouble());
+    EXPECT_TRUE(pocketjson::parse(tape, "\"hello\""));
+    EXPECT_TRUE(tape.root().isString());
+    EXPECT_EQ(5, tape.root().size());
+    EXPECT_STREQ("hello", tape.root().c_str());
+    EXPECT_TRUE(pocketjson::parse(tape, "null"));
+    EXPECT_TRUE(tape.root().isNull());
+    EXPECT_TRUE(pocketjson::parse(tape, "false"));
+    EXPECT_TRUE(tape.root().isBoolean());
+    EXPECT_FALSE(tape.root().toBoolean(true));
+}
+TEST(Tape, TestContainer) {
+    pocketjson::Tape tape;
+    EXPECT_TRUE(tape.parse("{\"name\": \"pocketjson\", \"list\": [1, [2, 3], {\"a\": true}, 4.5], \"empty\": {}, \"none\": null}"));
+    const pocketjson::TapeValue root = tape.root();
+    EXPECT_TRUE(root.isObject());
+    EXPECT_EQ(4, root.size());
+    EXPECT_STREQ("pocketjson", root["name"].toString().c_str());
+    EXPECT_TRUE(root.contains("none"));
+    EXPECT_TRUE(root["none"].isNull());
+    EXPECT_FALSE(root.contains("missing"));
+    EXPECT_TRUE(root["empty"].isObject());
+    EXPECT_TRUE(root["empty"].empty());
+    EXPECT_STREQ("list", root.keyAt(1).c_str());
+    EXPECT_TRUE(root.valueAt(1).isArray());
+
+    const pocketjson::TapeValue list = root["list"];
+    EXPECT_EQ(4, list.size());
+    EXPECT_EQ(1, list[0].toInt());
+    EXPECT_EQ(3, list[1][1].toInt());
+    EXPECT_TRUE(list[2]["a"].toBoolean());
+    EXPECT_EQ(4.5, list[3].toDouble());
+    EXPECT_TRUE(list[4].isNull());
+    EXPECT_TRUE(list.contains(3));
+    EXPECT_FALSE(list.contains(4));
+}
+TEST(Tape, TestToValue) {
+    const std::string json = "{\"a\": [1, \"two\", {\"three\": 3.0}], \"b\": {\"c\": null, \"d\": false}}";
+    pocketjson::Tape tape;
+    EXPECT_TRUE(tape.parse(json));
+    EXPECT_TRUE(pocketjson::parse(json) == tape.root().toValue());
+}
+
+TEST(Tape, TestFail) {
+    pocketjson::Tape tape;
+    std::string err;
+    EXPECT_FALSE(tape.parse("[1, 2", pocketjson::kParseOptionNone, &err));
+    EXPECT_FALSE(err.empty());
+    EXPECT_EQ(0, tape.size());
+    EXPECT_TRUE(tape.root().isNull());
+}
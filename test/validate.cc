@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+namespace {
+bool parses(const std::string& json, const pocketjson::ParseOption& options = pocketjson::kParseOptionNone) {
+    pocketjson::Value v;
+    return pocketjson::parse(v, json, options);
+}
+} // namespace
+
+TEST(Validate, TestValid) {
+    const char* cases[] = {
+        "null", "true", "false", "0", "-1.5e+10", "1E-3", "\"\"", "[]", "{}",
+        "[1, \"a\", {\"b\": [true, null]}]",
+        " {\"key with \\\"escape\\\"\": \"\\u3042\\ud83d\\ude00\\/\\b\\f\\n\\r\\t\"} ",
+        "\"a string which is longer than sixteen bytes, with \\\"escapes\\\" after the first block\"",
+        "\xef\xbb\xbf[1]",
+    };
+    pocketjson::Parser parser;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const std::string json = cases[i];
+        EXPECT_TRUE(parses(json)) << json;
+        EXPECT_TRUE(parser.validate(json)) << json;
+        EXPECT_TRUE(parser.validate(json.begin(), json.end())) << json;
+        EXPECT_TRUE(pocketjson::validate(json)) << json;
+    }
+}
+TEST(Validate, TestInvalid) {
+    const char* cases[] = {
+        "", "nul", "01", "1.", "1e", "-", "\"abc", "\"\\x\"", "\"\\u12\"", "\"\\udc00\"", "\"\\ud800\"",
+        "[1,]", "[1 2]", "[", "{\"a\":1,}", "{\"a\" 1}", "{a}", "{", "[] x",
+        "\"a string which is longer than sixteen bytes without the closing quote",
+        "\"a string which is longer than sixteen bytes with a bad escape \\q\"",
+    };
+    pocketjson::Parser parser;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const std::string json = cases[i];
+        EXPECT_FALSE(parses(json)) << json;
+        pocketjson::Value v;
+        pocketjson::Parser reference;
+        reference.parse(v, json);
+
+        EXPECT_FALSE(parser.validate(json)) << json;
+        EXPECT_EQ(reference.error().code, parser.error().code) << json;
+        EXPECT_EQ(reference.error().offset, parser.error().offset) << json;
+        EXPECT_FALSE(parser.validate(json.begin(), json.end())) << json;
+        EXPECT_EQ(reference.error().code, parser.error().code) << json;
+        EXPECT_EQ(reference.error().offset, parser.error().offset) << json;
+    }
+}
+TEST(Validate, TestOption) {
+    EXPECT_FALSE(pocketjson::validate("[1, 2,] x"));
+    EXPECT_TRUE(pocketjson::validate("[1, 2,] x", pocketjson::kParseOptionAllowLooseFormat));
+    std::string error;
+    EXPECT_FALSE(pocketjson::validate("{\"a\": 1,}", pocketjson::kParseOptionNone, &error));
+    EXPECT_STREQ("Unexpected comma exists while parsing object.", error.c_str());
+}
+TEST(Validate, TestPosition) {
+    // Line breaks inside long strings are found by the SIMD scan too.
+    const std::string json = "[\"0123456789abcdef\n0123456789abcdef\",\n \"0123456789abcdef0123456789\\q\"]";
+    pocketjson::Parser parser;
+    EXPECT_FALSE(parser.validate(json));
+    EXPECT_EQ(pocketjson::kErrorInvalidEscape, parser.error().code);
+    EXPECT_EQ(json.find("\\q") + 1, parser.error().offset);
+    EXPECT_EQ(3, parser.error().line);
+    EXPECT_EQ(30, parser.error().column);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <pocketjson/pocketjson.h>
+
+TEST(ValueUpdate, TestCopyOnWrite) {
+    pocketjson::Value a = pocketjson::parse("{\"list\": [1, 2], \"name\": \"a\"}");
+    pocketjson::Value b = a;
+    b["list"].push_back(3.0);
+    b["name"].as<std::string>() += "b";
+    EXPECT_STREQ("{\"list\":[1,2],\"name\":\"a\"}", a.serialize().c_str());
+    EXPECT_STREQ("{\"list\":[1,2,3],\"name\":\"ab\"}", b.serialize().c_str());
+
+    pocketjson::Value c = a;
+    c.clear();
+    EXPECT_EQ(0, c.size());
+    EXPECT_EQ(2, a.size());
+}
+TEST(ValueUpdate, TestPath) {
+    pocketjson::Value v = pocketjson::parse("{\"a\": {\"b\": [1, 2, 3]}}");
+    const pocketjson::Value* found = v.find(pocketjson::Path().key("a").key("b").index(1));
+    ASSERT_TRUE(found != 0);
+    EXPECT_EQ(2, found->toInt());
+    EXPECT_TRUE(v.find(pocketjson::Path().key("a").key("b").key("1")) == found);
+    EXPECT_TRUE(v.find(pocketjson::Path().key("a").key("c")) == 0);
+    EXPECT_TRUE(v.find(pocketjson::Path().key("a").key("b").index(3)) == 0);
+
+    EXPECT_TRUE(v.set(pocketjson::Path().key("a").key("b").index(0), pocketjson::Value("x")));
+    EXPECT_TRUE(v.set(pocketjson::Path().key("a").key("b").key("-"), pocketjson::Value(4.0)));
+    EXPECT_TRUE(v.insert(pocketjson::Path().key("a").key("b").index(1), pocketjson::Value(true)));
+    EXPECT_TRUE(v.set(pocketjson::Path().key("a").key("c"), pocketjson::Value()));
+    EXPECT_TRUE(v.erase(pocketjson::Path().key("a").key("b").index(2)));
+    EXPECT_STREQ("{\"a\":{\"b\":[\"x\",true,3,4],\"c\":null}}", v.serialize().c_str());
+
+    EXPECT_FALSE(v.set(pocketjson::Path().key("x").key("y"), pocketjson::Value()));
+    EXPECT_FALSE(v.erase(pocketjson::Path().key("a").key("d")));
+    EXPECT_FALSE(v.insert(pocketjson::Path().key("a").key("b").index(9), pocketjson::Value()));
+}
+TEST(ValueUpdate, TestPersistent) {
+    const pocketjson::Value v1 = pocketjson::parse("{\"users\": [{\"name\": \"a\"}, {\"name\": \"b\"}], \"meta\": {\"n\": 2}}");
+    const pocketjson::Value v2 = v1.updated(pocketjson::Path().key("users").index(1).key("name"), pocketjson::Value("c"));
+    const pocketjson::Value v3 = v2.erased(pocketjson::Path().key("users").index(0));
+    const pocketjson::Value v4 = v3.inserted(pocketjson::Path().key("users").index(0), pocketjson::Value("d"));
+
+    EXPECT_STREQ("{\"meta\":{\"n\":2},\"users\":[{\"name\":\"a\"},{\"name\":\"b\"}]}", v1.serialize().c_str());
+    EXPECT_STREQ("{\"meta\":{\"n\":2},\"users\":[{\"name\":\"a\"},{\"name\":\"c\"}]}", v2.serialize().c_str());
+    EXPECT_STREQ("{\"meta\":{\"n\":2},\"users\":[{\"name\":\"c\"}]}", v3.serialize().c_str());
+    EXPECT_STREQ("{\"meta\":{\"n\":2},\"users\":[\"d\",{\"name\":\"c\"}]}", v4.serialize().c_str());
+
+    // untouched subtrees are shared between versions
+    EXPECT_EQ(&v1["meta"].as<pocketjson::Object>(), &v4["meta"].as<pocketjson::Object>());
+    EXPECT_EQ(&v1["users"][0].as<pocketjson::Object>(), &v2["users"][0].as<pocketjson::Object>());
+    EXPECT_NE(&v1["users"][1].as<pocketjson::Object>(), &v2["users"][1].as<pocketjson::Object>());
+}